@@ -0,0 +1,110 @@
+#include "Include/Types.hlsli"
+#include "Include/HiZ.hlsli"
+
+PUSH_CONSTANTS(CullPushConstants, pc)
+BUFFER_POOL()
+
+// Matches VkDrawIndexedIndirectCommand.
+#define DRAW_COMMAND_STRIDE 20
+
+float LoadHiZ(uint mip, uint2 texel) {
+    uint2 depthSize = uint2(pc.HiZWidth, pc.HiZHeight);
+    uint2 size = HiZMipSize(depthSize, mip);
+    texel = min(texel, size - 1);
+    return asfloat(GET_BUFFER(pc.HiZBuffer).Load(HiZMipOffset(depthSize, mip) + (texel.y * size.x + texel.x) * 4));
+}
+
+bool IsFrustumVisible(float4 sphere, SceneData scene) {
+    bool visible = true;
+    for ( uint i = 0; i < 6; i++ ) {
+        float4 plane = scene.FrustumPlanes[i];
+        visible = visible && ( dot( plane.xyz, sphere.xyz ) + plane.w >= -sphere.w );
+    }
+    return visible;
+}
+
+// Projects the box around the bounding sphere and compares its nearest depth against the
+// farthest Hi-Z depth under its screen rect, picking the mip where the rect spans at most 2x2 texels.
+bool IsOccluded(float4 sphere, SceneData scene) {
+    float2 minUV = float2(1.f, 1.f);
+    float2 maxUV = float2(0.f, 0.f);
+    float minDepth = 1.f;
+
+    for ( uint i = 0; i < 8; i++ ) {
+        float3 corner = sphere.xyz + sphere.w * float3( ( i & 1 ) ? 1.f : -1.f, ( i & 2 ) ? 1.f : -1.f, ( i & 4 ) ? 1.f : -1.f );
+        float4 clip = mul( scene.CameraViewProjectionMatrix, float4( corner, 1.f ) );
+
+        // Crosses the camera plane, can't be projected safely.
+        if ( clip.w <= 0.f )
+            return false;
+
+        float3 ndc = clip.xyz / clip.w;
+        float2 uv = float2( ndc.x * 0.5f + 0.5f, 0.5f - ndc.y * 0.5f );
+
+        minUV = min( minUV, uv );
+        maxUV = max( maxUV, uv );
+        minDepth = min( minDepth, ndc.z );
+    }
+
+    float2 depthSize = float2( pc.HiZWidth, pc.HiZHeight );
+    float2 pixelMin = saturate( minUV ) * depthSize;
+    float2 pixelMax = saturate( maxUV ) * depthSize;
+
+    float extent = max( pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y );
+    uint mip = min( uint( max( ceil( log2( max( extent, 1.f ) ) ) - 1.f, 0.f ) ), pc.HiZMipCount - 1 );
+
+    uint2 t0 = uint2( pixelMin ) >> ( mip + 1 );
+    uint2 t1 = uint2( pixelMax ) >> ( mip + 1 );
+
+    float depth = max( max( LoadHiZ( mip, t0 ), LoadHiZ( mip, uint2( t1.x, t0.y ) ) ), max( LoadHiZ( mip, uint2( t0.x, t1.y ) ), LoadHiZ( mip, t1 ) ) );
+    return minDepth > depth;
+}
+
+void EmitDraw(MeshInstance instance, uint instanceIndex) {
+    uint drawIndex = 0;
+    GET_BUFFER(pc.DrawCountBuffer).InterlockedAdd(pc.DrawCountOffset, 1, drawIndex);
+
+    // indexCount, instanceCount, firstIndex, vertexOffset, firstInstance.
+    uint offset = pc.DrawCommandsOffset + drawIndex * DRAW_COMMAND_STRIDE;
+    GET_BUFFER(pc.DrawCommandsBuffer).Store4(offset, uint4(instance.IndexCount, 1, instance.FirstIndex, 0));
+    GET_BUFFER(pc.DrawCommandsBuffer).Store(offset + 16, instanceIndex);
+}
+
+// Two phase occlusion culling:
+// Early - draws whatever was visible last frame.
+// Late  - tests everything against the Hi-Z built from the early depth, records visibility
+//         for next frame and draws only what the early phase missed.
+[numthreads(64, 1, 1)]
+void main(uint3 dispatchThreadID : SV_DispatchThreadID) {
+    uint instanceIndex = dispatchThreadID.x;
+    if ( instanceIndex >= pc.InstanceCount )
+        return;
+
+    MeshInstance instance = pc.Instances.Get()[instanceIndex];
+    SceneData scene = pc.Scene.Get();
+
+    bool neverCull = instance.BoundingSphere.w < 0.f;
+    bool visible = neverCull || IsFrustumVisible( instance.BoundingSphere, scene );
+
+    if ( pc.Phase == CULL_PHASE_FRUSTUM_ONLY ) {
+        if ( visible )
+            EmitDraw( instance, instanceIndex );
+        return;
+    }
+
+    bool visibleLastFrame = GET_BUFFER(pc.VisibilityBuffer).Load( instanceIndex * 4 ) != 0;
+
+    if ( pc.Phase == CULL_PHASE_EARLY ) {
+        if ( visible && visibleLastFrame )
+            EmitDraw( instance, instanceIndex );
+        return;
+    }
+
+    if ( visible && !neverCull )
+        visible = !IsOccluded( instance.BoundingSphere, scene );
+
+    GET_BUFFER(pc.VisibilityBuffer).Store( instanceIndex * 4, visible ? 1 : 0 );
+
+    if ( visible && !visibleLastFrame )
+        EmitDraw( instance, instanceIndex );
+}
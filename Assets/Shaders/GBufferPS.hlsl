@@ -7,31 +7,34 @@ struct PS_Input {
 	float3 Normal : NORMAL;
 	float4 Tangent : TANGENT;
     float2 UV : TEXCOORD0;
+    nointerpolation uint MaterialIndex : MATERIAL;
 };
 
 PUSH_CONSTANTS(GBufferPushConstants, pc);
 TEXTURE_POOL()
 
 float4 main(PS_Input input) : SV_Target0 {
-	uint materialIndex = pc.MaterialIndex; // [0];
+	uint materialIndex = input.MaterialIndex;
 
     Material mat = pc.Materials.Get()[materialIndex];
 	SceneData scene = pc.Scene.Get();
 
     float4 albedo = mat.Albedo;    
     if(mat.AlbedoTexture > -1)
-        albedo *= TEXTURE_SAMPLE2D(mat.AlbedoTexture, SAMPLER_ANISO_WRAP, input.UV);
+        albedo *= TEXTURE_SAMPLE2D(RESOLVE_TEXTURE(pc.TextureTable, mat.AlbedoTexture), SAMPLER_ANISO_WRAP, input.UV);
 
     if(albedo.a < mat.AlphaCutoff)
         discard;
 
     float4 emissive = mat.Emissive;
     if(mat.EmissiveTexture > -1)
-        emissive *= TEXTURE_SAMPLE2D(mat.EmissiveTexture, SAMPLER_ANISO_WRAP, input.UV);
+        emissive *= TEXTURE_SAMPLE2D(RESOLVE_TEXTURE(pc.TextureTable, mat.EmissiveTexture), SAMPLER_ANISO_WRAP, input.UV);
 
 	float3 normal = normalize(input.Normal);
 	if(mat.NormalsTexture > -1) {
-		float3 nmap = TEXTURE_SAMPLE2D(mat.NormalsTexture, SAMPLER_ANISO_WRAP, input.UV).rgb * 2.f - 1.f;
+		float3 nmap = TEXTURE_SAMPLE2D(RESOLVE_TEXTURE(pc.TextureTable, mat.NormalsTexture), SAMPLER_ANISO_WRAP, input.UV).rgb * 2.f - 1.f;
+		// BC5 normal maps only carry XY.
+		nmap.z = sqrt(saturate(1.f - dot(nmap.xy, nmap.xy)));
 
 		float3 tangent = normalize(input.Tangent.xyz);
 		float3 bitangent = normalize(cross(normal, tangent) * input.Tangent.w);  
@@ -43,7 +46,7 @@ float4 main(PS_Input input) : SV_Target0 {
 	float metallic = 0.f;
 	float roughness = 1.f;
 	if(mat.MetalRoughnessTexture > -1) {
-		float3 mr = TEXTURE_SAMPLE2D(mat.MetalRoughnessTexture, SAMPLER_ANISO_WRAP, input.UV).rgb;
+		float3 mr = TEXTURE_SAMPLE2D(RESOLVE_TEXTURE(pc.TextureTable, mat.MetalRoughnessTexture), SAMPLER_ANISO_WRAP, input.UV).rgb;
 		metallic = mr.b * mat.MetallicFactor;
 		roughness = mr.g * mat.RoughnessFactor;
 	}
@@ -6,24 +6,28 @@ struct VS_Output {
 	float3 Normal : NORMAL;
     float4 Tangent : TANGENT;
     float2 UV : TEXCOORD0;
+    nointerpolation uint MaterialIndex : MATERIAL;
 };
 
 PUSH_CONSTANTS(GBufferPushConstants, pc);
 
-VS_Output main(uint VertexIndex : SV_VertexID) {
-    Vertex vertex = pc.Vertices.Get()[VertexIndex];
+// SV_InstanceID includes firstInstance, which the draws use as the mesh instance index.
+VS_Output main(uint VertexIndex : SV_VertexID, uint InstanceIndex : SV_InstanceID) {
+    MeshInstance instance = pc.Instances.Get()[InstanceIndex];
+    Vertex vertex = instance.Vertices.Get()[VertexIndex];
     SceneData scene = pc.Scene.Get();
 
     VS_Output res;
-    res.Position = mul(pc.WorldTransform, float4(vertex.Position.xyz, 1.f));
+    res.Position = mul(instance.WorldTransform, float4(vertex.Position.xyz, 1.f));
     res.WorldPos = res.Position;
 
     float3 normal = normalize(vertex.Normal.xyz);
-    res.Tangent  = mul(pc.WorldTransform, vertex.Tangent);
-    res.Normal   = mul(pc.WorldTransform, float4(normal, 0.f));
+    res.Tangent  = mul(instance.WorldTransform, vertex.Tangent);
+    res.Normal   = mul(instance.WorldTransform, float4(normal, 0.f));
 
     res.Position = mul(scene.CameraViewProjectionMatrix, res.Position);
     res.UV = float2(vertex.UVx, vertex.UVy);
+    res.MaterialIndex = instance.MaterialIndex;
 
     return res;
 }
\ No newline at end of file
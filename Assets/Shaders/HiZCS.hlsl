@@ -0,0 +1,105 @@
+#include "Include/Types.hlsli"
+#include "Include/HiZ.hlsli"
+
+PUSH_CONSTANTS(HiZPushConstants, pc)
+TEXTURE_POOL()
+
+// The last workgroup reads mips written by the others, so the pool is bound coherent here.
+[[vk::binding(3, 0)]] globallycoherent RWByteAddressBuffer CoherentBufferPool[];
+
+groupshared float Tile[32 * 32];
+groupshared uint IsLastGroup;
+
+float LoadDepth(uint2 pixel) {
+    pixel = min(pixel, uint2(pc.DepthWidth, pc.DepthHeight) - 1);
+    return GET_TEXTURE2D(pc.DepthTexture).Load(int3(pixel, 0)).r;
+}
+
+float LoadHiZ(uint mip, uint2 texel) {
+    uint2 depthSize = uint2(pc.DepthWidth, pc.DepthHeight);
+    uint2 size = HiZMipSize(depthSize, mip);
+    texel = min(texel, size - 1);
+    return asfloat(CoherentBufferPool[BINDLESS_INDEX(pc.HiZBuffer)].Load(HiZMipOffset(depthSize, mip) + (texel.y * size.x + texel.x) * 4));
+}
+
+void StoreHiZ(uint mip, uint2 texel, float depth) {
+    uint2 depthSize = uint2(pc.DepthWidth, pc.DepthHeight);
+    uint2 size = HiZMipSize(depthSize, mip);
+    if (any(texel >= size))
+        return;
+
+    CoherentBufferPool[BINDLESS_INDEX(pc.HiZBuffer)].Store(HiZMipOffset(depthSize, mip) + (texel.y * size.x + texel.x) * 4, asuint(depth));
+}
+
+// Single pass downsampler, every workgroup reduces a 64x64 block of depth down to one texel (mips 0-5).
+// The last workgroup to finish then reduces the remaining mips.
+[numthreads(256, 1, 1)]
+void main(uint3 groupID : SV_GroupID, uint groupIndex : SV_GroupIndex) {
+    uint groupMips = min(pc.MipCount, HIZ_GROUP_MIPS);
+
+    // Out of range texels still reduce clamped depth so the shared tile stays conservative.
+    for (uint i = groupIndex; i < 32 * 32; i += 256) {
+        uint2 local = uint2(i % 32, i / 32);
+        uint2 texel = groupID.xy * 32 + local;
+        uint2 pixel = texel * 2;
+
+        float depth = max(max(LoadDepth(pixel), LoadDepth(pixel + uint2(1, 0))), max(LoadDepth(pixel + uint2(0, 1)), LoadDepth(pixel + uint2(1, 1))));
+
+        Tile[i] = depth;
+        StoreHiZ(0, texel, depth);
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint mip = 1; mip < groupMips; mip++) {
+        uint dim = 32 >> mip;
+        uint2 local = uint2(groupIndex % dim, groupIndex / dim);
+        bool active = groupIndex < dim * dim;
+
+        float depth = 0.f;
+        if (active) {
+            uint src = local.y * 2 * 32 + local.x * 2;
+            depth = max(max(Tile[src], Tile[src + 1]), max(Tile[src + 32], Tile[src + 33]));
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+
+        if (active) {
+            Tile[local.y * 32 + local.x] = depth;
+            StoreHiZ(mip, groupID.xy * dim + local, depth);
+        }
+
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (pc.MipCount <= HIZ_GROUP_MIPS)
+        return;
+
+    DeviceMemoryBarrierWithGroupSync();
+
+    if (groupIndex == 0) {
+        uint finishedGroups = 0;
+        CoherentBufferPool[BINDLESS_INDEX(pc.HiZBuffer)].InterlockedAdd(0, 1, finishedGroups);
+        IsLastGroup = finishedGroups == pc.GroupCount - 1 ? 1 : 0;
+    }
+
+    GroupMemoryBarrierWithGroupSync();
+
+    if (IsLastGroup == 0)
+        return;
+
+    uint2 depthSize = uint2(pc.DepthWidth, pc.DepthHeight);
+    for (uint mip = HIZ_GROUP_MIPS; mip < pc.MipCount; mip++) {
+        uint2 size = HiZMipSize(depthSize, mip);
+
+        for (uint i = groupIndex; i < size.x * size.y; i += 256) {
+            uint2 texel = uint2(i % size.x, i / size.x);
+            uint2 src = texel * 2;
+
+            float depth = max(max(LoadHiZ(mip - 1, src), LoadHiZ(mip - 1, src + uint2(1, 0))), max(LoadHiZ(mip - 1, src + uint2(0, 1)), LoadHiZ(mip - 1, src + uint2(1, 1))));
+            StoreHiZ(mip, texel, depth);
+        }
+
+        DeviceMemoryBarrierWithGroupSync();
+    }
+}
@@ -11,10 +11,22 @@
 #define RTAS_POOL() \
     [[vk::binding(1, 0)]] RaytracingAccelerationStructure AccelerationStructures[];
 
-#define GET_TEXTURE2D( Index ) TexturePool2D[ Index ]
-#define TEXTURE_SAMPLE1D( Index, SamplerIndex, UV ) TexturePool1D[ Index ].Sample( TexturePoolSamplers[SamplerIndex], UV )
-#define TEXTURE_SAMPLE2D( Index, SamplerIndex, UV ) TexturePool2D[ Index ].Sample( TexturePoolSamplers[SamplerIndex], UV )
-#define TEXTURE_SAMPLECUBE( Index, SamplerIndex, UVW ) TexturePoolCube[ Index ].Sample( TexturePoolSamplers[SamplerIndex], UVW )
+#define BUFFER_POOL() \
+    [[vk::binding(3, 0)]] RWByteAddressBuffer BufferPool[];
+
+// Shaders get descriptor slots (Device::GetImageBindlessIndex/GetBufferBindlessIndex), not resource handles.
+#define BINDLESS_INDEX( Handle ) ( uint( Handle ) )
+
+// Streamed textures keep their slot while the view behind it changes, the texture table maps it to the current view's slot.
+#define RESOLVE_TEXTURE( Table, Handle ) ( Table.Get()[ BINDLESS_INDEX( Handle ) ] )
+
+#define GET_BUFFER( Index ) BufferPool[ BINDLESS_INDEX( Index ) ]
+
+#define GET_TEXTURE2D( Index ) TexturePool2D[ BINDLESS_INDEX( Index ) ]
+#define GET_TEXTURECUBE( Index ) TexturePoolCube[ BINDLESS_INDEX( Index ) ]
+#define TEXTURE_SAMPLE1D( Index, SamplerIndex, UV ) TexturePool1D[ BINDLESS_INDEX( Index ) ].Sample( TexturePoolSamplers[SamplerIndex], UV )
+#define TEXTURE_SAMPLE2D( Index, SamplerIndex, UV ) TexturePool2D[ BINDLESS_INDEX( Index ) ].Sample( TexturePoolSamplers[SamplerIndex], UV )
+#define TEXTURE_SAMPLECUBE( Index, SamplerIndex, UVW ) TexturePoolCube[ BINDLESS_INDEX( Index ) ].Sample( TexturePoolSamplers[SamplerIndex], UVW )
 
 #define SAMPLER_LINEAR_CLAMP 0
 #define SAMPLER_ANISO_WRAP 1
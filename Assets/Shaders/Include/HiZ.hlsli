@@ -0,0 +1,20 @@
+#ifndef _HIZ_HLSLI_
+#define _HIZ_HLSLI_
+// Hi-Z pyramid layout, must match HiZPass.
+// Mip N stores the farthest depth of a 2^(N+1) x 2^(N+1) block of depth pixels, the first 16 bytes hold the SPD counter.
+#define HIZ_HEADER_SIZE 16
+#define HIZ_GROUP_MIPS 6
+
+uint2 HiZMipSize(uint2 depthSize, uint mip) {
+    return max((depthSize + (2u << mip) - 1) >> (mip + 1), uint2(1, 1));
+}
+
+uint HiZMipOffset(uint2 depthSize, uint mip) {
+    uint offset = HIZ_HEADER_SIZE;
+    for (uint i = 0; i < mip; i++) {
+        uint2 size = HiZMipSize(depthSize, i);
+        offset += size.x * size.y * 4;
+    }
+    return offset;
+}
+#endif
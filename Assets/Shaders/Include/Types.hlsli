@@ -23,14 +23,26 @@ struct SceneData {
     float4 SunDirection;
     float4 SunColor;
     int4 IblTextures;
+    float4 FrustumPlanes[6];
+};
+
+struct MeshInstance {
+    float4x4 WorldTransform;
+    float4 BoundingSphere; // w < 0 - never culled.
+    vk::BufferPointer<Vertex[1]> Vertices;
+    uint MaterialIndex;
+    uint IndexCount;
+    uint FirstIndex;
+    uint Pad0;
+    uint Pad1;
+    uint Pad2;
 };
 
 struct GBufferPushConstants {
     vk::BufferPointer<SceneData> Scene;
 	vk::BufferPointer<Material[1]> Materials;
-	vk::BufferPointer<Vertex[1]> Vertices;
-    float4x4 WorldTransform;
-	uint MaterialIndex;
+	vk::BufferPointer<MeshInstance[1]> Instances;
+	vk::BufferPointer<uint[1]> TextureTable;
 };
 
 struct GBufferDebugPushConstants {
@@ -63,4 +75,33 @@ struct SkinningPushConstants {
 	vk::BufferPointer<float4x4[1]> BoneTransformsBuffer;
 	uint		                   VertexCount;
 };
+
+#define CULL_PHASE_FRUSTUM_ONLY 0
+#define CULL_PHASE_EARLY 1
+#define CULL_PHASE_LATE 2
+
+struct CullPushConstants {
+    vk::BufferPointer<SceneData>       Scene;
+    vk::BufferPointer<MeshInstance[1]> Instances;
+    uint                               DrawCommandsBuffer;
+    uint                               DrawCommandsOffset;
+    uint                               DrawCountBuffer;
+    uint                               DrawCountOffset;
+    uint                               InstanceCount;
+    uint                               Phase;
+    uint                               VisibilityBuffer;
+    uint                               HiZBuffer;
+    uint                               HiZMipCount;
+    uint                               HiZWidth;
+    uint                               HiZHeight;
+};
+
+struct HiZPushConstants {
+    uint DepthTexture;
+    uint HiZBuffer;
+    uint DepthWidth;
+    uint DepthHeight;
+    uint MipCount;
+    uint GroupCount;
+};
 #endif
\ No newline at end of file
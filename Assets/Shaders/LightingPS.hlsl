@@ -30,7 +30,7 @@ float4 main(FullScreenPSInput input) : SV_Target0 {
 
     if (depth == 1.f) 
     {    
-        float3 skyColor = TexturePoolCube[ specularMap ].SampleLevel(TexturePoolSamplers[ SAMPLER_LINEAR_CLAMP ], worldPos, 0);
+        float3 skyColor = GET_TEXTURECUBE( specularMap ).SampleLevel(TexturePoolSamplers[ SAMPLER_LINEAR_CLAMP ], worldPos, 0);
         return float4(max(skyColor, 0.0.xxx), 1.0);
     }
 
@@ -64,9 +64,9 @@ float4 main(FullScreenPSInput input) : SV_Target0 {
 	radiance += material.CalculateIndirectLight( 
 		TexturePoolSamplers[ SAMPLER_ANISO_CLAMP ], 
 		TexturePoolSamplers[ SAMPLER_LINEAR_CLAMP ], 
-		TexturePoolCube[ diffuseMap ], 
-		TexturePoolCube[ specularMap ], 
-		TexturePool2D[ brdfLut ], 
+		GET_TEXTURECUBE( diffuseMap ), 
+		GET_TEXTURECUBE( specularMap ), 
+		GET_TEXTURE2D( brdfLut ), 
 		wo
 	) * iblIntensity;
 
@@ -6,7 +6,7 @@ PUSH_CONSTANTS(SkinningPushConstants, pc)
 [numthreads(64, 1, 1)]
 void main(uint3 dispatchThreadID : SV_DispatchThreadID, uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex) {
     uint vertexIndex = dispatchThreadID.x;
-    if ( vertexIndex > pc.VertexCount )
+    if ( vertexIndex >= pc.VertexCount )
         return;
 
     uint4 bone = pc.BoneIndicesBuffer.Get()[vertexIndex];
@@ -96,9 +96,9 @@ float4 main(PS_Input input) : SV_Target0 {
 	radiance += material.CalculateIndirectLight( 
 		TexturePoolSamplers[ SAMPLER_ANISO_CLAMP ], 
 		TexturePoolSamplers[ SAMPLER_LINEAR_CLAMP ], 
-		TexturePoolCube[ diffuseMap ], 
-		TexturePoolCube[ specularMap ], 
-		TexturePool2D[ brdfLut ], 
+		GET_TEXTURECUBE( diffuseMap ), 
+		GET_TEXTURECUBE( specularMap ), 
+		GET_TEXTURE2D( brdfLut ), 
 		wo
 	) * iblIntensity;
 
@@ -11,26 +11,30 @@ namespace Boundless {
 		void DepthTarget( const Image::Desc& desc ) { m_DepthDesc = desc; }
 		void RenderTarget( const Image::Desc& desc ) { m_RenderTargetDescs.push_back(desc); }
 
-		void BeginRendering(CommandBuffer& commandBuffer, Device& device) {
+		// Targets are views of images owned by the RenderGraph, which also moved them to attachment layout.
+		// clear = false keeps the previous contents, e.g. to draw more on top. Pass eContentsSecondaryCommandBuffers when the
+		// pass only executes secondary command buffers.
+		void BeginRendering( CommandBuffer& commandBuffer, Device& device, const std::vector<ImageHandle>& colorTargets, ImageHandle depthTarget, bool clear = true, vk::RenderingFlags flags = {} ) {
 			std::vector<vk::RenderingAttachmentInfo> colorAttachments = {};
 			vk::RenderingAttachmentInfo depthAttachment = {};
 
-			if( m_DepthTargetView != ImageHandle::Invalid ) {
-				const vk::ImageView& depthView = device.GetImage( m_DepthTargetView );
-				depthAttachment = vk_util::RenderPassGetDepthAttachmentInfo( depthView, vk::ImageLayout::eAttachmentOptimal );
+			if( depthTarget != ImageHandle::Invalid ) {
+				const vk::ImageView& depthView = device.GetImage( depthTarget );
+				depthAttachment = vk_util::RenderPassGetDepthAttachmentInfo( depthView, vk::ImageLayout::eAttachmentOptimal, clear );
 			}
 			
-			colorAttachments.resize( m_RenderTargets.size() );
+			colorAttachments.resize( colorTargets.size() );
 
 			for(size_t i = 0; i < colorAttachments.size(); i++ ) {
-				const vk::ImageView& colorView = device.GetImage( m_RenderTargetViews[i] );
+				const vk::ImageView& colorView = device.GetImage( colorTargets[i] );
 				
 				vk::ClearValue clearValue = { { 0.1f, 0.1f, 0.1f, 1.f } };
-				colorAttachments[i] = vk_util::RenderPassGetColorAttachmentInfo( colorView, &clearValue, vk::ImageLayout::eAttachmentOptimal );
+				colorAttachments[i] = vk_util::RenderPassGetColorAttachmentInfo( colorView, clear ? &clearValue : nullptr, vk::ImageLayout::eAttachmentOptimal );
 			}
 
-			vk::RenderingAttachmentInfo* depthInfo = m_DepthTargetView == ImageHandle::Invalid ? nullptr : &depthAttachment;
+			vk::RenderingAttachmentInfo* depthInfo = depthTarget == ImageHandle::Invalid ? nullptr : &depthAttachment;
 			vk::RenderingInfo renderingInfo = vk_util::RenderPassCreateRenderingInfo( m_Viewport.Size, colorAttachments.data(), depthInfo, uint32_t( colorAttachments.size() ) );
+			renderingInfo.setFlags( flags );
 
 			commandBuffer.BeginRendering(renderingInfo);
 		}
@@ -39,56 +43,9 @@ namespace Boundless {
 			commandBuffer.EndRendering();
 		}
 
-		void AddExitBarriers( CommandBuffer& commandBuffer, Device& device ) {
-			std::vector<Image::Desc> allDescs = m_RenderTargetDescs;
-			if( m_DepthDesc.m_Format != vk::Format::eUndefined )
-				allDescs.push_back(m_DepthDesc);
-
-			for(size_t i = 0; i < allDescs.size(); i++ ) {
-				const Image::Desc& desc = allDescs[i];
-				if( !( desc.m_Usage & vk::ImageUsageFlagBits::eSampled ) ) // If we don't plan to sample the image ignore this barrier.
-					continue;
-
-				bool isDepth = ( desc.m_Usage & vk::ImageUsageFlagBits::eDepthStencilAttachment ) == vk::ImageUsageFlagBits::eDepthStencilAttachment;
-
-				vk::AccessFlags srcAccessMask = isDepth ? ( vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite ) : ( vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite );
-				vk::AccessFlags dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-				vk::PipelineStageFlags srcStageMask = isDepth ? ( vk::PipelineStageFlagBits::eLateFragmentTests ) : ( vk::PipelineStageFlagBits::eColorAttachmentOutput );
-				vk::ImageSubresourceRange subresourceRange = isDepth ? vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eDepth, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers } : 
-					vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers };
-			
-				ImageHandle resource = isDepth ? m_DepthTarget : m_RenderTargets[i];
-				const vk::Image& image = device.GetImage(resource);
-
-				commandBuffer.ImageBarrier( 
-					image,
-					srcAccessMask,
-					dstAccessMask,
-					vk::ImageLayout::eUndefined,
-					vk::ImageLayout::eShaderReadOnlyOptimal,
-					srcStageMask,
-					vk::PipelineStageFlagBits::eFragmentShader,
-					subresourceRange
-				);
-			}
-		}
-
 		virtual void CreatePassResources( Device& device ) {
-			if ( m_DepthDesc.m_Format != vk::Format::eUndefined ) {
-				m_DepthTarget = device.CreateImage( m_DepthDesc );
-				m_DepthTargetView = device.CreateImageView( m_DepthTarget );
-				
+			if ( m_DepthDesc.m_Format != vk::Format::eUndefined )
 				m_PipelineBuilder.SetDepthAttachmentFormat( m_DepthDesc.m_Format );
-			}
-
-			m_RenderTargets.resize( m_RenderTargetDescs.size() );
-			m_RenderTargetViews.resize( m_RenderTargetDescs.size() );
-
-			for( size_t i = 0; i < m_RenderTargetDescs.size(); i++ ) {
-				m_RenderTargets[ i ] = device.CreateImage( m_RenderTargetDescs[ i ] );
-				m_RenderTargetViews[ i ] = device.CreateImageView( m_RenderTargets[ i ] );
-			}
 
 			std::vector<vk::Format> renderTargetFormats = m_RenderTargetDescs | std::views::transform( &Image::Desc::m_Format ) | std::ranges::to<std::vector>();
 
@@ -97,37 +54,16 @@ namespace Boundless {
 				.SetPipelineLayout( device.GetGlobalPipelineLayout() );
 		}
 
-		virtual void ReleasePassResources( Device& device ) {
-			if ( m_DepthTargetView != ImageHandle::Invalid ) {
-				device.ReleaseImageView( m_DepthTargetView );
-			}
-
-			if ( m_DepthTarget != ImageHandle::Invalid ) {
-				device.ReleaseImage( m_DepthTarget );
-			}
-
-			for ( size_t i = 0; i < m_RenderTargetDescs.size(); i++ ) {
-				if ( m_RenderTargetViews[i] != ImageHandle::Invalid )
-					device.ReleaseImageView( m_RenderTargetViews[ i ] );
-				
-				if ( m_RenderTargets[ i ] != ImageHandle::Invalid )
-					device.ReleaseImage( m_RenderTargets[ i ] );
-			}
-		}
+		virtual void ReleasePassResources( [[maybe_unused]] Device& device ) { }
 
-		virtual ImageHandle GetDepthBuffer() const { return m_DepthTarget; }
-		virtual ImageHandle GetDepthBufferView() const { return m_DepthTargetView; }
-		virtual ImageHandle GetRenderTarget() const { return m_RenderTargets[ 0 ]; }
-		virtual ImageHandle GetRenderTargetView() const { return m_RenderTargetViews[ 0 ]; }
+		// What the pass renders to, the images themselves are created by the RenderGraph.
+		const Image::Desc& GetRenderTargetDesc( size_t index = 0 ) const { return m_RenderTargetDescs[ index ]; }
+		const Image::Desc& GetDepthTargetDesc() const { return m_DepthDesc; }
 	protected:
 		ComputePipelineBuilder	 m_ComputePipelineBuilder = {};
 		PipelineBuilder			 m_PipelineBuilder = {};
 		vk::Pipeline			 m_Pipeline;
 		std::vector<Image::Desc> m_RenderTargetDescs;
-		std::vector<ImageHandle> m_RenderTargetViews;
-		std::vector<ImageHandle> m_RenderTargets;
-		ImageHandle				 m_DepthTargetView = ImageHandle::Invalid;
-		ImageHandle				 m_DepthTarget = ImageHandle::Invalid;
 		Image::Desc				 m_DepthDesc;
 		Viewport				 m_Viewport;
 		std::string				 m_Name;
@@ -0,0 +1,40 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	// Hands out the slots of one bindless descriptor array, independent of resource handles. Only resources shaders
+	// access through the arrays take one, freed slots are reused oldest first.
+	class BindlessSlots {
+	public:
+		// -1 on the GPU, "no resource".
+		constexpr static const uint32_t Invalid = 0xFFFFFFFF;
+
+		explicit BindlessSlots( uint32_t capacity ) : m_Capacity( capacity ) { }
+
+		// Invalid once all of the array's slots are taken.
+		uint32_t Allocate() {
+			if ( !m_FreeSlots.empty() ) {
+				uint32_t slot = m_FreeSlots.front();
+				m_FreeSlots.pop_front();
+				return slot;
+			}
+
+			if ( m_NextSlot == m_Capacity )
+				return Invalid;
+
+			return m_NextSlot++;
+		}
+
+		void Free( uint32_t slot ) {
+			if ( slot != Invalid )
+				m_FreeSlots.push_back( slot );
+		}
+
+		uint32_t GetCapacity() const { return m_Capacity; }
+		uint32_t GetUsedCount() const { return m_NextSlot - uint32_t( m_FreeSlots.size() ); }
+	private:
+		uint32_t			 m_Capacity;
+		uint32_t			 m_NextSlot = 0;
+		std::deque<uint32_t> m_FreeSlots;
+	};
+}
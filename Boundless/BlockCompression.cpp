@@ -0,0 +1,245 @@
+#include "Pch.hpp"
+#include "BlockCompression.hpp"
+
+namespace Boundless {
+	using BlockTexels = std::array<glm::vec4, 16>;
+
+	static const std::array<uint32_t, 16> BC7Weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Packs fields LSB first, the way BC blocks are laid out.
+	struct BlockWriter {
+		uint8_t* m_Data;
+		uint32_t m_Position = 0;
+
+		void Write( uint32_t value, uint32_t bitCount ) {
+			for ( uint32_t i = 0; i < bitCount; i++, m_Position++ ) {
+				if ( ( value >> i ) & 1u )
+					m_Data[ m_Position >> 3 ] |= uint8_t( 1u << ( m_Position & 7u ) );
+			}
+		}
+	};
+
+	struct BC7Endpoints {
+		std::array<glm::uvec4, 2> m_Colors{}; // 7 bits per channel.
+		std::array<uint32_t, 2>	  m_PBits{};
+
+		glm::vec4 Expand( uint32_t endpoint ) const { return glm::vec4( m_Colors[ endpoint ] * 2u + m_PBits[ endpoint ] ); }
+	};
+
+	uint32_t GetBlockSize( EBlockFormat format ) {
+		return format == EBlockFormat::BC4 ? 8u : 16u;
+	}
+
+	static void EncodeBC4Block( const std::array<uint8_t, 16>& values, uint8_t* out ) {
+		const uint8_t maxValue = *std::max_element( values.begin(), values.end() );
+		const uint8_t minValue = *std::min_element( values.begin(), values.end() );
+
+		// red0 > red1 selects the 8 value ramp. Equal endpoints leave every index at 0, which decodes to red0.
+		out[ 0 ] = maxValue;
+		out[ 1 ] = minValue;
+
+		uint64_t indices = 0;
+		if ( maxValue > minValue ) {
+			const uint32_t range = maxValue - minValue;
+
+			for ( uint32_t i = 0; i < 16; i++ ) {
+				// Position along the ramp, 0 is red0 and 7 is red1. Index 1 is red1, 2..7 are the interpolated values.
+				const uint32_t t = ( uint32_t( maxValue - values[ i ] ) * 7u + range / 2u ) / range;
+				const uint64_t index = t == 0 ? 0 : t == 7 ? 1 : t + 1;
+
+				indices |= index << ( 3 * i );
+			}
+		}
+
+		for ( uint32_t i = 0; i < 6; i++ )
+			out[ 2 + i ] = uint8_t( indices >> ( 8 * i ) );
+	}
+
+	// Rounds an endpoint to 7 bits per channel, the p-bit is shared by all channels so both are tried.
+	static void QuantizeBC7Endpoint( const glm::vec4& endpoint, BC7Endpoints& endpoints, uint32_t index ) {
+		float bestError = std::numeric_limits<float>::max();
+
+		for ( uint32_t pBit = 0; pBit < 2; pBit++ ) {
+			glm::uvec4 color = {};
+			float error = 0.f;
+
+			for ( uint32_t c = 0; c < 4; c++ ) {
+				color[ c ] = uint32_t( std::clamp( int( std::round( ( endpoint[ c ] - float( pBit ) ) * 0.5f ) ), 0, 127 ) );
+
+				const float delta = float( color[ c ] * 2u + pBit ) - endpoint[ c ];
+				error += delta * delta;
+			}
+
+			if ( error < bestError ) {
+				bestError = error;
+				endpoints.m_Colors[ index ] = color;
+				endpoints.m_PBits[ index ] = pBit;
+			}
+		}
+	}
+
+	static float AssignBC7Indices( const BlockTexels& texels, const BC7Endpoints& endpoints, std::array<uint32_t, 16>& indices ) {
+		const glm::vec4 e0 = endpoints.Expand( 0 );
+		const glm::vec4 e1 = endpoints.Expand( 1 );
+
+		std::array<glm::vec4, 16> palette = {};
+		for ( uint32_t i = 0; i < 16; i++ )
+			palette[ i ] = glm::floor( ( e0 * float( 64u - BC7Weights[ i ] ) + e1 * float( BC7Weights[ i ] ) + 32.f ) / 64.f );
+
+		float totalError = 0.f;
+		for ( uint32_t t = 0; t < 16; t++ ) {
+			float bestError = std::numeric_limits<float>::max();
+
+			for ( uint32_t i = 0; i < 16; i++ ) {
+				const glm::vec4 delta = palette[ i ] - texels[ t ];
+				const float error = glm::dot( delta, delta );
+
+				if ( error < bestError ) {
+					bestError = error;
+					indices[ t ] = i;
+				}
+			}
+
+			totalError += bestError;
+		}
+
+		return totalError;
+	}
+
+	static void EncodeBC7Block( const BlockTexels& texels, uint8_t* out ) {
+		glm::vec4 mean = glm::vec4( 0.f );
+		for ( const glm::vec4& texel : texels )
+			mean += texel;
+		mean /= 16.f;
+
+		glm::mat4 covariance = glm::mat4( 0.f );
+		for ( const glm::vec4& texel : texels )
+			covariance += glm::outerProduct( texel - mean, texel - mean );
+
+		// Principal axis through power iteration, flat blocks keep the diagonal.
+		glm::vec4 axis = glm::vec4( 1.f );
+		for ( uint32_t i = 0; i < 8; i++ ) {
+			const glm::vec4 next = covariance * axis;
+			const float scale = std::max( { std::abs( next.x ), std::abs( next.y ), std::abs( next.z ), std::abs( next.w ) } );
+			if ( scale < 1e-6f )
+				break;
+
+			axis = next / scale;
+		}
+		axis = glm::normalize( axis );
+
+		float minT = std::numeric_limits<float>::max(), maxT = std::numeric_limits<float>::lowest();
+		for ( const glm::vec4& texel : texels ) {
+			const float t = glm::dot( texel - mean, axis );
+			minT = std::min( minT, t );
+			maxT = std::max( maxT, t );
+		}
+
+		std::array<glm::vec4, 2> candidate = { glm::clamp( mean + axis * minT, 0.f, 255.f ), glm::clamp( mean + axis * maxT, 0.f, 255.f ) };
+
+		BC7Endpoints best = {};
+		std::array<uint32_t, 16> bestIndices = {};
+		float bestError = std::numeric_limits<float>::max();
+
+		// Least squares refit of the endpoints against the chosen indices, keeps whichever quantized result is best.
+		for ( uint32_t iteration = 0; iteration < 3; iteration++ ) {
+			BC7Endpoints endpoints = {};
+			QuantizeBC7Endpoint( candidate[ 0 ], endpoints, 0 );
+			QuantizeBC7Endpoint( candidate[ 1 ], endpoints, 1 );
+
+			std::array<uint32_t, 16> indices = {};
+			const float error = AssignBC7Indices( texels, endpoints, indices );
+			if ( error < bestError ) {
+				bestError = error;
+				best = endpoints;
+				bestIndices = indices;
+			}
+
+			if ( bestError == 0.f )
+				break;
+
+			float a = 0.f, b = 0.f, c = 0.f;
+			glm::vec4 x0 = glm::vec4( 0.f ), x1 = glm::vec4( 0.f );
+			for ( uint32_t t = 0; t < 16; t++ ) {
+				const float w = BC7Weights[ indices[ t ] ] / 64.f;
+				a += ( 1.f - w ) * ( 1.f - w );
+				b += ( 1.f - w ) * w;
+				c += w * w;
+				x0 += texels[ t ] * ( 1.f - w );
+				x1 += texels[ t ] * w;
+			}
+
+			const float determinant = a * c - b * b;
+			if ( std::abs( determinant ) < 1e-6f )
+				break;
+
+			candidate[ 0 ] = glm::clamp( ( x0 * c - x1 * b ) / determinant, 0.f, 255.f );
+			candidate[ 1 ] = glm::clamp( ( x1 * a - x0 * b ) / determinant, 0.f, 255.f );
+		}
+
+		// The anchor (first) index is stored without its top bit, flip the block around when it is set.
+		if ( bestIndices[ 0 ] >= 8 ) {
+			std::swap( best.m_Colors[ 0 ], best.m_Colors[ 1 ] );
+			std::swap( best.m_PBits[ 0 ], best.m_PBits[ 1 ] );
+
+			for ( uint32_t& index : bestIndices )
+				index = 15 - index;
+		}
+
+		BlockWriter writer = { out };
+		writer.Write( 1u << 6, 7 ); // Mode 6.
+
+		for ( uint32_t c = 0; c < 4; c++ ) {
+			writer.Write( best.m_Colors[ 0 ][ c ], 7 );
+			writer.Write( best.m_Colors[ 1 ][ c ], 7 );
+		}
+
+		writer.Write( best.m_PBits[ 0 ], 1 );
+		writer.Write( best.m_PBits[ 1 ], 1 );
+
+		for ( uint32_t t = 0; t < 16; t++ )
+			writer.Write( bestIndices[ t ], t == 0 ? 3 : 4 );
+	}
+
+	std::vector<uint8_t> CompressImage( const uint8_t* pixels, uint32_t width, uint32_t height, EBlockFormat format, std::array<uint32_t, 2> channels ) {
+		const uint32_t blocksX = ( width + 3 ) / 4;
+		const uint32_t blocksY = ( height + 3 ) / 4;
+		const uint32_t blockSize = GetBlockSize( format );
+
+		std::vector<uint8_t> blocks( size_t( blocksX ) * blocksY * blockSize, 0 );
+
+		for ( uint32_t by = 0; by < blocksY; by++ ) {
+			for ( uint32_t bx = 0; bx < blocksX; bx++ ) {
+				std::array<const uint8_t*, 16> texels = {};
+				for ( uint32_t t = 0; t < 16; t++ ) {
+					const uint32_t x = std::min( bx * 4 + t % 4, width - 1 );
+					const uint32_t y = std::min( by * 4 + t / 4, height - 1 );
+					texels[ t ] = pixels + ( size_t( y ) * width + x ) * 4;
+				}
+
+				uint8_t* out = blocks.data() + ( size_t( by ) * blocksX + bx ) * blockSize;
+
+				if ( format == EBlockFormat::BC7 ) {
+					BlockTexels block = {};
+					for ( uint32_t t = 0; t < 16; t++ )
+						block[ t ] = glm::vec4( texels[ t ][ 0 ], texels[ t ][ 1 ], texels[ t ][ 2 ], texels[ t ][ 3 ] );
+
+					EncodeBC7Block( block, out );
+					continue;
+				}
+
+				// BC5 is two BC4 blocks back to back.
+				const uint32_t channelCount = format == EBlockFormat::BC5 ? 2 : 1;
+				for ( uint32_t channel = 0; channel < channelCount; channel++ ) {
+					std::array<uint8_t, 16> values = {};
+					for ( uint32_t t = 0; t < 16; t++ )
+						values[ t ] = texels[ t ][ channels[ channel ] ];
+
+					EncodeBC4Block( values, out + channel * 8 );
+				}
+			}
+		}
+
+		return blocks;
+	}
+}
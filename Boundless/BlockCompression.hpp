@@ -0,0 +1,16 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	enum class EBlockFormat {
+		BC4, // One channel, 8 bytes per 4x4 block.
+		BC5, // Two channels, 16 bytes per 4x4 block.
+		BC7	 // RGBA, 16 bytes per 4x4 block. Only mode 6 (one subset, 7 bit endpoints + p-bit, 4 bit indices) is used.
+	};
+
+	uint32_t GetBlockSize( EBlockFormat format );
+
+	// Compresses an RGBA8 image on the CPU, blocks hanging over the edge repeat the last row/column.
+	// For BC4/BC5, channels picks the source channel of each encoded one, e.g. { 2, 1 } stores blue in red and green in green.
+	std::vector<uint8_t> CompressImage( const uint8_t* pixels, uint32_t width, uint32_t height, EBlockFormat format, std::array<uint32_t, 2> channels = { 0, 1 } );
+}
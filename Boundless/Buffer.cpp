@@ -2,45 +2,80 @@
 #include "Buffer.hpp"
 
 namespace Boundless {
-    Buffer::Buffer( const vk::Device& device, const VmaAllocator& allocator, const Buffer::Desc& bufferDesc) : m_Device( device ), m_Allocator( allocator ), m_Size( bufferDesc.m_Size ) {
+    Buffer::Buffer( const vk::Device& device, const VmaAllocator& allocator, const Buffer::Desc& bufferDesc, VmaPool pool, MemoryTracker* tracker ) : m_Device( device ), m_Allocator( allocator ), m_Size( bufferDesc.m_Size ), m_Category( bufferDesc.m_Category ) {
+        // No dedicated memory for buffers, VMA still picks a dedicated allocation on its own for very large ones.
         VmaAllocationCreateInfo allocCreateInfo = {};
         allocCreateInfo.usage = bufferDesc.m_MemoryUsage;
-        allocCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        allocCreateInfo.pool = pool;
 
-        if ( bufferDesc.m_Mappable )
-            allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+        if ( bufferDesc.m_Mappable ) {
+            allocCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            allocCreateInfo.flags |= bufferDesc.m_Pool == EMemoryPool::Readback ? VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT : VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+        }
 
         VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
         bufferInfo.size = VkDeviceSize( bufferDesc.m_Size );
         bufferInfo.usage = VkBufferUsageFlags( bufferDesc.m_Usage );
 
         VkBuffer handle = VK_NULL_HANDLE;
-        vmaCreateBuffer( allocator, &bufferInfo, &allocCreateInfo, &handle, &m_Allocation, nullptr );
+        VmaAllocationInfo allocationInfo = {};
+        VkResult result = vmaCreateBuffer( allocator, &bufferInfo, &allocCreateInfo, &handle, &m_Allocation, &allocationInfo );
+
+        if ( result != VK_SUCCESS && pool != VK_NULL_HANDLE ) {
+            // Pool is full or the buffer is bigger than a pool block.
+            allocCreateInfo.pool = VK_NULL_HANDLE;
+            result = vmaCreateBuffer( allocator, &bufferInfo, &allocCreateInfo, &handle, &m_Allocation, &allocationInfo );
+        }
+
+        if ( result != VK_SUCCESS ) {
+            printf( "[Buffer] Failed to allocate %llu bytes for %s (VkResult %d)\n", bufferDesc.m_Size, MemoryTracker::GetCategoryName( bufferDesc.m_Category ), int( result ) );
+            if ( tracker )
+                tracker->Dump();
+        } else if ( tracker ) {
+            m_Tracker = tracker;
+            m_AllocationSize = allocationInfo.size;
+            m_Tracker->Add( m_Category, m_AllocationSize );
+        }
         
         m_Handle = vk::Buffer(handle);
+        m_MappedData = allocationInfo.pMappedData;
     }
 
     void Buffer::Release() { 
         if( m_Allocator && m_Handle && m_Allocation )
             vmaDestroyBuffer(m_Allocator, m_Handle, m_Allocation);
+
+        if ( m_Tracker ) {
+            m_Tracker->Remove( m_Category, m_AllocationSize );
+            m_Tracker = nullptr;
+        }
     }
 
     void* Buffer::Map() {
+        if ( m_MappedData )
+            return m_MappedData;
+
         void* data = nullptr;
         vmaMapMemory(m_Allocator, m_Allocation, &data);
         return data;
     }
 
     void Buffer::Unmap() {
-        vmaUnmapMemory(m_Allocator, m_Allocation);
+        if ( !m_MappedData )
+            vmaUnmapMemory(m_Allocator, m_Allocation);
     }
 
-    void Buffer::Patch(void* data, size_t size) {
+    void Buffer::Patch(const void* data, size_t size) {
         void* ptr = Map();
         memcpy(ptr, data, size);
         Unmap();
     }
 
+    void Buffer::Write( const void* data, vk::DeviceSize size, vk::DeviceSize offset ) {
+        memcpy( static_cast<uint8_t*>( m_MappedData ) + offset, data, size_t( size ) );
+        vmaFlushAllocation( m_Allocator, m_Allocation, offset, size );
+    }
+
     vk::DeviceAddress Buffer::GetDeviceAddress() const {
         return m_Device.getBufferAddress( vk::BufferDeviceAddressInfo{ m_Handle } );
     }
@@ -1,7 +1,21 @@
 #pragma once
 #include "VkUtil.hpp"
+#include "MemoryTracker.hpp"
+#include "BindlessSlots.hpp"
 
 namespace Boundless {
+	// Usage class a buffer is suballocated from. Default goes through VMA's general blocks, the rest use
+	// dedicated VMA pools so lots of small buffers don't each cost a vkAllocateMemory.
+	enum class EMemoryPool : uint32_t {
+		Default,
+		Geometry,  // Static mesh data (skinning inputs, BLAS storage).
+		Constants, // Device local data uploaded through staging (materials, bone palettes).
+		Scratch,   // GPU written working memory (AS build scratch, culling output, Hi-Z).
+		Readback,  // GPU -> CPU copies.
+		Frame,	   // Linear per-frame pool, freed in frame order through the deferred release queue.
+		Count
+	};
+
 	class Buffer {
 		friend class Device;
 	public:
@@ -10,23 +24,33 @@ namespace Boundless {
 			vk::BufferUsageFlags m_Usage;
 			VmaMemoryUsage		 m_MemoryUsage = VMA_MEMORY_USAGE_AUTO;
 			bool				 m_Mappable = false;
+			EMemoryPool			 m_Pool = EMemoryPool::Default;
+			EMemoryCategory		 m_Category = EMemoryCategory::Buffers;
+			bool				 m_HostWrite = false; // Filled by the CPU. Mapped device local memory where the device has it (Device::HasDirectUploads), staged otherwise.
+			bool				 m_Bindless = true;	  // Storage buffers take a bindless slot. Off for ones only reached through their address, e.g. AS build scratch.
 
 			bool operator==( const Desc& other ) const {
-				return std::tie( m_Size, m_Usage, m_MemoryUsage, m_Mappable ) == std::tie( other.m_Size, other.m_Usage, other.m_MemoryUsage, other.m_Mappable );
+				return std::tie( m_Size, m_Usage, m_MemoryUsage, m_Mappable, m_Pool, m_Category, m_HostWrite, m_Bindless ) == std::tie( other.m_Size, other.m_Usage, other.m_MemoryUsage, other.m_Mappable, other.m_Pool, other.m_Category, other.m_HostWrite, other.m_Bindless );
 			}
 		};
 
-		explicit Buffer( const vk::Device& device, const VmaAllocator& allocator, const Buffer::Desc& bufferDesc );
+		// Falls back to the default blocks when the pool can't fit the allocation. The allocation is reported to the
+		// tracker, if any, until Release.
+		explicit Buffer( const vk::Device& device, const VmaAllocator& allocator, const Buffer::Desc& bufferDesc, VmaPool pool = VK_NULL_HANDLE, MemoryTracker* tracker = nullptr );
 
 		operator vk::Buffer& ( ) { return m_Handle; }
 		operator const vk::Buffer& ( ) const { return m_Handle; }
 
 		void Release();
 
+		// Mappable buffers stay persistently mapped, Map/Unmap only go through VMA for the others.
 		void* Map();
 		void Unmap();
+		void* GetMappedData() const { return m_MappedData; }
 
-		void Patch( void* data, size_t size );
+		void Patch( const void* data, size_t size );
+		// Copies into persistently mapped memory (GetMappedData() != nullptr) and flushes it for non coherent memory types.
+		void Write( const void* data, vk::DeviceSize size, vk::DeviceSize offset = 0 );
 
 		vk::Buffer GetHandle() const { return m_Handle; }
 		vk::DeviceSize GetSize() const { return m_Size; }
@@ -40,11 +64,17 @@ namespace Boundless {
 		VmaAllocator  m_Allocator{};
 		VmaAllocation m_Allocation{};
 		vk::DeviceSize  m_Size{};
+		void*		  m_MappedData = nullptr;
+
+		MemoryTracker*	m_Tracker = nullptr;
+		EMemoryCategory m_Category = EMemoryCategory::Buffers;
+		vk::DeviceSize	m_AllocationSize = 0;
+		uint32_t		m_BindlessSlot = BindlessSlots::Invalid; // Storage buffers only.
 	};
 
 	class StagingBuffer : public Buffer {
 	public:
-		StagingBuffer( const VkDevice& device, const VmaAllocator& allocator, const vk::DeviceSize size ) :
-			Buffer( device, allocator, Buffer::Desc{ size, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_AUTO, true } ) { }
+		StagingBuffer( const VkDevice& device, const VmaAllocator& allocator, const vk::DeviceSize size, VmaPool pool = VK_NULL_HANDLE, MemoryTracker* tracker = nullptr ) :
+			Buffer( device, allocator, Buffer::Desc{ size, vk::BufferUsageFlagBits::eTransferSrc, VMA_MEMORY_USAGE_AUTO, true, EMemoryPool::Frame, EMemoryCategory::Staging }, pool, tracker ) { }
 	};
 }
\ No newline at end of file
@@ -3,20 +3,63 @@
 #include "CommandBuffer.hpp"
 
 namespace Boundless {
-	CommandBuffer::CommandBuffer( Device& device ) { 
-		vk::CommandBufferAllocateInfo allocateInfo = {};
-		allocateInfo.commandPool = device.GetCommandPool();
-		allocateInfo.level = vk::CommandBufferLevel::ePrimary;
-		allocateInfo.commandBufferCount = 1;
-		m_CommandBuffer = device->allocateCommandBuffers( allocateInfo )[ 0 ];
+	constexpr static const vk::AccessFlags2 WriteAccessMask = vk::AccessFlagBits2::eShaderWrite | vk::AccessFlagBits2::eShaderStorageWrite | vk::AccessFlagBits2::eColorAttachmentWrite |
+		vk::AccessFlagBits2::eDepthStencilAttachmentWrite | vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eHostWrite | vk::AccessFlagBits2::eMemoryWrite;
+
+	ImageState ImageState::FromAccess( EImageAccess access ) {
+		switch ( access ) {
+		case EImageAccess::ColorAttachment:
+			return { vk::ImageLayout::eAttachmentOptimal, vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite };
+		case EImageAccess::DepthAttachment:
+			return { vk::ImageLayout::eAttachmentOptimal, vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests, 
+				vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite };
+		case EImageAccess::FragmentShaderRead:
+			return { vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits2::eFragmentShader, vk::AccessFlagBits2::eShaderSampledRead };
+		case EImageAccess::ComputeShaderRead:
+			return { vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderSampledRead };
+		case EImageAccess::ShaderRead:
+			return { vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits2::eFragmentShader | vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderSampledRead };
+		case EImageAccess::ComputeShaderWrite:
+			return { vk::ImageLayout::eGeneral, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderStorageRead | vk::AccessFlagBits2::eShaderStorageWrite };
+		case EImageAccess::TransferSrc:
+			return { vk::ImageLayout::eTransferSrcOptimal, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead };
+		case EImageAccess::TransferDst:
+			return { vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite };
+		case EImageAccess::Present:
+			return { vk::ImageLayout::ePresentSrcKHR, vk::PipelineStageFlagBits2::eNone, vk::AccessFlagBits2::eNone };
+		default:
+			return {};
+		}
+	}
+
+	static vk::ImageAspectFlags GetAspectMask( vk::Format format ) {
+		switch ( format ) {
+		case vk::Format::eD16Unorm:
+		case vk::Format::eD32Sfloat:
+		case vk::Format::eX8D24UnormPack32:
+			return vk::ImageAspectFlagBits::eDepth;
+		case vk::Format::eD16UnormS8Uint:
+		case vk::Format::eD24UnormS8Uint:
+		case vk::Format::eD32SfloatS8Uint:
+			return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+		default:
+			return vk::ImageAspectFlagBits::eColor;
+		}
+	}
+
+	static bool RangesOverlap( const vk::ImageSubresourceRange& a, const vk::ImageSubresourceRange& b ) {
+		auto end = []( uint32_t base, uint32_t count ) { return count == vk::RemainingMipLevels ? UINT32_MAX : base + count; };
+
+		return a.baseMipLevel < end( b.baseMipLevel, b.levelCount ) && b.baseMipLevel < end( a.baseMipLevel, a.levelCount ) &&
+			a.baseArrayLayer < end( b.baseArrayLayer, b.layerCount ) && b.baseArrayLayer < end( a.baseArrayLayer, a.layerCount );
 	}
 
-	CommandBuffer::CommandBuffer( Device& device, const vk::CommandPool& commandPool ) { 
+	CommandBuffer::CommandBuffer( const vk::Device& device, const vk::CommandPool& commandPool, vk::CommandBufferLevel level ) { 
 		vk::CommandBufferAllocateInfo allocateInfo = {};
 		allocateInfo.commandPool = commandPool;
-		allocateInfo.level = vk::CommandBufferLevel::ePrimary;
+		allocateInfo.level = level;
 		allocateInfo.commandBufferCount = 1;
-		m_CommandBuffer = device->allocateCommandBuffers( allocateInfo )[ 0 ];
+		m_CommandBuffer = device.allocateCommandBuffers( allocateInfo )[ 0 ];
 	}
 	
 	void CommandBuffer::Begin( vk::CommandBufferUsageFlagBits flags ) {
@@ -28,53 +71,147 @@ namespace Boundless {
 		m_CommandBuffer.begin( commandBufferBeginInfo );
 	}
 	
-	void CommandBuffer::End() {
-		m_CommandBuffer.end();
-	}
-	
-	void CommandBuffer::Submit( const vk::Queue& queue, bool wait ) { 
-		vk::SubmitInfo submitInfo = {};
-		submitInfo.setCommandBuffers( { m_CommandBuffer } );
+	void CommandBuffer::BeginSecondary( const vk::CommandBufferInheritanceRenderingInfo& renderingInfo ) {
+		vk::CommandBufferInheritanceInfo inheritanceInfo = {};
+		inheritanceInfo.pNext = &renderingInfo;
 
-		queue.submit(submitInfo);
+		vk::CommandBufferBeginInfo commandBufferBeginInfo = {};
+		commandBufferBeginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+		commandBufferBeginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		m_CommandBuffer.begin( commandBufferBeginInfo );
+	}
 
-		if ( wait )
-			queue.waitIdle();
+	void CommandBuffer::End() {
+		FlushBarriers();
+		m_CommandBuffer.end();
 	}
 	
-	void CommandBuffer::CopyBuffer( const vk::Buffer& source, const vk::Buffer& destination, const vk::DeviceSize& size ) {
+	void CommandBuffer::CopyBuffer( const vk::Buffer& source, const vk::Buffer& destination, const vk::DeviceSize& size, vk::DeviceSize srcOffset, vk::DeviceSize dstOffset ) {
 		vk::BufferCopy bufferCopy = {};
-		bufferCopy.srcOffset = 0;
-		bufferCopy.dstOffset = 0;
+		bufferCopy.srcOffset = srcOffset;
+		bufferCopy.dstOffset = dstOffset;
 		bufferCopy.size = size;
 
+		FlushBarriers();
 		m_CommandBuffer.copyBuffer(source, destination, { bufferCopy } );
 	}
 	
-	void CommandBuffer::CopyBufferToImage( const vk::Buffer& buffer, const vk::Image& image, uint32_t width, uint32_t height ) {
+	void CommandBuffer::CopyBufferToImage( const vk::Buffer& buffer, const vk::Image& image, uint32_t width, uint32_t height, vk::DeviceSize bufferOffset, uint32_t mipLevel ) {
 		vk::BufferImageCopy region{};
-		region.bufferOffset = 0;
+		region.bufferOffset = bufferOffset;
 		region.bufferRowLength = 0;
 		region.bufferImageHeight = 0;
-		region.imageSubresource = vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, 0, 0, 1 };
+		region.imageSubresource = vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, mipLevel, 0, 1 };
 		region.imageOffset = vk::Offset3D{ 0, 0, 0 };
 		region.imageExtent = vk::Extent3D{ width, height, 1 };
 
+		FlushBarriers();
 		m_CommandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, { region } );
 	}
 	
-	void CommandBuffer::ImageBarrier( const vk::Image& image, vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask, vk::ImageLayout oldImageLayout, vk::ImageLayout newImageLayout, vk::PipelineStageFlags srcStageMask, vk::PipelineStageFlags dstStageMask, vk::ImageSubresourceRange subresourceRange ) {
-		vk::ImageMemoryBarrier barrier = {};
-		barrier.srcAccessMask = srcAccessMask;
-		barrier.dstAccessMask = dstAccessMask;
-		barrier.oldLayout = oldImageLayout;
-		barrier.newLayout = newImageLayout;
+	void CommandBuffer::Transition( Image& image, EImageAccess access, bool discard ) {
+		Transition( image, access, vk::ImageSubresourceRange{ GetAspectMask( image.GetFormat() ), 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers }, discard );
+	}
+
+	void CommandBuffer::Transition( Image& image, EImageAccess access, const vk::ImageSubresourceRange& range, bool discard ) {
+		// Views share their image's subresources, only the image they were created from tracks them.
+		assert( !image.m_States.empty() && "Transition of an image view, transition its image instead" );
+
+		const ImageState next = ImageState::FromAccess( access );
+		const Image::Desc& desc = image.m_Desc;
+
+		const uint32_t levelCount = range.levelCount == vk::RemainingMipLevels ? desc.m_Levels - range.baseMipLevel : range.levelCount;
+		const uint32_t layerCount = range.layerCount == vk::RemainingArrayLayers ? desc.m_Layers - range.baseArrayLayer : range.layerCount;
+
+		for ( uint32_t layer = range.baseArrayLayer; layer < range.baseArrayLayer + layerCount; layer++ ) {
+			for ( uint32_t level = range.baseMipLevel; level < range.baseMipLevel + levelCount; level++ ) {
+				ImageState& state = image.m_States[ layer * desc.m_Levels + level ];
+
+				vk::ImageMemoryBarrier2 barrier = {};
+				barrier.image = image.m_Image;
+				barrier.subresourceRange = vk::ImageSubresourceRange{ range.aspectMask, level, 1, layer, 1 };
+
+				const bool readAfterRead = !( ( state.m_Access | next.m_Access ) & WriteAccessMask );
+				if ( readAfterRead && !discard && state.m_Layout == next.m_Layout ) {
+					// Already visible to these stages, nothing to wait for.
+					if ( !( next.m_Stages & ~state.m_Stages ) && !( next.m_Access & ~state.m_Access ) )
+						continue;
+
+					// New readers chain onto the barrier which made the last write visible to the previous ones.
+					barrier.srcStageMask = state.m_Stages;
+					barrier.dstStageMask = next.m_Stages;
+					barrier.dstAccessMask = next.m_Access;
+					barrier.oldLayout = state.m_Layout;
+					barrier.newLayout = state.m_Layout;
+
+					state.m_Stages |= next.m_Stages;
+					state.m_Access |= next.m_Access;
+				} else {
+					// Reads only need an execution dependency, only writes have to be made available.
+					barrier.srcStageMask = state.m_Stages;
+					barrier.srcAccessMask = state.m_Access & WriteAccessMask;
+					barrier.dstStageMask = next.m_Stages;
+					barrier.dstAccessMask = next.m_Access;
+					barrier.oldLayout = discard ? vk::ImageLayout::eUndefined : state.m_Layout;
+					barrier.newLayout = next.m_Layout;
+
+					state = next;
+				}
+
+				QueueImageBarrier( barrier );
+			}
+		}
+	}
+
+	void CommandBuffer::ImageBarrier( const vk::Image& image, const ImageState& src, const ImageState& dst, const vk::ImageSubresourceRange& range ) {
+		vk::ImageMemoryBarrier2 barrier = {};
+		barrier.srcStageMask = src.m_Stages;
+		barrier.srcAccessMask = src.m_Access & WriteAccessMask;
+		barrier.dstStageMask = dst.m_Stages;
+		barrier.dstAccessMask = dst.m_Access;
+		barrier.oldLayout = src.m_Layout;
+		barrier.newLayout = dst.m_Layout;
 		barrier.image = image;
-		barrier.subresourceRange = subresourceRange;
+		barrier.subresourceRange = range;
 
-		m_CommandBuffer.pipelineBarrier( srcStageMask, dstStageMask, {}, {}, {}, { barrier } );
+		QueueImageBarrier( barrier );
 	}
-	
+
+	void CommandBuffer::QueueImageBarrier( const vk::ImageMemoryBarrier2& barrier ) {
+		// Barriers of a single pipelineBarrier2 aren't ordered against each other, a second transition of the same
+		// subresources goes into the next one.
+		for ( const vk::ImageMemoryBarrier2& queued : m_ImageBarriers ) {
+			if ( queued.image == barrier.image && RangesOverlap( queued.subresourceRange, barrier.subresourceRange ) ) {
+				FlushBarriers();
+				break;
+			}
+		}
+
+		// Subresources in the same state come one after the other, grow the last barrier over them.
+		if ( !m_ImageBarriers.empty() ) {
+			vk::ImageSubresourceRange& last = m_ImageBarriers.back().subresourceRange;
+			const vk::ImageSubresourceRange& next = barrier.subresourceRange;
+
+			vk::ImageMemoryBarrier2 merged = barrier;
+			merged.subresourceRange = last;
+
+			if ( merged == m_ImageBarriers.back() && last.levelCount != vk::RemainingMipLevels && last.layerCount != vk::RemainingArrayLayers ) {
+				if ( last.baseArrayLayer == next.baseArrayLayer && last.layerCount == next.layerCount && last.baseMipLevel + last.levelCount == next.baseMipLevel ) {
+					last.levelCount += next.levelCount;
+					return;
+				}
+
+				if ( last.baseMipLevel == next.baseMipLevel && last.levelCount == next.levelCount && last.baseArrayLayer + last.layerCount == next.baseArrayLayer ) {
+					last.layerCount += next.layerCount;
+					return;
+				}
+			}
+		}
+
+		m_ImageBarriers.push_back( barrier );
+	}
+
 	void CommandBuffer::StageBarrier( vk::PipelineStageFlags2 srcStageMask, vk::AccessFlags2 srcAccessMask, vk::PipelineStageFlags2 dstStageMask, vk::AccessFlags2 dstAccessMask ) {
 		vk::MemoryBarrier2 memoryBarrier = {};
 		memoryBarrier.srcStageMask = srcStageMask;
@@ -82,13 +219,28 @@ namespace Boundless {
 		memoryBarrier.dstStageMask = dstStageMask;
 		memoryBarrier.dstAccessMask = dstAccessMask;
 
+		// Goes out together with whatever image barriers are queued.
+		vk::DependencyInfo dependencyInfo = {};
+		dependencyInfo.setMemoryBarriers( { memoryBarrier })
+			.setImageMemoryBarriers( m_ImageBarriers );
+
+		m_CommandBuffer.pipelineBarrier2( dependencyInfo );
+		m_ImageBarriers.clear();
+	}
+
+	void CommandBuffer::FlushBarriers() {
+		if ( m_ImageBarriers.empty() )
+			return;
+
 		vk::DependencyInfo dependencyInfo = {};
-		dependencyInfo.setMemoryBarriers( { memoryBarrier });
+		dependencyInfo.setImageMemoryBarriers( m_ImageBarriers );
 
 		m_CommandBuffer.pipelineBarrier2( dependencyInfo );
+		m_ImageBarriers.clear();
 	}
 	
 	void CommandBuffer::BeginRendering( const vk::RenderingInfo& renderingInfo ) {
+		FlushBarriers();
 		m_CommandBuffer.beginRendering( renderingInfo);
 	}
 	
@@ -8,8 +8,9 @@ namespace Boundless {
 		friend class Device;
 	public:
 		CommandBuffer() = default;
-		CommandBuffer( Device& device );
-		CommandBuffer( Device& device, const vk::CommandPool& commandPool );
+		// Wraps a command buffer allocated elsewhere, e.g. by the CommandBufferManager.
+		explicit CommandBuffer( vk::CommandBuffer commandBuffer ) : m_CommandBuffer( commandBuffer ) { }
+		CommandBuffer( const vk::Device& device, const vk::CommandPool& commandPool, vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary );
 
 		operator vk::CommandBuffer&() { return m_CommandBuffer; }
 		operator const vk::CommandBuffer&() const { return m_CommandBuffer; }
@@ -17,13 +18,25 @@ namespace Boundless {
 		const vk::CommandBuffer* operator->() const { return &m_CommandBuffer; }
 
 		void Begin( vk::CommandBufferUsageFlagBits flags = {} );
+		// Secondary command buffer continuing a dynamic rendering pass of the given formats, executed within it.
+		void BeginSecondary( const vk::CommandBufferInheritanceRenderingInfo& renderingInfo );
 		void End();
-		void Submit( const vk::Queue& queue, bool wait = true );
-		void CopyBuffer( const vk::Buffer& source, const vk::Buffer& destination, const vk::DeviceSize& size );
-		void CopyBufferToImage( const vk::Buffer& buffer, const vk::Image& image, uint32_t width, uint32_t height );
-		void ImageBarrier( const vk::Image& image, vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask, vk::ImageLayout oldImageLayout, vk::ImageLayout newImageLayout, vk::PipelineStageFlags srcStageMask, vk::PipelineStageFlags dstStageMask, vk::ImageSubresourceRange subresourceRange );
+		void CopyBuffer( const vk::Buffer& source, const vk::Buffer& destination, const vk::DeviceSize& size, vk::DeviceSize srcOffset = 0, vk::DeviceSize dstOffset = 0 );
+		void CopyBufferToImage( const vk::Buffer& buffer, const vk::Image& image, uint32_t width, uint32_t height, vk::DeviceSize bufferOffset = 0, uint32_t mipLevel = 0 );
+
+		// Queues the barriers moving the subresources from their tracked state to access and updates the state. Reads
+		// following reads in the same layout need no barrier, subresources in the same state share one. discard drops
+		// the contents (transition from Undefined), for targets which are cleared or fully overwritten next. Images only,
+		// views have no state of their own.
+		// Queued barriers go out as a single pipelineBarrier2 with FlushBarriers, which BeginRendering, the copy helpers,
+		// StageBarrier and End call. Flush before recording anything else through operator->.
+		void Transition( Image& image, EImageAccess access, bool discard = false );
+		void Transition( Image& image, EImageAccess access, const vk::ImageSubresourceRange& range, bool discard = false );
+		// Queues a barrier for an image without tracked state, e.g. swapchain images.
+		void ImageBarrier( const vk::Image& image, const ImageState& src, const ImageState& dst, const vk::ImageSubresourceRange& range );
 		// void BufferBarrier( const vk::Buffer& buffer, vk::PipelineStageFlags2 srcStageMask, vk::AccessFlags2 srcAccessMask, vk::PipelineStageFlags2 dstStageMask, vk::AccessFlags2 dstAccessMask );
 		void StageBarrier( vk::PipelineStageFlags2 srcStageMask, vk::AccessFlags2 srcAccessMask, vk::PipelineStageFlags2 dstStageMask, vk::AccessFlags2 dstAccessMask );
+		void FlushBarriers();
 
 		void BeginRendering( const vk::RenderingInfo& renderingInfo );
 		void EndRendering();
@@ -39,6 +52,9 @@ namespace Boundless {
 		void BindIndexBuffer( Buffer& buffer, vk::IndexType indexType = vk::IndexType::eUint32 );
 		void BindPushConstants( Device& device, void* value, size_t size );
 	private:
-		vk::CommandBuffer m_CommandBuffer;
+		void QueueImageBarrier( const vk::ImageMemoryBarrier2& barrier );
+
+		vk::CommandBuffer					 m_CommandBuffer;
+		std::vector<vk::ImageMemoryBarrier2> m_ImageBarriers;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "Pch.hpp"
+#include "CommandBufferManager.hpp"
+
+namespace Boundless {
+	void CommandBufferManager::Create( vk::Device device, vk::Queue queue, uint32_t queueIndex ) {
+		m_Device = device;
+		m_Queue = queue;
+		m_QueueIndex = queueIndex;
+
+		vk::SemaphoreTypeCreateInfo timelineInfo = { vk::SemaphoreType::eTimeline, 0 };
+		m_Timeline = m_Device.createSemaphore( vk::SemaphoreCreateInfo{ {}, &timelineInfo } );
+	}
+
+	void CommandBufferManager::Destroy() {
+		std::lock_guard lock( m_Mutex );
+
+		for ( auto& [ threadId, threadPools ] : m_Threads ) {
+			for ( std::unique_ptr<FramePool>& framePool : threadPools->m_FramePools )
+				m_Device.destroyCommandPool( framePool->m_Pool );
+
+			// Frees the one-shot command buffers along with it.
+			if ( threadPools->m_OneShotPool )
+				m_Device.destroyCommandPool( threadPools->m_OneShotPool );
+		}
+
+		m_Threads.clear();
+		m_Device.destroySemaphore( m_Timeline );
+	}
+
+	void CommandBufferManager::BeginFrame( uint64_t frameIndex, uint64_t completedFrames ) {
+		std::lock_guard lock( m_Mutex );
+		m_FrameIndex = frameIndex;
+
+		for ( auto& [ threadId, threadPools ] : m_Threads ) {
+			for ( std::unique_ptr<FramePool>& framePool : threadPools->m_FramePools ) {
+				if ( framePool->m_Free || framePool->m_FrameIndex >= completedFrames )
+					continue;
+
+				// Buffers stay allocated, reset in place and handed out again.
+				m_Device.resetCommandPool( framePool->m_Pool );
+				framePool->m_UsedPrimaries = 0;
+				framePool->m_UsedSecondaries = 0;
+				framePool->m_Free = true;
+			}
+
+			RecycleOneShots( *threadPools );
+		}
+	}
+
+	CommandBufferManager::ThreadPools& CommandBufferManager::GetThreadPools() {
+		std::lock_guard lock( m_Mutex );
+
+		std::unique_ptr<ThreadPools>& threadPools = m_Threads[ std::this_thread::get_id() ];
+		if ( !threadPools )
+			threadPools = std::make_unique<ThreadPools>();
+
+		return *threadPools;
+	}
+
+	vk::CommandPool CommandBufferManager::CreatePool( vk::CommandPoolCreateFlags flags ) {
+		return m_Device.createCommandPool( vk::CommandPoolCreateInfo{ flags, m_QueueIndex } );
+	}
+
+	CommandBuffer CommandBufferManager::GetFrameCommandBuffer( vk::CommandBufferLevel level ) {
+		ThreadPools& threadPools = GetThreadPools();
+
+		FramePool* framePool = threadPools.m_Current;
+		if ( !framePool || framePool->m_Free || framePool->m_FrameIndex != m_FrameIndex ) {
+			framePool = nullptr;
+
+			for ( std::unique_ptr<FramePool>& candidate : threadPools.m_FramePools ) {
+				if ( candidate->m_Free ) {
+					framePool = candidate.get();
+					break;
+				}
+			}
+
+			if ( !framePool ) {
+				framePool = threadPools.m_FramePools.emplace_back( std::make_unique<FramePool>() ).get();
+				framePool->m_Pool = CreatePool( vk::CommandPoolCreateFlagBits::eTransient );
+			}
+
+			framePool->m_FrameIndex = m_FrameIndex;
+			framePool->m_Free = false;
+			threadPools.m_Current = framePool;
+		}
+
+		const bool primary = level == vk::CommandBufferLevel::ePrimary;
+		std::vector<vk::CommandBuffer>& buffers = primary ? framePool->m_Primaries : framePool->m_Secondaries;
+		size_t& used = primary ? framePool->m_UsedPrimaries : framePool->m_UsedSecondaries;
+
+		if ( used == buffers.size() )
+			buffers.push_back( CommandBuffer( m_Device, framePool->m_Pool, level ) );
+
+		return CommandBuffer( buffers[ used++ ] );
+	}
+
+	uint64_t CommandBufferManager::GetCompletedTimelineValue() const {
+		return m_Device.getSemaphoreCounterValue( m_Timeline );
+	}
+
+	void CommandBufferManager::WaitTimeline( uint64_t value ) const {
+		vk::SemaphoreWaitInfo waitInfo = {};
+		waitInfo.setSemaphores( m_Timeline )
+			.setValues( value );
+
+		// Sleeps in the driver until the GPU got there.
+		if ( m_Device.waitSemaphores( waitInfo, std::numeric_limits<uint64_t>::max() ) != vk::Result::eSuccess )
+			printf( "[CommandBufferManager] Waiting on timeline value %llu failed\n", value );
+	}
+
+	void CommandBufferManager::RecycleOneShots( ThreadPools& threadPools ) {
+		if ( threadPools.m_PendingOneShots.empty() )
+			return;
+
+		const uint64_t completedValue = GetCompletedTimelineValue();
+
+		std::erase_if( threadPools.m_PendingOneShots, [ & ]( const OneShot& oneShot ) {
+			if ( oneShot.m_TimelineValue > completedValue )
+				return false;
+
+			threadPools.m_FreeOneShots.push_back( oneShot );
+			return true;
+		} );
+	}
+
+	CommandBuffer CommandBufferManager::BeginOneShot() {
+		ThreadPools& threadPools = GetThreadPools();
+		RecycleOneShots( threadPools );
+
+		if ( !threadPools.m_OneShotPool )
+			threadPools.m_OneShotPool = CreatePool( vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer );
+
+		OneShot oneShot = {};
+		if ( !threadPools.m_FreeOneShots.empty() ) {
+			oneShot = threadPools.m_FreeOneShots.back();
+			threadPools.m_FreeOneShots.pop_back();
+		} else {
+			oneShot.m_CommandBuffer = CommandBuffer( m_Device, threadPools.m_OneShotPool );
+		}
+
+		threadPools.m_RecordingOneShots.push_back( oneShot );
+
+		CommandBuffer commandBuffer = CommandBuffer( oneShot.m_CommandBuffer );
+		commandBuffer->reset();
+		commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+		return commandBuffer;
+	}
+
+	void CommandBufferManager::SubmitOneShot( CommandBuffer& commandBuffer, bool wait ) {
+		ThreadPools& threadPools = GetThreadPools();
+
+		const vk::CommandBuffer handle = commandBuffer;
+		auto it = std::find_if( threadPools.m_RecordingOneShots.begin(), threadPools.m_RecordingOneShots.end(), [ & ]( const OneShot& oneShot ) {
+			return oneShot.m_CommandBuffer == handle;
+		} );
+
+		// Submitting it anyway would hand the same buffer out twice, or submit one still recording on another thread.
+		assert( it != threadPools.m_RecordingOneShots.end() && "SubmitOneShot of a command buffer this thread didn't begin" );
+		if ( it == threadPools.m_RecordingOneShots.end() )
+			return;
+
+		OneShot oneShot = *it;
+		threadPools.m_RecordingOneShots.erase( it );
+
+		commandBuffer.End();
+		oneShot.m_TimelineValue = ReserveTimelineValue();
+
+		vk::CommandBufferSubmitInfo cmdInfo = vk::CommandBufferSubmitInfo( commandBuffer );
+		vk::SemaphoreSubmitInfo signalInfo = vk::SemaphoreSubmitInfo( m_Timeline, oneShot.m_TimelineValue, vk::PipelineStageFlagBits2::eAllCommands, 0 );
+
+		vk::SubmitInfo2 submitInfo = {};
+		submitInfo.setCommandBufferInfos( cmdInfo )
+			.setSignalSemaphoreInfos( signalInfo );
+
+		m_Queue.submit2( submitInfo );
+
+		if ( !wait ) {
+			threadPools.m_PendingOneShots.push_back( oneShot );
+			return;
+		}
+
+		WaitTimeline( oneShot.m_TimelineValue );
+		threadPools.m_FreeOneShots.push_back( oneShot );
+	}
+}
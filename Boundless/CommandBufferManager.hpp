@@ -0,0 +1,86 @@
+#pragma once
+#include "CommandBuffer.hpp"
+
+namespace Boundless {
+	// Hands out graphics queue command buffers from pools owned by the calling thread, nothing is freed one by one.
+	//
+	// Frame command buffers come from a pool per thread and frame. Once the frame is known to be finished on the GPU the
+	// whole pool is reset and reused for a later frame, pools only grow to the most a thread records in one frame.
+	// One-shot command buffers (loads, blocking uploads) are recorded on the calling thread and recycled once the GPU is
+	// done with them.
+	//
+	// Every graphics queue submit, frames and one-shots, signals the next value of one timeline semaphore. Waiting for
+	// a submit is a blocking wait on its value, no fences.
+	class CommandBufferManager {
+	public:
+		CommandBufferManager() = default;
+		~CommandBufferManager() = default;
+
+		CommandBufferManager( const CommandBufferManager& ) = delete;
+		CommandBufferManager& operator=( const CommandBufferManager& ) = delete;
+
+		void Create( vk::Device device, vk::Queue queue, uint32_t queueIndex );
+		// Device must be idle.
+		void Destroy();
+
+		// Resets the pools of every frame before completedFrames. Called by Device::BeginFrame while no other thread records.
+		void BeginFrame( uint64_t frameIndex, uint64_t completedFrames );
+
+		// Valid until the frame finished on the GPU, not begun. Secondary buffers are for the calling thread's share of a
+		// frame's work, executed by a primary of the same frame.
+		CommandBuffer GetFrameCommandBuffer( vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary );
+
+		// Begun with eOneTimeSubmit. Has to be given back through SubmitOneShot on the thread which began it.
+		CommandBuffer BeginOneShot();
+		// Ends and submits to the graphics queue, wait blocks until the GPU is done. Queue submits aren't synchronized,
+		// only call this from the thread submitting frames.
+		void SubmitOneShot( CommandBuffer& commandBuffer, bool wait = true );
+
+		vk::Semaphore GetTimeline() const { return m_Timeline; }
+		// Value the next graphics queue submit has to signal on the timeline, submits must signal them in order.
+		uint64_t ReserveTimelineValue() { return ++m_TimelineValue; }
+		uint64_t GetCompletedTimelineValue() const;
+		// Sleeps until the timeline reached value.
+		void WaitTimeline( uint64_t value ) const;
+	private:
+		struct FramePool {
+			vk::CommandPool				   m_Pool;
+			uint64_t					   m_FrameIndex = 0;
+			bool						   m_Free = true;
+			std::vector<vk::CommandBuffer> m_Primaries;
+			std::vector<vk::CommandBuffer> m_Secondaries;
+			size_t						   m_UsedPrimaries = 0;
+			size_t						   m_UsedSecondaries = 0;
+		};
+
+		struct OneShot {
+			vk::CommandBuffer m_CommandBuffer;
+			uint64_t		  m_TimelineValue = 0;
+		};
+
+		// Only touched by its thread, and by BeginFrame/Destroy while that thread is idle.
+		struct ThreadPools {
+			std::vector<std::unique_ptr<FramePool>> m_FramePools;
+			FramePool*								m_Current = nullptr;
+
+			vk::CommandPool							m_OneShotPool;
+			std::vector<OneShot>					m_FreeOneShots;
+			std::vector<OneShot>					m_RecordingOneShots;
+			std::vector<OneShot>					m_PendingOneShots; // Submitted without waiting.
+		};
+
+		ThreadPools& GetThreadPools();
+		vk::CommandPool CreatePool( vk::CommandPoolCreateFlags flags );
+		void RecycleOneShots( ThreadPools& threadPools );
+
+		vk::Device													m_Device;
+		vk::Queue													m_Queue;
+		uint32_t													m_QueueIndex = 0;
+		uint64_t													m_FrameIndex = 0;
+		vk::Semaphore												m_Timeline;
+		uint64_t													m_TimelineValue = 0;
+
+		std::mutex													m_Mutex;
+		std::unordered_map<std::thread::id, std::unique_ptr<ThreadPools>> m_Threads;
+	};
+}
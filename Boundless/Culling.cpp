@@ -0,0 +1,101 @@
+#include "Pch.hpp"
+#include "Culling.hpp"
+
+namespace Boundless {
+	Frustum Frustum::FromMatrix( const glm::mat4& viewProjection ) {
+		// Gribb & Hartmann plane extraction, glm matrices are column major so grab the rows first.
+		glm::mat4 m = glm::transpose( viewProjection );
+
+		Frustum frustum = {};
+		frustum.m_Planes[ 0 ] = m[ 3 ] + m[ 0 ]; // Left
+		frustum.m_Planes[ 1 ] = m[ 3 ] - m[ 0 ]; // Right
+		frustum.m_Planes[ 2 ] = m[ 3 ] + m[ 1 ]; // Bottom
+		frustum.m_Planes[ 3 ] = m[ 3 ] - m[ 1 ]; // Top
+#ifdef GLM_FORCE_DEPTH_ZERO_TO_ONE
+		frustum.m_Planes[ 4 ] = m[ 2 ];			 // Near
+#else
+		frustum.m_Planes[ 4 ] = m[ 3 ] + m[ 2 ]; // Near
+#endif
+		frustum.m_Planes[ 5 ] = m[ 3 ] - m[ 2 ]; // Far
+
+		for ( glm::vec4& plane : frustum.m_Planes )
+			plane /= glm::length( glm::vec3( plane ) );
+
+		return frustum;
+	}
+
+	void CullBoxes::Clear() {
+		m_CenterX.clear();
+		m_CenterY.clear();
+		m_CenterZ.clear();
+		m_ExtentX.clear();
+		m_ExtentY.clear();
+		m_ExtentZ.clear();
+		m_Ids.clear();
+		m_ValidCount = 0;
+	}
+
+	void CullBoxes::Add( const glm::vec3& center, const glm::vec3& extents, uint32_t id ) {
+		m_CenterX.push_back( center.x );
+		m_CenterY.push_back( center.y );
+		m_CenterZ.push_back( center.z );
+		m_ExtentX.push_back( extents.x );
+		m_ExtentY.push_back( extents.y );
+		m_ExtentZ.push_back( extents.z );
+		m_Ids.push_back( id );
+		m_ValidCount++;
+	}
+
+	void CullBoxes::Pad() {
+		// Pad with boxes that are guaranteed to fail the test so the SIMD loop needs no tail.
+		while ( m_Ids.size() % CullBatchSize ) {
+			m_CenterX.push_back( 0.f );
+			m_CenterY.push_back( 0.f );
+			m_CenterZ.push_back( 0.f );
+			m_ExtentX.push_back( -FLT_MAX );
+			m_ExtentY.push_back( -FLT_MAX );
+			m_ExtentZ.push_back( -FLT_MAX );
+			m_Ids.push_back( UINT32_MAX );
+		}
+	}
+
+	void FrustumCullBoxes( const Frustum& frustum, const CullBoxes& boxes, std::vector<uint32_t>& outVisible ) {
+		const size_t count = boxes.GetCount();
+
+		for ( size_t i = 0; i < count; i += CullBoxes::CullBatchSize ) {
+			__m256 cx = _mm256_loadu_ps( &boxes.m_CenterX[ i ] );
+			__m256 cy = _mm256_loadu_ps( &boxes.m_CenterY[ i ] );
+			__m256 cz = _mm256_loadu_ps( &boxes.m_CenterZ[ i ] );
+			__m256 ex = _mm256_loadu_ps( &boxes.m_ExtentX[ i ] );
+			__m256 ey = _mm256_loadu_ps( &boxes.m_ExtentY[ i ] );
+			__m256 ez = _mm256_loadu_ps( &boxes.m_ExtentZ[ i ] );
+
+			__m256 inside = _mm256_castsi256_ps( _mm256_set1_epi32( -1 ) );
+
+			for ( const glm::vec4& plane : frustum.m_Planes ) {
+				__m256 nx = _mm256_set1_ps( plane.x );
+				__m256 ny = _mm256_set1_ps( plane.y );
+				__m256 nz = _mm256_set1_ps( plane.z );
+				__m256 nw = _mm256_set1_ps( plane.w );
+
+				// Signed distance of the center plus the projected radius of the box onto the plane normal.
+				__m256 distance = _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( nx, cx ), _mm256_mul_ps( ny, cy ) ), _mm256_add_ps( _mm256_mul_ps( nz, cz ), nw ) );
+				__m256 radius = _mm256_add_ps( _mm256_add_ps(
+					_mm256_mul_ps( _mm256_set1_ps( std::abs( plane.x ) ), ex ),
+					_mm256_mul_ps( _mm256_set1_ps( std::abs( plane.y ) ), ey ) ),
+					_mm256_mul_ps( _mm256_set1_ps( std::abs( plane.z ) ), ez ) );
+
+				inside = _mm256_and_ps( inside, _mm256_cmp_ps( _mm256_add_ps( distance, radius ), _mm256_setzero_ps(), _CMP_GE_OQ ) );
+			}
+
+			uint32_t mask = uint32_t( _mm256_movemask_ps( inside ) );
+			while ( mask ) {
+				unsigned long bit = 0;
+				_BitScanForward( &bit, mask );
+				mask &= mask - 1;
+
+				outVisible.push_back( boxes.m_Ids[ i + bit ] );
+			}
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	struct Frustum {
+		// Planes are stored as ( normal, distance ) with the normal pointing inwards.
+		std::array<glm::vec4, 6> m_Planes{};
+
+		static Frustum FromMatrix( const glm::mat4& viewProjection );
+	};
+
+	// Structure of arrays layout so the culler can test 8 boxes per iteration.
+	// Sizes are always padded to a multiple of CullBatchSize.
+	struct CullBoxes {
+		constexpr static const size_t CullBatchSize = 8;
+
+		void Clear();
+		void Add( const glm::vec3& center, const glm::vec3& extents, uint32_t id );
+		void Pad();
+
+		size_t GetCount() const { return m_Ids.size(); }
+
+		std::vector<float>	  m_CenterX;
+		std::vector<float>	  m_CenterY;
+		std::vector<float>	  m_CenterZ;
+		std::vector<float>	  m_ExtentX;
+		std::vector<float>	  m_ExtentY;
+		std::vector<float>	  m_ExtentZ;
+		std::vector<uint32_t> m_Ids;
+		size_t				  m_ValidCount = 0;
+	};
+
+	// Appends the ids of every box intersecting the frustum to outVisible.
+	void FrustumCullBoxes( const Frustum& frustum, const CullBoxes& boxes, std::vector<uint32_t>& outVisible );
+}
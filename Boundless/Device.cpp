@@ -8,6 +8,67 @@
 #pragma comment(lib, "ktx.lib")
 
 namespace Boundless {
+	// UMA devices share one memory with the CPU. Discrete ones count when a host visible device local heap covers most of
+	// VRAM (resizable BAR), the 256 MB window without it is left to VMA for small per-frame data.
+	static bool HasHostVisibleVRAM( vk::PhysicalDevice physicalDevice ) {
+		const vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
+		const vk::PhysicalDeviceMemoryProperties memory = physicalDevice.getMemoryProperties();
+
+		const vk::MemoryPropertyFlags hostVisibleVRAM = vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eHostVisible;
+
+		vk::DeviceSize largestDeviceHeap = 0;
+		vk::DeviceSize largestHostVisibleHeap = 0;
+		for ( uint32_t i = 0; i < memory.memoryTypeCount; i++ ) {
+			const vk::MemoryType& type = memory.memoryTypes[ i ];
+			const vk::DeviceSize heapSize = memory.memoryHeaps[ type.heapIndex ].size;
+
+			if ( type.propertyFlags & vk::MemoryPropertyFlagBits::eDeviceLocal )
+				largestDeviceHeap = std::max( largestDeviceHeap, heapSize );
+
+			if ( ( type.propertyFlags & hostVisibleVRAM ) == hostVisibleVRAM )
+				largestHostVisibleHeap = std::max( largestHostVisibleHeap, heapSize );
+		}
+
+		if ( largestHostVisibleHeap == 0 )
+			return false;
+
+		const bool isUMA = properties.deviceType == vk::PhysicalDeviceType::eIntegratedGpu || properties.deviceType == vk::PhysicalDeviceType::eCpu;
+		const bool isResizableBAR = largestHostVisibleHeap >= largestDeviceHeap / 2;
+
+		if ( isUMA || isResizableBAR )
+			printf( "[Device] %s, static uploads are written directly\n", isUMA ? "Unified memory" : "Resizable BAR" );
+
+		return isUMA || isResizableBAR;
+	}
+
+	// Copies straight into ShaderReadOnlyOptimal, implementations not listing it as a host copy destination aren't used.
+	static bool SupportsHostImageCopy( vk::PhysicalDevice physicalDevice ) {
+		vk::StructureChain features = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan14Features>();
+		if ( !features.get<vk::PhysicalDeviceVulkan14Features>().hostImageCopy )
+			return false;
+
+		vk::PhysicalDeviceHostImageCopyProperties hostCopyProperties = {};
+		vk::PhysicalDeviceProperties2 properties = {};
+		properties.pNext = &hostCopyProperties;
+		physicalDevice.getProperties2( &properties );
+
+		std::vector<vk::ImageLayout> dstLayouts( hostCopyProperties.copyDstLayoutCount );
+		hostCopyProperties.copySrcLayoutCount = 0;
+		hostCopyProperties.pCopyDstLayouts = dstLayouts.data();
+		physicalDevice.getProperties2( &properties );
+
+		return std::find( dstLayouts.begin(), dstLayouts.end(), vk::ImageLayout::eShaderReadOnlyOptimal ) != dstLayouts.end();
+	}
+
+	static vk::DeviceSize GetScratchOffsetAlignment( vk::PhysicalDevice physicalDevice ) {
+		vk::PhysicalDeviceAccelerationStructurePropertiesKHR asProperties = {};
+		vk::PhysicalDeviceProperties2 properties = {};
+		properties.pNext = &asProperties;
+		physicalDevice.getProperties2( &properties );
+
+		return std::max( asProperties.minAccelerationStructureScratchOffsetAlignment, 1u );
+	}
+
 	Device::Device( HWND windowHandle ) { 
 		uint32_t extensionCount = 0;
 		const char** glfwExtensions = glfwGetRequiredInstanceExtensions( &extensionCount );
@@ -27,6 +88,12 @@ namespace Boundless {
 		VULKAN_HPP_DEFAULT_DISPATCHER.init( m_Instance );
 
 		m_PhysicalDevice = vk_util::GetPhysicalDevice( m_Instance, extensions );
+
+		// Optional, the memory tracker falls back to heap sizes without it.
+		const bool hasMemoryBudget = vk_util::PhysicalDeviceHasExtensions( m_PhysicalDevice, { VK_EXT_MEMORY_BUDGET_EXTENSION_NAME } );
+		if ( hasMemoryBudget )
+			extensions.push_back( VK_EXT_MEMORY_BUDGET_EXTENSION_NAME );
+
 		m_Surface	     = vk_util::CreateSurfaceForWindow( m_Instance, windowHandle );
 		m_Device		 = vk_util::CreateLogicalDevice( m_Instance, m_PhysicalDevice, m_Surface, extensions );
 		VULKAN_HPP_DEFAULT_DISPATCHER.init( m_Device );
@@ -37,6 +104,8 @@ namespace Boundless {
 		allocInfo.instance = m_Instance;
 		allocInfo.vulkanApiVersion = VK_API_VERSION_1_4;
 		allocInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+		if ( hasMemoryBudget )
+			allocInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 
 		static vk::detail::DynamicLoader vmadl;
 
@@ -46,23 +115,56 @@ namespace Boundless {
 		allocInfo.pVulkanFunctions = &functions;
 
 		vmaCreateAllocator( &allocInfo, &m_Allocator );
+		m_MemoryTracker.Create( m_Allocator, hasMemoryBudget );
+
+		m_DirectUploads = HasHostVisibleVRAM( m_PhysicalDevice );
+		m_HostImageCopy = SupportsHostImageCopy( m_PhysicalDevice );
+		m_ScratchOffsetAlignment = GetScratchOffsetAlignment( m_PhysicalDevice );
+		CreateMemoryPools();
 
 		m_QueueIndex = vk_util::FindQueueFamilyIndex( m_Surface, m_PhysicalDevice );
 		m_Queue = m_Device.getQueue( m_QueueIndex, 0 );
 		
-		// TODO: maybe move or remove this? (It's useful though for things like mipmap gen, staging buffer copies, etc.)
+		m_CommandBuffers.Create( m_Device, m_Queue, m_QueueIndex );
+
+		// Only for libktx, which allocates and frees its own command buffers from it.
 		m_CommandPool = m_Device.createCommandPool( vk::CommandPoolCreateInfo( vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_QueueIndex ) );
 
+		m_TransferQueueIndex = vk_util::FindTransferQueueFamilyIndex( m_PhysicalDevice );
+		if ( m_TransferQueueIndex == vk::QueueFamilyIgnored )
+			m_TransferQueueIndex = m_QueueIndex;
+
+		m_TransferQueue = m_Device.getQueue( m_TransferQueueIndex, 0 );
+		m_TransferCommandPool = m_Device.createCommandPool( vk::CommandPoolCreateInfo( vk::CommandPoolCreateFlagBits::eTransient, m_TransferQueueIndex ) );
+
+		vk::SemaphoreTypeCreateInfo timelineInfo = { vk::SemaphoreType::eTimeline, 0 };
+		m_TransferTimeline = m_Device.createSemaphore( vk::SemaphoreCreateInfo{ {}, &timelineInfo } );
+
 		CreateGlobalDescriptors();
 		CreateSamplers();
+
+		m_UploadRing.Create( *this, UploadRingSize );
 	}
 
 	Device::~Device() { 
 		m_Device.waitIdle();
+		m_UploadRing.Release( *this );
+		RetireTransfers( UINT64_MAX );
+		DestroyRetiredResources( UINT64_MAX );
+		m_CommandBuffers.Destroy();
+
+		m_Device.destroySemaphore( m_TransferTimeline );
+		m_Device.destroyCommandPool( m_TransferCommandPool );
+
 		m_Device.destroyDescriptorSetLayout( m_GlobalResourceLayout );
 		m_Device.destroyDescriptorPool( m_DescriptorPool );
 		m_Device.destroyCommandPool( m_CommandPool );
 
+		for ( VmaPool pool : m_MemoryPools ) {
+			if ( pool != VK_NULL_HANDLE )
+				vmaDestroyPool( m_Allocator, pool );
+		}
+
 		vmaDestroyAllocator( m_Allocator );
 
 		m_Device.destroy();
@@ -77,6 +179,13 @@ namespace Boundless {
 		m_Device.updateDescriptorSets( { write }, nullptr );
 	}
 
+	void Device::UploadBufferToGPU( const vk::Buffer& buffer, uint32_t slotId ) {
+		vk::DescriptorBufferInfo bufferInfo = { buffer, 0, vk::WholeSize };
+		vk::WriteDescriptorSet		  write = { m_GlobalResources, 3, slotId, vk::DescriptorType::eStorageBuffer, {}, bufferInfo };
+
+		m_Device.updateDescriptorSets( { write }, nullptr );
+	}
+
 	void Device::CreateSamplers() {
 		m_Samplers[ LINEAR_CLAMP ] = CreateSampler( SamplerDesc{
 				.m_MinFilter = vk::Filter::eLinear,
@@ -112,12 +221,16 @@ namespace Boundless {
 	}
 
 	void Device::CreateGlobalDescriptors() {
-		vk::DescriptorSetLayoutBinding texturesDescriptorSetLayoutBinding = { 0, vk::DescriptorType::eSampledImage, 1024u, vk::ShaderStageFlagBits::eAll };
+		vk::DescriptorSetLayoutBinding texturesDescriptorSetLayoutBinding = { 0, vk::DescriptorType::eSampledImage, MaxBindlessImages, vk::ShaderStageFlagBits::eAll };
 		vk::DescriptorSetLayoutBinding accelerationStructureDescriptorSetLayoutBinding = { 1, vk::DescriptorType::eAccelerationStructureKHR, 1024u, vk::ShaderStageFlagBits::eAll };
 		vk::DescriptorSetLayoutBinding samplersDescriptorSetLayoutBinding = { 2, vk::DescriptorType::eSampler, SAMPLER_TYPE_MAX, vk::ShaderStageFlagBits::eAll };
+		vk::DescriptorSetLayoutBinding buffersDescriptorSetLayoutBinding = { 3, vk::DescriptorType::eStorageBuffer, MaxBindlessBuffers, vk::ShaderStageFlagBits::eAll };
+
+		// Images and buffers are created while frames are in flight (e.g. streamed textures), their slots are written while the set is in use.
+		const vk::DescriptorBindingFlags streamedBindingFlags = vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
 
-		std::array<vk::DescriptorBindingFlags, 3> descriptorBindingFlags = { vk::DescriptorBindingFlagBits::ePartiallyBound, vk::DescriptorBindingFlagBits::ePartiallyBound, vk::DescriptorBindingFlagBits::ePartiallyBound };
-		std::array<vk::DescriptorSetLayoutBinding, 3> bindings = { texturesDescriptorSetLayoutBinding, accelerationStructureDescriptorSetLayoutBinding, samplersDescriptorSetLayoutBinding };
+		std::array<vk::DescriptorBindingFlags, 4> descriptorBindingFlags = { streamedBindingFlags, vk::DescriptorBindingFlagBits::ePartiallyBound, vk::DescriptorBindingFlagBits::ePartiallyBound, streamedBindingFlags };
+		std::array<vk::DescriptorSetLayoutBinding, 4> bindings = { texturesDescriptorSetLayoutBinding, accelerationStructureDescriptorSetLayoutBinding, samplersDescriptorSetLayoutBinding, buffersDescriptorSetLayoutBinding };
 
 		vk::DescriptorSetLayoutBindingFlagsCreateInfo descriptorSetLayoutBindingFlags = {};
 		descriptorSetLayoutBindingFlags.setBindingFlags( descriptorBindingFlags );
@@ -128,10 +241,11 @@ namespace Boundless {
 
 		m_GlobalResourceLayout = m_Device.createDescriptorSetLayout( descriptorSetLayoutCreateInfo );
 
-		std::array<vk::DescriptorPoolSize, 3> descriptorPoolSizes = {
-			vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, 1024u },
+		std::array<vk::DescriptorPoolSize, 4> descriptorPoolSizes = {
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampledImage, MaxBindlessImages },
 			vk::DescriptorPoolSize{ vk::DescriptorType::eAccelerationStructureKHR, 1024u },
-			vk::DescriptorPoolSize{ vk::DescriptorType::eSampler, SAMPLER_TYPE_MAX }
+			vk::DescriptorPoolSize{ vk::DescriptorType::eSampler, SAMPLER_TYPE_MAX },
+			vk::DescriptorPoolSize{ vk::DescriptorType::eStorageBuffer, MaxBindlessBuffers }
 		};
 
 		vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
@@ -152,9 +266,65 @@ namespace Boundless {
 			.Build( *this );
 	}
 
-	ImageHandle Device::CreateImage( const Image::Desc& imageDesc ) {
-		Image res = {};
+	void Device::CreateMemoryPools() {
+		struct PoolDesc {
+			EMemoryPool				 m_Pool;
+			vk::BufferUsageFlags	 m_Usage;
+			VmaMemoryUsage			 m_MemoryUsage;
+			VmaAllocationCreateFlags m_AllocationFlags;
+			VmaPoolCreateFlags		 m_PoolFlags;
+			vk::DeviceSize			 m_BlockSize;
+			size_t					 m_MaxBlockCount;
+		};
+
+		constexpr vk::DeviceSize MB = 1024ull * 1024ull;
+
+		// Static data is written straight into the pools when VRAM is host visible, the GPU side is just as fast.
+		const VmaAllocationCreateFlags hostWrite = m_DirectUploads ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT : 0;
+
+		const vk::BufferUsageFlags commonUsage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress;
+
+		// The memory type is picked from a buffer using every usage the class allows, buffers in a pool only use a subset of them.
+		const std::array<PoolDesc, 5> poolDescs = {
+			PoolDesc{ EMemoryPool::Geometry, commonUsage | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, hostWrite, 0, 64 * MB, 0 },
+			PoolDesc{ EMemoryPool::Constants, commonUsage | vk::BufferUsageFlagBits::eUniformBuffer,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, hostWrite, 0, 16 * MB, 0 },
+			PoolDesc{ EMemoryPool::Scratch, commonUsage | vk::BufferUsageFlagBits::eIndirectBuffer,
+				VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE, 0, 0, 64 * MB, 0 },
+			PoolDesc{ EMemoryPool::Readback, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+				VMA_MEMORY_USAGE_AUTO_PREFER_HOST, VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT, 0, 16 * MB, 0 },
+			// Single block so the linear allocator works as a ring buffer, allocations are freed in the order they were made.
+			PoolDesc{ EMemoryPool::Frame, vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+				VMA_MEMORY_USAGE_AUTO, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT, VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT, 32 * MB, 1 },
+		};
+
+		for ( const PoolDesc& poolDesc : poolDescs ) {
+			VkBufferCreateInfo bufferInfo{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+			bufferInfo.size = 0x10000;
+			bufferInfo.usage = VkBufferUsageFlags( poolDesc.m_Usage );
+
+			VmaAllocationCreateInfo allocInfo = {};
+			allocInfo.usage = poolDesc.m_MemoryUsage;
+			allocInfo.flags = poolDesc.m_AllocationFlags;
+
+			uint32_t memoryTypeIndex = 0;
+			if ( vmaFindMemoryTypeIndexForBufferInfo( m_Allocator, &bufferInfo, &allocInfo, &memoryTypeIndex ) != VK_SUCCESS ) {
+				printf( "[Device] No memory type for pool %u, using default allocations\n", uint32_t( poolDesc.m_Pool ) );
+				continue;
+			}
+
+			VmaPoolCreateInfo poolInfo = {};
+			poolInfo.memoryTypeIndex = memoryTypeIndex;
+			poolInfo.flags = poolDesc.m_PoolFlags;
+			poolInfo.blockSize = poolDesc.m_BlockSize;
+			poolInfo.maxBlockCount = poolDesc.m_MaxBlockCount;
+
+			vmaCreatePool( m_Allocator, &poolInfo, &m_MemoryPools[ size_t( poolDesc.m_Pool ) ] );
+		}
+	}
 
+	static vk::ImageCreateInfo GetImageCreateInfo( const Image::Desc& imageDesc ) {
 		vk::ImageCreateInfo createInfo = {};
 		createInfo.setImageType( imageDesc.m_Type )
 			.setExtent( { imageDesc.m_Width, imageDesc.m_Height, 1 } )
@@ -165,25 +335,94 @@ namespace Boundless {
 			.setInitialLayout( vk::ImageLayout::eUndefined )
 			.setUsage( imageDesc.m_Usage )
 			.setSamples( imageDesc.m_Samples )
+			.setFlags( imageDesc.m_Flags )
 			.setSharingMode( vk::SharingMode::eExclusive );
 
+		return createInfo;
+	}
+
+	ImageHandle Device::CreateImage( const Image::Desc& imageDesc ) {
+		Image res = {};
+
+		vk::ImageCreateInfo createInfo = GetImageCreateInfo( imageDesc );
+
 		VmaAllocationCreateInfo allocInfo = {};
 		allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
 
+		// Only big render targets get their own memory, drivers prefer that for resources which are written every frame.
+		const bool isRenderTarget = bool( imageDesc.m_Usage & ( vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment ) );
+		if ( isRenderTarget && imageDesc.m_Width * imageDesc.m_Height >= DedicatedRenderTargetPixels )
+			allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
 		VkImageCreateInfo oldCreateInfo = createInfo;
 		VkImage imageHandle = VK_NULL_HANDLE;
-		vmaCreateImage( m_Allocator, &oldCreateInfo, &allocInfo, &imageHandle, &res.m_Allocation, nullptr );
+		VmaAllocationInfo allocationInfo = {};
+		VkResult result = vmaCreateImage( m_Allocator, &oldCreateInfo, &allocInfo, &imageHandle, &res.m_Allocation, &allocationInfo );
+
+		if ( result != VK_SUCCESS ) {
+			printf( "[Device] Failed to allocate %ux%u image for %s (VkResult %d)\n", imageDesc.m_Width, imageDesc.m_Height, MemoryTracker::GetCategoryName( GetMemoryCategory( imageDesc ) ), int( result ) );
+			m_MemoryTracker.Dump();
+			return ImageHandle::Invalid;
+		}
+
+		m_MemoryTracker.Add( GetMemoryCategory( imageDesc ), allocationInfo.size );
 
-		size_t newId = m_AllImages.size();
 		res.m_Image    = vk::Image( imageHandle );
-		res.m_Resource = ImageHandle( newId );
 		res.m_Desc	   = imageDesc;
-		m_AllImages.push_back(res);
+		res.m_States.resize( size_t( imageDesc.m_Levels ) * imageDesc.m_Layers );
+
+		ImageHandle handle = m_Images.Emplace( res );
+		m_Images.Get( handle ).m_Resource = handle;
 		
-		return res.m_Resource;
+		return handle;
+	}
+
+	vk::MemoryRequirements Device::GetImageMemoryRequirements( const Image::Desc& imageDesc ) const {
+		vk::ImageCreateInfo createInfo = GetImageCreateInfo( imageDesc );
+		return m_Device.getImageMemoryRequirements( vk::DeviceImageMemoryRequirements{ &createInfo } ).memoryRequirements;
+	}
+
+	VmaAllocation Device::AllocateAliasedMemory( const vk::MemoryRequirements& requirements ) {
+		VmaAllocationCreateInfo allocInfo = {};
+		allocInfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+		VkMemoryRequirements memoryRequirements = requirements;
+		VmaAllocation allocation = VK_NULL_HANDLE;
+		VmaAllocationInfo allocationInfo = {};
+
+		VkResult result = vmaAllocateMemory( m_Allocator, &memoryRequirements, &allocInfo, &allocation, &allocationInfo );
+		if ( result != VK_SUCCESS ) {
+			printf( "[Device] Failed to allocate %llu bytes of aliased memory (VkResult %d)\n", static_cast<unsigned long long>( requirements.size ), int( result ) );
+			m_MemoryTracker.Dump();
+			return VK_NULL_HANDLE;
+		}
+
+		m_MemoryTracker.Add( EMemoryCategory::RenderTargets, allocationInfo.size );
+		return allocation;
+	}
+
+	ImageHandle Device::CreateAliasedImage( const Image::Desc& imageDesc, VmaAllocation allocation, vk::DeviceSize offset ) {
+		Image res = {};
+		res.m_Image	  = m_Device.createImage( GetImageCreateInfo( imageDesc ) );
+		res.m_Desc	  = imageDesc;
+		res.m_Aliased = true;
+		res.m_States.resize( size_t( imageDesc.m_Levels ) * imageDesc.m_Layers );
+
+		VkResult result = vmaBindImageMemory2( m_Allocator, allocation, offset, res.m_Image, nullptr );
+		if ( result != VK_SUCCESS ) {
+			printf( "[Device] Failed to bind %ux%u image to aliased memory at offset %llu (VkResult %d)\n", imageDesc.m_Width, imageDesc.m_Height, static_cast<unsigned long long>( offset ), int( result ) );
+			m_Device.destroyImage( res.m_Image );
+			return ImageHandle::Invalid;
+		}
+
+		ImageHandle handle = m_Images.Emplace( res );
+		m_Images.Get( handle ).m_Resource = handle;
+
+		return handle;
 	}
 
-	ImageHandle Device::CreateImageView( ImageHandle resource, const Image::Desc& imageDesc ) {
+	ImageHandle Device::CreateImageView( ImageHandle resource, const Image::Desc& imageDesc, uint32_t baseMipLevel ) {
 		Image res = {};
 
 		vk::ImageViewCreateInfo createInfo = {};
@@ -193,7 +432,7 @@ namespace Boundless {
 			createInfo.viewType = vk::ImageViewType::e1D;
 			break;
 		case vk::ImageType::e2D:
-			createInfo.viewType = vk::ImageViewType::e2D;
+			createInfo.viewType = ( imageDesc.m_Flags & vk::ImageCreateFlagBits::eCubeCompatible ) && imageDesc.m_Layers == 6 ? vk::ImageViewType::eCube : vk::ImageViewType::e2D;
 			break;
 		case vk::ImageType::e3D:
 			createInfo.viewType = vk::ImageViewType::e3D;
@@ -201,44 +440,111 @@ namespace Boundless {
 		}
 
 		createInfo.format = imageDesc.m_Format;
-		createInfo.image = m_AllImages[ size_t( resource ) ];
+		createInfo.components = imageDesc.m_Swizzle;
+		createInfo.image = GetImage( resource );
 
 		bool isDepthImage = ( imageDesc.m_Usage & vk::ImageUsageFlagBits::eDepthStencilAttachment ) || ( imageDesc.m_Format == vk::Format::eD32Sfloat );
 		vk::ImageAspectFlags aspectMask =  isDepthImage ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
 
 		// TODO: Fixme. (I think it's good?)
-		createInfo.setSubresourceRange( vk::ImageSubresourceRange{ aspectMask, 0, imageDesc.m_Levels, 0, imageDesc.m_Layers });
+		createInfo.setSubresourceRange( vk::ImageSubresourceRange{ aspectMask, baseMipLevel, imageDesc.m_Levels - baseMipLevel, 0, imageDesc.m_Layers });
 
 		res.m_ImageView = m_Device.createImageView( createInfo );
 
-		size_t newId = m_AllImages.size();
+		res.m_Desc = imageDesc;
+
+		if ( imageDesc.m_Usage & vk::ImageUsageFlagBits::eSampled ) {
+			res.m_BindlessSlot = m_BindlessImages.Allocate();
+
+			// Shaders would sample whatever the descriptor last held, don't hand out a view they can't reach.
+			if ( res.m_BindlessSlot == BindlessSlots::Invalid ) {
+				printf( "[Device] Out of bindless image slots (%u), view not created\n", m_BindlessImages.GetCapacity() );
+				m_Device.destroyImageView( res.m_ImageView );
+				return ImageHandle::Invalid;
+			}
 
-		if( imageDesc.m_Usage & vk::ImageUsageFlagBits::eSampled ) {
-			UploadImageToGPU( res.m_ImageView, uint32_t( newId ) );
+			UploadImageToGPU( res.m_ImageView, res.m_BindlessSlot );
 		}
 
-		m_AllImages.push_back( res );
+		ImageHandle handle = m_Images.Emplace( res );
+		m_Images.Get( handle ).m_Resource = handle;
 
-		return ImageHandle(newId);
+		return handle;
 	}
 
 	ImageHandle Device::CreateImageView( ImageHandle resource ) {
-		return CreateImageView( resource, m_AllImages[ size_t( resource ) ].m_Desc );
+		return CreateImageView( resource, GetImage( resource ).m_Desc );
 	}
 
-	BufferHandle Device::CreateBuffer( const Buffer::Desc& bufferDesc ) {
-		size_t newId = m_AllBuffers.size();
-		m_AllBuffers.emplace_back( m_Device, m_Allocator, bufferDesc );
-		return BufferHandle( newId );
+	BufferHandle Device::CreateBuffer( const Buffer::Desc& desc ) {
+		Buffer::Desc bufferDesc = desc;
+		if ( bufferDesc.m_HostWrite && m_DirectUploads ) {
+			bufferDesc.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+			bufferDesc.m_Mappable = true;
+		}
+
+		BufferHandle handle = m_Buffers.Emplace( m_Device, m_Allocator, bufferDesc, m_MemoryPools[ size_t( bufferDesc.m_Pool ) ], &m_MemoryTracker );
+
+		// Buffer already reported the failed allocation.
+		if ( !GetBuffer( handle ).GetHandle() ) {
+			m_Buffers.Remove( handle );
+			return BufferHandle::Invalid;
+		}
+
+		if ( bufferDesc.m_Bindless && ( bufferDesc.m_Usage & vk::BufferUsageFlagBits::eStorageBuffer ) ) {
+			Buffer& buffer = GetBuffer( handle );
+			buffer.m_BindlessSlot = m_BindlessBuffers.Allocate();
+
+			if ( buffer.m_BindlessSlot == BindlessSlots::Invalid ) {
+				printf( "[Device] Out of bindless buffer slots (%u), buffer not created\n", m_BindlessBuffers.GetCapacity() );
+				buffer.Release();
+				m_Buffers.Remove( handle );
+				return BufferHandle::Invalid;
+			}
+
+			UploadBufferToGPU( buffer, buffer.m_BindlessSlot );
+		}
+
+		return handle;
 	}
 
 	std::unique_ptr<StagingBuffer> Device::CreateStagingBuffer( const vk::DeviceSize size ) {
-		return std::make_unique<StagingBuffer>(m_Device, m_Allocator, size);
+		return std::make_unique<StagingBuffer>( m_Device, m_Allocator, size, m_MemoryPools[ size_t( EMemoryPool::Frame ) ], &m_MemoryTracker );
+	}
+
+	void Device::UploadBuffer( CommandBuffer& commandBuffer, const vk::Buffer& destination, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset ) {
+		if ( size == 0 )
+			return;
+
+		UploadAllocation allocation = m_UploadRing.Allocate( size );
+		if ( allocation.IsValid() ) {
+			memcpy( allocation.m_Data, data, size_t( size ) );
+			commandBuffer.CopyBuffer( allocation.m_Buffer, destination, size, allocation.m_Offset, dstOffset );
+			return;
+		}
+
+		std::unique_ptr<StagingBuffer> stagingBuffer = CreateStagingBuffer( size );
+		stagingBuffer->Patch( data, size_t( size ) );
+		commandBuffer.CopyBuffer( *stagingBuffer, destination, size, 0, dstOffset );
+		ReleaseStagingBuffer( std::move( stagingBuffer ) );
+	}
+
+	void Device::UploadImage( CommandBuffer& commandBuffer, const vk::Image& image, const void* data, vk::DeviceSize size, uint32_t width, uint32_t height ) {
+		UploadAllocation allocation = m_UploadRing.Allocate( size );
+		if ( allocation.IsValid() ) {
+			memcpy( allocation.m_Data, data, size_t( size ) );
+			commandBuffer.CopyBufferToImage( allocation.m_Buffer, image, width, height, allocation.m_Offset );
+			return;
+		}
+
+		std::unique_ptr<StagingBuffer> stagingBuffer = CreateStagingBuffer( size );
+		stagingBuffer->Patch( data, size_t( size ) );
+		commandBuffer.CopyBufferToImage( *stagingBuffer, image, width, height );
+		ReleaseStagingBuffer( std::move( stagingBuffer ) );
 	}
 
 	void Device::TransitionImageLayout( const vk::Image& image, uint32_t levels, const vk::Format format, const vk::ImageLayout oldLayout, const vk::ImageLayout newLayout ) {
-		CommandBuffer commandBuffer = CommandBuffer(*this);
-		commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+		CommandBuffer commandBuffer = m_CommandBuffers.BeginOneShot();
 
 		vk::ImageMemoryBarrier barrier{};
 		barrier.oldLayout = oldLayout;
@@ -266,147 +572,188 @@ namespace Boundless {
 		}
 
 		commandBuffer->pipelineBarrier( sourceStage, destinationStage, {}, {}, {}, { barrier } );
-		commandBuffer.End();
-		commandBuffer.Submit(m_Queue);
-	}
-
-	void Device::GenerateMipmaps( const vk::Image& image, uint32_t width, uint32_t height, uint32_t mipLevels ) {
-		CommandBuffer commandBuffer = CommandBuffer( *this );
-		commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-
-		// Generate mipmaps.
-		vk::ImageMemoryBarrier imageBarrier = {};
-		imageBarrier.image = image;
-		imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		imageBarrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-		imageBarrier.subresourceRange.baseArrayLayer = 0;
-		imageBarrier.subresourceRange.layerCount = 1;
-		imageBarrier.subresourceRange.levelCount = 1;
-
-		int32_t mipWidth = width;
-		int32_t mipHeight = height;
-
-		for ( uint32_t i = 1u; i < mipLevels; i++ ) {
-			imageBarrier.subresourceRange.baseMipLevel = i - 1;
-			imageBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-			imageBarrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
-			imageBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-			imageBarrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-
-			commandBuffer->pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, { imageBarrier } );
-
-			vk::ImageBlit imageBlit = {};
-			imageBlit.srcSubresource.mipLevel = i - 1;
-			imageBlit.srcSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-			imageBlit.srcSubresource.baseArrayLayer = 0;
-			imageBlit.srcSubresource.layerCount = 1;
-			imageBlit.srcOffsets[ 0 ] = vk::Offset3D{ 0, 0, 0 };
-			imageBlit.srcOffsets[ 1 ] = vk::Offset3D{ mipWidth, mipHeight, 1 };
-
-			imageBlit.dstSubresource.mipLevel = i;
-			imageBlit.dstSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
-			imageBlit.dstSubresource.baseArrayLayer = 0;
-			imageBlit.dstSubresource.layerCount = 1;
-			imageBlit.dstOffsets[ 0 ] = imageBlit.srcOffsets[ 0 ];
-			imageBlit.dstOffsets[ 1 ] = vk::Offset3D{ mipWidth > 1 ? ( mipWidth >> 1 ) : 1 , mipHeight > 1 ? ( mipHeight >> 1 ) : 1, 1 };
-
-			commandBuffer->blitImage( image, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, { imageBlit }, vk::Filter::eLinear );
-
-			imageBarrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-			imageBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-			imageBarrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-			imageBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-			commandBuffer->pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, { imageBarrier } );
-
-			if ( mipWidth > 1 ) { mipWidth >>= 1; }
-			if ( mipHeight > 1 ) { mipHeight >>= 1; }
-		}
-
-		imageBarrier.subresourceRange.baseMipLevel = mipLevels - 1;
-		imageBarrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-		imageBarrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-		imageBarrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-		imageBarrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
-
-		commandBuffer->pipelineBarrier( vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, { imageBarrier } );
-
-		commandBuffer.End();
-		commandBuffer.Submit( m_Queue );
+		m_CommandBuffers.SubmitOneShot( commandBuffer );
 	}
 
 	std::pair<ImageHandle, ImageHandle> Device::LoadImageFromFile( const std::string& path, bool isSRGB ) {
 		int width{}, height{}, texChannels;
 		stbi_uc* pixels = stbi_load( path.c_str(), &width, &height, &texChannels, STBI_rgb_alpha );
 		if ( !pixels ) {
-			return {};
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
 		}
 
-		uint32_t mipLevels = uint32_t( std::floor( std::log2( std::max( width, height ) ) ) ) + 1;
+		// Mips are built on the CPU and go up with the top level in one copy, no blits.
+		MipChain chain = GenerateMips( pixels, uint32_t( width ), uint32_t( height ), MipDesc{ .m_SRGB = isSRGB } );
+		stbi_image_free( pixels );
 
-		vk::DeviceSize imageSize = width * height * 4; // This is kinda ghetto.
-		std::unique_ptr<StagingBuffer> stagingBuffer = std::make_unique<StagingBuffer>( m_Device, m_Allocator, imageSize );
+		Image::Desc imageDesc = {
+			.m_Type = vk::ImageType::e2D,
+			.m_Width = uint32_t(width),
+			.m_Height = uint32_t(height),
+			.m_Levels = uint32_t( chain.m_Levels.size() ),
+			.m_Format = isSRGB ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm,
+			.m_Tiling = vk::ImageTiling::eOptimal,
+			.m_Samples = vk::SampleCountFlagBits::e1,
+			.m_Usage = vk::ImageUsageFlagBits::eHostTransfer | vk::ImageUsageFlagBits::eSampled
+		};
 
-		void* data = stagingBuffer->Map();
-		memcpy( data, pixels, size_t( imageSize ) );
-		stagingBuffer->Unmap();
+		const bool hostCopy = CanHostCopy( imageDesc );
+		if ( !hostCopy )
+			imageDesc.m_Usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
 
-		stbi_image_free( pixels );
+		ImageHandle handle = CreateImage( imageDesc );
+		if ( handle == ImageHandle::Invalid )
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
 
-		vk::Format format = isSRGB ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
-
-		ImageHandle handle = CreateImage(
-			Image::Desc {
-				.m_Type = vk::ImageType::e2D,
-				.m_Width = uint32_t(width),
-				.m_Height = uint32_t(height),
-				.m_Levels = mipLevels,
-				.m_Format = format,
-				.m_Tiling = vk::ImageTiling::eOptimal,
-				.m_Samples = vk::SampleCountFlagBits::e1,
-				.m_Usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eSampled
+		if ( hostCopy ) {
+			std::vector<vk::MemoryToImageCopy> regions;
+			for ( uint32_t level = 0; level < uint32_t( chain.m_Levels.size() ); level++ ) {
+				const MipLevel& mip = chain.m_Levels[ level ];
+				regions.push_back( vk::MemoryToImageCopy{ chain.GetLevelData( level ), 0, 0, { vk::ImageAspectFlagBits::eColor, level, 0, 1 }, {}, { mip.m_Width, mip.m_Height, 1 } } );
 			}
-		);
 
-		Image& image = GetImage(handle);
+			CopyImageFromHost( GetImage( handle ), regions );
+		} else {
+			UploadBatch batch = UploadBatch( *this );
+			batch.UploadImageLevels( GetImage( handle ), 0, chain.m_Levels.data(), uint32_t( chain.m_Levels.size() ), chain.m_Pixels.data() );
+			batch.Submit();
+		}
+
+		ImageHandle viewHandle = CreateImageView( handle );
+
+		return { viewHandle, handle };
+	}
+
+	// Cooked textures store their channel packing as KTXswizzle, see TextureCooker.
+	static vk::ComponentMapping GetKTXSwizzle( ktxTexture* kTexture ) {
+		if ( kTexture->classId != ktxTexture2_c )
+			return {};
+
+		char* value = nullptr;
+		unsigned int valueLength = 0;
+		if ( ktxHashList_FindValue( &kTexture->kvDataHead, KTX_SWIZZLE_KEY, &valueLength, reinterpret_cast<void**>( &value ) ) != KTX_SUCCESS || valueLength < 4 )
+			return {};
+
+		return TextureCooker::ParseSwizzle( std::string( value, 4 ) );
+	}
+
+	std::pair<ImageHandle, ImageHandle> Device::LoadKTXImageFromHost( ktxTexture* kTexture ) {
+		if ( !m_HostImageCopy || ktxTexture_NeedsTranscoding( kTexture ) || kTexture->numDimensions != 2 || kTexture->isArray )
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
+
+		const bool isCube = kTexture->numFaces == 6;
+
+		Image::Desc imageDesc = {
+			.m_Type = vk::ImageType::e2D,
+			.m_Width = kTexture->baseWidth,
+			.m_Height = kTexture->baseHeight,
+			.m_Levels = kTexture->numLevels,
+			.m_Layers = kTexture->numFaces,
+			.m_Format = vk::Format( ktxTexture_GetVkFormat( kTexture ) ),
+			.m_Usage = vk::ImageUsageFlagBits::eHostTransfer | vk::ImageUsageFlagBits::eSampled,
+			.m_Swizzle = GetKTXSwizzle( kTexture ),
+			.m_Flags = isCube ? vk::ImageCreateFlagBits::eCubeCompatible : vk::ImageCreateFlags{}
+		};
+
+		if ( imageDesc.m_Format == vk::Format::eUndefined || !CanHostCopy( imageDesc ) )
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
 
-		TransitionImageLayout( image.m_Image, mipLevels, format, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal );
+		std::vector<vk::MemoryToImageCopy> regions;
+		for ( uint32_t level = 0; level < kTexture->numLevels; level++ ) {
+			for ( uint32_t face = 0; face < kTexture->numFaces; face++ ) {
+				ktx_size_t offset = 0;
+				ktxTexture_GetImageOffset( kTexture, level, 0, face, &offset );
 
-		{
-			CommandBuffer commandBuffer = CommandBuffer( *this );
-			commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-			commandBuffer.CopyBufferToImage( *stagingBuffer, image.m_Image, width, height );
-			commandBuffer.End();
-			commandBuffer.Submit( m_Queue );
+				const vk::Extent3D extent = { std::max( kTexture->baseWidth >> level, 1u ), std::max( kTexture->baseHeight >> level, 1u ), 1 };
+				regions.push_back( vk::MemoryToImageCopy{ ktxTexture_GetData( kTexture ) + offset, 0, 0, { vk::ImageAspectFlagBits::eColor, level, face, 1 }, {}, extent } );
+			}
 		}
 
-		GenerateMipmaps( image.m_Image, width, height, mipLevels );
-		CreateImageView( handle );
+		ImageHandle handle = CreateImage( imageDesc );
+		if ( handle == ImageHandle::Invalid )
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
+
+		CopyImageFromHost( GetImage( handle ), regions );
+
+		return { CreateImageView( handle ), handle };
+	}
+
+	bool Device::CanHostCopy( const Image::Desc& imageDesc ) const {
+		if ( !m_HostImageCopy )
+			return false;
+
+		vk::PhysicalDeviceImageFormatInfo2 formatInfo = { imageDesc.m_Format, imageDesc.m_Type, imageDesc.m_Tiling, imageDesc.m_Usage, imageDesc.m_Flags };
+
+		vk::HostImageCopyDevicePerformanceQuery performance = {};
+		vk::ImageFormatProperties2 properties = {};
+		properties.pNext = &performance;
+
+		if ( m_PhysicalDevice.getImageFormatProperties2( &formatInfo, &properties ) != vk::Result::eSuccess )
+			return false;
+
+		return performance.optimalDeviceAccess;
+	}
+
+	void Device::CopyImageFromHost( Image& image, const std::vector<vk::MemoryToImageCopy>& regions ) {
+		const Image::Desc& desc = image.GetDesc();
+
+		vk::HostImageLayoutTransitionInfo transition = { image, vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal,
+			{ vk::ImageAspectFlagBits::eColor, 0, desc.m_Levels, 0, desc.m_Layers } };
+		m_Device.transitionImageLayout( transition );
 
-		return { ImageHandle( m_AllImages.size() - 1 ), ImageHandle( m_AllImages.size() - 2) };
+		vk::CopyMemoryToImageInfo copyInfo = {};
+		copyInfo.dstImage = image;
+		copyInfo.dstImageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+		copyInfo.setRegions( regions );
+		m_Device.copyMemoryToImage( copyInfo );
+
+		// Done on the host, command buffers only have to put the image back in this state before anything samples it.
+		image.ResetState( ImageState::FromAccess( EImageAccess::ShaderRead ) );
 	}
 
 	std::pair<ImageHandle, ImageHandle> Device::LoadKTXImageFromFile( const std::string& path ) {
+		ktxTexture* kTexture = nullptr;
+		ktx_error_code_e result = ktxTexture_CreateFromNamedFile( path.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &kTexture );
+		if ( result != KTX_SUCCESS )
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
+
+		// Frees the file's data and libktx's upload state however this returns, the GPU copy is all that's kept.
+		struct KTXCleanup {
+			ktxTexture*			 m_Texture = nullptr;
+			ktxVulkanDeviceInfo* m_DeviceInfo = nullptr;
+
+			~KTXCleanup() {
+				if ( m_DeviceInfo )
+					ktxVulkanDeviceInfo_Destruct( m_DeviceInfo );
+
+				ktxTexture_Destroy( m_Texture );
+			}
+		} cleanup = { kTexture };
+
+		std::pair<ImageHandle, ImageHandle> hostCopied = LoadKTXImageFromHost( kTexture );
+		if ( hostCopied.first != ImageHandle::Invalid )
+			return hostCopied;
+
 		// This whole function should be redone.
 		ktxVulkanDeviceInfo deviceInfo = {};
 
-		ktx_error_code_e result = ktxVulkanDeviceInfo_Construct( &deviceInfo, m_PhysicalDevice, m_Device, m_Queue, m_CommandPool, nullptr );
+		result = ktxVulkanDeviceInfo_Construct( &deviceInfo, m_PhysicalDevice, m_Device, m_Queue, m_CommandPool, nullptr );
 		if ( result != KTX_SUCCESS )
-			return {};
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
 
-		ktxTexture* kTexture = nullptr;
-		result = ktxTexture_CreateFromNamedFile( path.c_str(), KTX_TEXTURE_CREATE_NO_FLAGS, &kTexture );
-		if ( result != KTX_SUCCESS )
-			return {};
+		cleanup.m_DeviceInfo = &deviceInfo;
+
+		// Owns the image and its memory, kept until ReleaseImage hands it back to libktx.
+		std::unique_ptr<ktxVulkanTexture> texturePtr = std::make_unique<ktxVulkanTexture>();
+		ktxVulkanTexture& texture = *texturePtr;
 
-		ktxVulkanTexture texture = {};
 		result = ktxTexture_VkUploadEx( kTexture, &deviceInfo, &texture, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-		if ( result != KTX_SUCCESS )
-			return {};
+		if ( result != KTX_SUCCESS ) {
+			printf( "[Device] Failed to upload %s (%s)\n", path.c_str(), ktxErrorString( result ) );
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
+		}
 
-		ktxTexture_Destroy( kTexture );
-		ktxVulkanDeviceInfo_Destruct( &deviceInfo );
+		const vk::ComponentMapping swizzle = GetKTXSwizzle( kTexture );
 
 		Image res = {};
 		res.m_Desc.m_Format = vk::Format( texture.imageFormat );
@@ -414,23 +761,40 @@ namespace Boundless {
 		res.m_Desc.m_Layers = texture.layerCount;
 		res.m_Desc.m_Width = texture.width;
 		res.m_Desc.m_Height = texture.height;
+		res.m_Desc.m_Swizzle = swizzle;
 		res.m_Image = vk::Image( texture.image );
+		// libktx leaves every subresource in the final layout given to the upload.
+		res.m_States.assign( size_t( res.m_Desc.m_Levels ) * res.m_Desc.m_Layers, ImageState::FromAccess( EImageAccess::ShaderRead ) );
 		
-		m_AllImages.push_back( res );
+		ImageHandle imageHandle = m_Images.Emplace( res );
+		m_Images.Get( imageHandle ).m_Resource = imageHandle;
+		m_MemoryTracker.Add( EMemoryCategory::Textures, GetMemorySize( res ) );
+		m_KTXTextures[ imageHandle ] = std::move( texturePtr );
+
+		// The view has no state of its own, see CommandBuffer::Transition.
+		res.m_States.clear();
 
 		vk::ImageViewCreateInfo textureView = {};
 		textureView.viewType = vk::ImageViewType( texture.viewType );
 		textureView.format = vk::Format( texture.imageFormat );
+		textureView.components = swizzle;
 		textureView.subresourceRange = vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, texture.levelCount, 0, texture.layerCount };
 		textureView.image = res.m_Image;
 
 		res.m_ImageView = m_Device.createImageView( textureView );
-		m_AllImages.push_back( res );
+		res.m_BindlessSlot = m_BindlessImages.Allocate();
 
-		ImageHandle viewHandle = ImageHandle( m_AllImages.size() - 1 );
-		ImageHandle imageHandle = ImageHandle( m_AllImages.size() - 2 );
+		if ( res.m_BindlessSlot == BindlessSlots::Invalid ) {
+			printf( "[Device] Out of bindless image slots (%u), view not created\n", m_BindlessImages.GetCapacity() );
+			m_Device.destroyImageView( res.m_ImageView );
+			ReleaseImage( imageHandle );
+			return { ImageHandle::Invalid, ImageHandle::Invalid };
+		}
+
+		ImageHandle viewHandle = m_Images.Emplace( res );
+		m_Images.Get( viewHandle ).m_Resource = viewHandle;
 
-		UploadImageToGPU( res.m_ImageView, uint32_t(viewHandle) );
+		UploadImageToGPU( res.m_ImageView, res.m_BindlessSlot );
 		
 		return { viewHandle, imageHandle };
 	}
@@ -454,19 +818,150 @@ namespace Boundless {
 		return m_Device.createSampler( samplerInfo );;
 	}
 
+	EMemoryCategory Device::GetMemoryCategory( const Image::Desc& imageDesc ) {
+		const vk::ImageUsageFlags writtenUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eStorage;
+		return ( imageDesc.m_Usage & writtenUsage ) ? EMemoryCategory::RenderTargets : EMemoryCategory::Textures;
+	}
+
+	vk::DeviceSize Device::GetMemorySize( const Image& image ) const {
+		// KTX images are allocated by libktx, outside of VMA.
+		if ( image.m_Allocation == VK_NULL_HANDLE )
+			return m_Device.getImageMemoryRequirements( image.m_Image ).size;
+
+		VmaAllocationInfo allocationInfo = {};
+		vmaGetAllocationInfo( m_Allocator, image.m_Allocation, &allocationInfo );
+		return allocationInfo.size;
+	}
+
 	void Device::ReleaseImage( ImageHandle handle ) { 
-		m_Device.waitIdle();
-		
-		// TODO: free index.
-		Image& image = m_AllImages[ size_t( handle ) ];
-		vmaDestroyImage(m_Allocator, image.m_Image, image.m_Allocation);
+		DeferRelease( [ this, handle ]() {
+			Image& image = GetImage( handle );
+
+			auto ktxImage = m_KTXTextures.find( handle );
+
+			// The memory belongs to whoever allocated it through AllocateAliasedMemory.
+			if ( image.m_Aliased ) {
+				m_Device.destroyImage( image.m_Image );
+			} else if ( ktxImage != m_KTXTextures.end() ) {
+				// Allocated by libktx, outside of VMA.
+				m_MemoryTracker.Remove( EMemoryCategory::Textures, GetMemorySize( image ) );
+				ktxVulkanTexture_Destruct( ktxImage->second.get(), m_Device, nullptr );
+				m_KTXTextures.erase( ktxImage );
+			} else {
+				m_MemoryTracker.Remove( GetMemoryCategory( image.m_Desc ), GetMemorySize( image ) );
+				vmaDestroyImage( m_Allocator, image.m_Image, image.m_Allocation );
+			}
+
+			m_Images.Remove( handle );
+		} );
+	}
+
+	void Device::ReleaseAliasedMemory( VmaAllocation allocation ) {
+		DeferRelease( [ this, allocation ]() {
+			VmaAllocationInfo allocationInfo = {};
+			vmaGetAllocationInfo( m_Allocator, allocation, &allocationInfo );
+
+			m_MemoryTracker.Remove( EMemoryCategory::RenderTargets, allocationInfo.size );
+			vmaFreeMemory( m_Allocator, allocation );
+		} );
 	}
 	
 	void Device::ReleaseImageView( ImageHandle handle ) { 
-		m_Device.waitIdle();
+		DeferRelease( [ this, handle ]() {
+			Image& image = GetImage( handle );
+			m_Device.destroyImageView( image.m_ImageView );
+			m_BindlessImages.Free( image.m_BindlessSlot );
+			m_Images.Remove( handle );
+		} );
+	}
+
+	void Device::ReleaseBuffer( BufferHandle handle ) { 
+		DeferRelease( [ this, handle ]() {
+			Buffer& buffer = GetBuffer( handle );
+			buffer.Release();
+			m_BindlessBuffers.Free( buffer.m_BindlessSlot );
+			m_Buffers.Remove( handle );
+		} );
+	}
+
+	void Device::ReleaseStagingBuffer( std::unique_ptr<StagingBuffer> stagingBuffer ) {
+		if ( !stagingBuffer )
+			return;
+
+		DeferRelease( [ buffer = stagingBuffer.release() ]() {
+			buffer->Release();
+			delete buffer;
+		} );
+	}
 
-		// TODO: free index.
-		Image& image = m_AllImages[ size_t( handle ) ];
-		m_Device.destroyImageView( image.m_ImageView );
+	void Device::DeferRelease( std::function<void()> release ) {
+		m_PendingReleases.push_back( PendingRelease{ m_FrameIndex, std::move( release ) } );
+	}
+
+	void Device::BeginFrame( uint64_t frameIndex, uint64_t completedFrames ) {
+		m_FrameIndex = frameIndex;
+		vmaSetCurrentFrameIndex( m_Allocator, uint32_t( frameIndex ) );
+		m_MemoryTracker.Update();
+		RetireTransfers( m_Device.getSemaphoreCounterValue( m_TransferTimeline ) );
+		m_UploadRing.BeginFrame( frameIndex, completedFrames );
+		m_CommandBuffers.BeginFrame( frameIndex, completedFrames );
+		DestroyRetiredResources( completedFrames );
+	}
+
+	void Device::DestroyRetiredResources( uint64_t completedFrames ) {
+		// Releases are queued in frame order, stop at the first one whose frame is still in flight.
+		while ( !m_PendingReleases.empty() && m_PendingReleases.front().m_FrameIndex < completedFrames ) {
+			PendingRelease pendingRelease = std::move( m_PendingReleases.front() );
+			m_PendingReleases.pop_front();
+
+			pendingRelease.m_Release();
+		}
+	}
+
+	uint64_t Device::SubmitTransfer( vk::CommandBuffer commandBuffer, OwnershipBarriers&& acquireBarriers, std::vector<std::unique_ptr<StagingBuffer>>&& stagingBuffers ) {
+		const uint64_t signalValue = ++m_TransferTimelineValue;
+
+		vk::CommandBufferSubmitInfo cmdInfo = vk::CommandBufferSubmitInfo( commandBuffer );
+		vk::SemaphoreSubmitInfo signalInfo = vk::SemaphoreSubmitInfo( m_TransferTimeline, signalValue, vk::PipelineStageFlagBits2::eAllCommands, 0 );
+
+		vk::SubmitInfo2 submitInfo = {};
+		submitInfo.setCommandBufferInfos( cmdInfo )
+			.setSignalSemaphoreInfos( signalInfo );
+
+		m_TransferQueue.submit2( submitInfo );
+
+		m_PendingAcquires.m_Buffers.insert( m_PendingAcquires.m_Buffers.end(), acquireBarriers.m_Buffers.begin(), acquireBarriers.m_Buffers.end() );
+		m_PendingAcquires.m_Images.insert( m_PendingAcquires.m_Images.end(), acquireBarriers.m_Images.begin(), acquireBarriers.m_Images.end() );
+		m_PendingTransferWait = signalValue;
+
+		m_TransferSubmissions.push_back( TransferSubmission{ signalValue, commandBuffer, std::move( stagingBuffers ) } );
+
+		return signalValue;
+	}
+
+	uint64_t Device::AcquireTransfers( CommandBuffer& commandBuffer ) {
+		// The graphics submit waits on the timeline before these run, so the release on the transfer queue has happened.
+		if ( !m_PendingAcquires.IsEmpty() ) {
+			vk::DependencyInfo dependencyInfo = {};
+			dependencyInfo.setBufferMemoryBarriers( m_PendingAcquires.m_Buffers )
+				.setImageMemoryBarriers( m_PendingAcquires.m_Images );
+
+			commandBuffer->pipelineBarrier2( dependencyInfo );
+			m_PendingAcquires = {};
+		}
+
+		return std::exchange( m_PendingTransferWait, 0 );
+	}
+
+	void Device::RetireTransfers( uint64_t completedValue ) {
+		while ( !m_TransferSubmissions.empty() && m_TransferSubmissions.front().m_TimelineValue <= completedValue ) {
+			TransferSubmission& submission = m_TransferSubmissions.front();
+
+			for ( std::unique_ptr<StagingBuffer>& stagingBuffer : submission.m_StagingBuffers )
+				stagingBuffer->Release();
+
+			m_Device.freeCommandBuffers( m_TransferCommandPool, { submission.m_CommandBuffer } );
+			m_TransferSubmissions.pop_front();
+		}
 	}
 }
\ No newline at end of file
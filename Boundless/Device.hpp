@@ -3,6 +3,14 @@
 #include "Image.hpp"
 #include "Buffer.hpp"
 #include "CommandBuffer.hpp"
+#include "CommandBufferManager.hpp"
+#include "SlotMap.hpp"
+#include "UploadRing.hpp"
+#include "UploadBatch.hpp"
+#include "MemoryTracker.hpp"
+
+struct ktxTexture;
+struct ktxVulkanTexture;
 
 namespace Boundless {
 	// TODO: Move to resources file.
@@ -19,6 +27,11 @@ namespace Boundless {
 		explicit Device(HWND windowHandle);
 		~Device();
 
+		constexpr static const uint32_t MaxBindlessImages = 1024u;
+		constexpr static const uint32_t MaxBindlessBuffers = 1024u;
+		constexpr static const uint32_t DedicatedRenderTargetPixels = 1024u * 1024u;
+		constexpr static const vk::DeviceSize UploadRingSize = 64ull * 1024ull * 1024ull;
+
 		operator vk::Device& ( ) { return m_Device; }
 		operator const vk::Device& ( ) const { return m_Device; }
 		vk::Device* operator->() { return &m_Device; }
@@ -29,11 +42,40 @@ namespace Boundless {
 		vk::PhysicalDevice GetPhysicalDevice() const { return m_PhysicalDevice; }
 		vk::Instance GetInstance() const { return m_Instance; }
 		vk::Device GetDevice() const { return m_Device; }
-		vk::CommandPool GetCommandPool() const { return m_CommandPool; }
 		vk::DescriptorPool GetDescriptorPool() const { return m_DescriptorPool; }
 
 		vk::Queue GetQueue() const { return m_Queue; }
 		uint32_t GetQueueIndex() const { return m_QueueIndex; }
+		// Graphics queue command buffers, frame ones and one-shots.
+		CommandBufferManager& GetCommandBuffers() { return m_CommandBuffers; }
+
+		// Dedicated transfer queue, falls back to the graphics queue when the device has no transfer only family.
+		vk::Queue GetTransferQueue() const { return m_TransferQueue; }
+		uint32_t GetTransferQueueIndex() const { return m_TransferQueueIndex; }
+		vk::CommandPool GetTransferCommandPool() const { return m_TransferCommandPool; }
+		vk::Semaphore GetTransferTimeline() const { return m_TransferTimeline; }
+		bool HasDedicatedTransferQueue() const { return m_TransferQueueIndex != m_QueueIndex; }
+		// Device local memory is host visible as a whole (resizable BAR, or UMA on integrated and CPU devices). Buffers created with
+		// m_HostWrite are then mapped and UploadBatch writes them directly instead of through a staging copy.
+		bool HasDirectUploads() const { return m_DirectUploads; }
+		// Host image copies (VK_EXT_host_image_copy, core in 1.4): images created with eHostTransfer usage are written
+		// straight from CPU memory, no staging buffer, command buffer or queue wait.
+		bool HasHostImageCopy() const { return m_HostImageCopy; }
+		// Acceleration structure build scratch addresses have to be multiples of it.
+		vk::DeviceSize GetScratchOffsetAlignment() const { return m_ScratchOffsetAlignment; }
+		// The format/usage combination supports host copies and the image stays as fast to access on the GPU with them.
+		bool CanHostCopy( const Image::Desc& imageDesc ) const;
+		// Transitions the whole image to ShaderReadOnlyOptimal and writes the regions into it from the host. The image
+		// must not be in use by the GPU.
+		void CopyImageFromHost( Image& image, const std::vector<vk::MemoryToImageCopy>& regions );
+
+		// Submits an async upload to the transfer queue and signals the transfer timeline. The command buffer and staging
+		// buffers are freed once the timeline reaches the returned value, acquireBarriers are recorded on the graphics
+		// queue by the next AcquireTransfers.
+		uint64_t SubmitTransfer( vk::CommandBuffer commandBuffer, OwnershipBarriers&& acquireBarriers, std::vector<std::unique_ptr<StagingBuffer>>&& stagingBuffers );
+		// Records the queue ownership acquires of finished submissions, returns the transfer timeline value the graphics
+		// submit has to wait on (0 if none).
+		uint64_t AcquireTransfers( CommandBuffer& commandBuffer );
 		
 		vk::DescriptorSet GetGlobalResources() const { return m_GlobalResources; }
 		vk::DescriptorSetLayout GetGlobalResourceLayout() const { return m_GlobalResourceLayout; }
@@ -41,8 +83,16 @@ namespace Boundless {
 
 		std::unique_ptr<StagingBuffer> CreateStagingBuffer( const vk::DeviceSize size );
 
+		// Copies through the upload ring and records the copy into commandBuffer. Payloads that don't fit the ring
+		// get a staging buffer which is released with the current frame.
+		void UploadBuffer( CommandBuffer& commandBuffer, const vk::Buffer& destination, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0 );
+		// Image must be in TransferDstOptimal, writes mip 0 of a tightly packed image.
+		void UploadImage( CommandBuffer& commandBuffer, const vk::Image& image, const void* data, vk::DeviceSize size, uint32_t width, uint32_t height );
+		UploadRing& GetUploadRing() { return m_UploadRing; }
+		// Live/peak bytes per category and heap budgets, refreshed by BeginFrame. GetMemoryTracker().Dump() prints them.
+		MemoryTracker& GetMemoryTracker() { return m_MemoryTracker; }
+
 		void TransitionImageLayout( const vk::Image& image, uint32_t levels, const vk::Format format, const vk::ImageLayout oldLayout, const vk::ImageLayout newLayout );
-		void GenerateMipmaps( const vk::Image& image, uint32_t width, uint32_t height, uint32_t mipLevels );
 
 		// These should be moved to some assets class.
 		std::pair<ImageHandle, ImageHandle> LoadImageFromFile( const std::string& path, bool isSRGB );
@@ -52,21 +102,68 @@ namespace Boundless {
 		vk::Sampler CreateSampler( const SamplerDesc& samplerDesc );
 		vk::Sampler GetSampler( ESamplerType samplerType ) const { return m_Samplers[ samplerType ]; }
 
+		// Invalid when the memory can't be allocated.
 		ImageHandle CreateImage( const Image::Desc& imageDesc );
-		ImageHandle CreateImageView( ImageHandle resource, const Image::Desc& imageDesc );
+		// Aliasing: images bound at offsets of memory they share with others whose contents they may overwrite, see
+		// RenderGraph. The memory is released separately, after every image placed in it.
+		vk::MemoryRequirements GetImageMemoryRequirements( const Image::Desc& imageDesc ) const;
+		VmaAllocation AllocateAliasedMemory( const vk::MemoryRequirements& requirements );
+		// Invalid when the image can't be bound at offset.
+		ImageHandle CreateAliasedImage( const Image::Desc& imageDesc, VmaAllocation allocation, vk::DeviceSize offset );
+		// baseMipLevel > 0 leaves the larger levels out of the view, e.g. while they are still being streamed in.
+		ImageHandle CreateImageView( ImageHandle resource, const Image::Desc& imageDesc, uint32_t baseMipLevel = 0 );
 		ImageHandle CreateImageView( ImageHandle resource );
+		// Invalid when the memory can't be allocated.
 		BufferHandle CreateBuffer( const Buffer::Desc& bufferDesc );
 
-		Buffer& GetBuffer( BufferHandle handle ) { return m_AllBuffers[ size_t( handle ) ]; }
-		Image& GetImage( ImageHandle handle ) { return m_AllImages[ size_t( handle ) ]; }
+		Buffer& GetBuffer( BufferHandle handle ) { return m_Buffers.Get( handle ); }
+		Image& GetImage( ImageHandle handle ) { return m_Images.Get( handle ); }
+
+		bool IsValid( BufferHandle handle ) const { return m_Buffers.IsValid( handle ); }
 
+		// Slot in the bindless descriptor arrays, the value shaders index them with. BindlessSlots::Invalid (-1) for
+		// invalid handles and resources without one (anything but sampled views and storage buffers).
+		uint32_t GetImageBindlessIndex( ImageHandle handle ) { return handle == ImageHandle::Invalid ? BindlessSlots::Invalid : GetImage( handle ).m_BindlessSlot; }
+		uint32_t GetBufferBindlessIndex( BufferHandle handle ) { return handle == BufferHandle::Invalid ? BindlessSlots::Invalid : GetBuffer( handle ).m_BindlessSlot; }
+
+		// Releases are deferred, the resource is retired with the current frame and destroyed once that frame's
+		// fence has signaled. The handle stays valid until then so the bindless slot isn't reused by an in-flight frame.
 		void ReleaseImage( ImageHandle handle );
 		void ReleaseImageView( ImageHandle handle );
+		void ReleaseBuffer( BufferHandle handle );
+		void ReleaseAliasedMemory( VmaAllocation allocation );
+		void ReleaseStagingBuffer( std::unique_ptr<StagingBuffer> stagingBuffer );
+		void DeferRelease( std::function<void()> release );
+
+		// Called once the frame's timeline value was waited on. completedFrames is the number of frames known to be finished on the GPU.
+		void BeginFrame( uint64_t frameIndex, uint64_t completedFrames );
 	private:
+		struct PendingRelease {
+			uint64_t			  m_FrameIndex;
+			std::function<void()> m_Release;
+		};
+
+		struct TransferSubmission {
+			uint64_t									m_TimelineValue;
+			vk::CommandBuffer							m_CommandBuffer;
+			std::vector<std::unique_ptr<StagingBuffer>> m_StagingBuffers;
+		};
+
+		void DestroyRetiredResources( uint64_t completedFrames );
+
+		// Host copy path of LoadKTXImageFromFile, returns invalid handles when the texture has to go through a queue.
+		std::pair<ImageHandle, ImageHandle> LoadKTXImageFromHost( ktxTexture* kTexture );
+
+		static EMemoryCategory GetMemoryCategory( const Image::Desc& imageDesc );
+		vk::DeviceSize GetMemorySize( const Image& image ) const;
+		void RetireTransfers( uint64_t completedValue );
+
 		void UploadImageToGPU( const vk::ImageView& imageView, uint32_t slotId );
+		void UploadBufferToGPU( const vk::Buffer& buffer, uint32_t slotId );
 
 		void CreateSamplers();
 		void CreateGlobalDescriptors();
+		void CreateMemoryPools();
 
 		vk::Device								  m_Device;
 		vk::Instance							  m_Instance;
@@ -75,7 +172,14 @@ namespace Boundless {
 		vk::PhysicalDevice						  m_PhysicalDevice;
 		vk::Queue								  m_Queue;
 		uint32_t								  m_QueueIndex;
+		CommandBufferManager					  m_CommandBuffers;
 		vk::CommandPool							  m_CommandPool;
+		vk::Queue								  m_TransferQueue;
+		uint32_t								  m_TransferQueueIndex;
+		vk::CommandPool							  m_TransferCommandPool;
+		vk::Semaphore							  m_TransferTimeline;
+		uint64_t								  m_TransferTimelineValue = 0;
+		uint64_t								  m_PendingTransferWait = 0;
 		vk::DescriptorPool						  m_DescriptorPool;
 		vk::DescriptorSetLayout					  m_GlobalResourceLayout;
 		vk::DescriptorSet						  m_GlobalResources;
@@ -83,7 +187,24 @@ namespace Boundless {
 		std::array<vk::Sampler, SAMPLER_TYPE_MAX> m_Samplers;
 
 		// TODO: Move to resources class.
-		std::vector<Image>	m_AllImages{ };
-		std::vector<Buffer> m_AllBuffers{ };
+		SlotMap<Image, ImageHandle>	  m_Images;
+		SlotMap<Buffer, BufferHandle> m_Buffers;
+		// Images uploaded by libktx, released through it.
+		std::map<ImageHandle, std::unique_ptr<ktxVulkanTexture>> m_KTXTextures;
+		BindlessSlots				  m_BindlessImages = BindlessSlots( MaxBindlessImages );
+		BindlessSlots				  m_BindlessBuffers = BindlessSlots( MaxBindlessBuffers );
+
+		// Indexed by EMemoryPool, Default stays null.
+		std::array<VmaPool, size_t( EMemoryPool::Count )> m_MemoryPools = {};
+		bool						  m_DirectUploads = false;
+		bool						  m_HostImageCopy = false;
+		vk::DeviceSize				  m_ScratchOffsetAlignment = 1;
+
+		MemoryTracker				  m_MemoryTracker;
+		UploadRing					  m_UploadRing;
+		std::deque<PendingRelease>	  m_PendingReleases;
+		std::deque<TransferSubmission> m_TransferSubmissions;
+		OwnershipBarriers			  m_PendingAcquires;
+		uint64_t					  m_FrameIndex = 0;
 	};
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Engine.hpp"
 
 #include "GLTFImporter.hpp"
+#include "SceneSerializer.hpp"
 
 #include "Device.hpp"
 
@@ -14,6 +15,8 @@ namespace Boundless {
 	Engine::Engine( GLFWwindow* window ) : m_GlfwWindow( window ) {
 		m_WindowHandle = glfwGetWin32Window( m_GlfwWindow );
 		m_Device	   = std::make_unique<Device>( m_WindowHandle );
+		m_TextureLoader = std::make_unique<TextureLoader>( *m_Device, m_ThreadPool, /* hashContents */ true );
+		m_RenderGraph	= std::make_unique<RenderGraph>( *m_Device );
 
 		// Compile shaders.
 		g_EngineShaders.GBufferPixelShader		  = m_ShaderCompiler.CompileShader( L"..\\Assets\\Shaders\\GBufferPS.hlsl", ShaderType::PixelShader );
@@ -25,23 +28,21 @@ namespace Boundless {
 		g_EngineShaders.FullscreenTriVertexShader = m_ShaderCompiler.CompileShader( L"..\\Assets\\Shaders\\FullscreenVS.hlsl", ShaderType::VertexShader );
 		g_EngineShaders.BrdfGenPixelShader		  = m_ShaderCompiler.CompileShader( L"..\\Assets\\Shaders\\IBL\\BRDFGenPS.hlsl", ShaderType::PixelShader );
 		g_EngineShaders.SkinningShader			  = m_ShaderCompiler.CompileShader( L"..\\Assets\\Shaders\\SkinningCS.hlsl", ShaderType::ComputeShader );
+		g_EngineShaders.CullShader				  = m_ShaderCompiler.CompileShader( L"..\\Assets\\Shaders\\CullCS.hlsl", ShaderType::ComputeShader );
+		g_EngineShaders.HiZShader				  = m_ShaderCompiler.CompileShader( L"..\\Assets\\Shaders\\HiZCS.hlsl", ShaderType::ComputeShader );
 		
 		// Create Swapchain...
 		OnResize();
 
 		// Create Sync Objects...
 		vk::SemaphoreCreateInfo semaphoreCreateInfo = {};
-		vk::FenceCreateInfo fenceCreateInfo = { vk::FenceCreateFlagBits::eSignaled };
 
 		const vk::Device& device = m_Device->GetDevice();
 
-		for ( auto i = 0; i < MaxFramesInFlight; i++ ) {
+		for ( uint32_t i = 0; i < MaxFramesInFlight; i++ ) {
 			FrameData& fd = m_FrameData[ i ];			
 			
-			fd.m_CommandPool			 = device.createCommandPool( vk::CommandPoolCreateInfo{ vk::CommandPoolCreateFlagBits::eResetCommandBuffer, m_Device->GetQueueIndex() } );
-			fd.m_CommandBuffer			 = CommandBuffer( *m_Device, fd.m_CommandPool );
 			fd.m_ImageAvailableSemaphore = device.createSemaphore( semaphoreCreateInfo );
-			fd.m_InFlightFence		     = device.createFence( fenceCreateInfo );
 		}
 
 		m_SwapchainRenderFinishedSemaphores.resize( m_SwapchainImages.size() );
@@ -51,12 +52,18 @@ namespace Boundless {
 
 		m_FrameConstantsBuffer = m_Device->CreateBuffer( Buffer::Desc{
 				.m_Size = sizeof( FrameConstants ),
-				.m_Usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO,
-				.m_Mappable = true
+				.m_Usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Pool = EMemoryPool::Constants
 			}
 		);
 
+		// Every pass reads the frame constants, there is nothing to render without them.
+		if ( m_FrameConstantsBuffer == BufferHandle::Invalid ) {
+			printf( "[Engine] Failed to allocate the frame constants buffer, exiting\n" );
+			glfwSetWindowShouldClose( m_GlfwWindow, GLFW_TRUE );
+		}
+
 		m_FullscreenPipeline = PipelineBuilder{}
 			.SetShaderBlobs( { { g_EngineShaders.FullscreenBlitPixelShader, vk::ShaderStageFlagBits::eFragment }, { g_EngineShaders.FullscreenTriVertexShader, vk::ShaderStageFlagBits::eVertex } } )
 			.SetColorAttachmentFormats( m_SwapchainImageFormat )
@@ -78,10 +85,19 @@ namespace Boundless {
 		}
 
 		{
-			GLTFImporter gltf( m_Scene );
-			if ( !gltf.LoadFromFile( "..\\Assets\\Models\\TwistDance\\Dance.gltf" ) ) {
-				printf( "Failed to load gltf file\n" );
-				return;
+			const std::string scenePath = "..\\Assets\\Models\\TwistDance\\Dance.gltf";
+			const std::string snapshotPath = std::filesystem::path( scenePath ).replace_extension( ".bscene" ).string();
+
+			// Only go through the glTF importer when there is no up to date snapshot of the scene.
+			SceneSerializer serializer( m_Scene );
+			if ( !SceneSerializer::IsUpToDate( snapshotPath, scenePath ) || !serializer.LoadFromFile( snapshotPath ) ) {
+				GLTFImporter gltf( m_Scene );
+				if ( !gltf.LoadFromFile( scenePath ) ) {
+					printf( "Failed to load gltf file\n" );
+					return;
+				}
+
+				serializer.SaveToFile( snapshotPath );
 			}
 		}
 		
@@ -90,24 +106,23 @@ namespace Boundless {
 		m_SpecularIbl = m_Device->LoadKTXImageFromFile( "..\\Assets\\IBL\\Inside\\specular.ktx2" ).first;
 		GenerateBrdfLut();
 
-		m_Scene.UploadToGPU(*m_Device);
+		m_Scene.UploadToGPU( *m_Device, *m_TextureLoader );
 
 		RecompilePasses();
+
+		// Textures are still streaming in, this is geometry, acceleration structures and render targets.
+		m_Device->GetMemoryTracker().Dump();
 	}
 
 	Engine::~Engine() {
 		const vk::Device& device = m_Device->GetDevice();
-		const vk::CommandPool& commandPool = m_Device->GetCommandPool();
 
 		device.waitIdle();
-		device.destroyCommandPool( commandPool );
 
 		DestroySwapchain();
 
 		for( FrameData& frameData : m_FrameData ) {
-			device.destroyCommandPool( frameData.m_CommandPool );
 			device.destroySemaphore( frameData.m_ImageAvailableSemaphore );
-			device.destroyFence( frameData.m_InFlightFence );
 		}
 		
 		for ( vk::Semaphore& semaphore : m_SwapchainRenderFinishedSemaphores )
@@ -130,14 +145,22 @@ namespace Boundless {
 		for ( BaseRenderPass* renderPass : m_RenderPasses )
 			renderPass->ReleasePassResources( *m_Device );
 
-		m_Skinning	   = std::make_unique<SkinningPass>();
-		m_GBuffer	   = std::make_unique<GBufferPass>( viewport );
-		m_GBufferDebug = std::make_unique<GBufferDebugPass>( viewport );
-		m_Lighting	   = std::make_unique<LightingPass>( viewport );
-		m_Composite	   = std::make_unique<CompositePass>( viewport );
+		m_Skinning			= std::make_unique<SkinningPass>();
+		m_FrustumCull		= std::make_unique<FrustumCullPass>();
+		m_SoftwareOcclusion	= std::make_unique<SoftwareOcclusionPass>();
+		m_GPUCull			= std::make_unique<GPUCullPass>();
+		m_HiZ				= std::make_unique<HiZPass>( viewport );
+		m_GBuffer			= std::make_unique<GBufferPass>( viewport );
+		m_GBufferDebug		= std::make_unique<GBufferDebugPass>( viewport );
+		m_Lighting			= std::make_unique<LightingPass>( viewport );
+		m_Composite			= std::make_unique<CompositePass>( viewport );
 
 		m_RenderPasses.clear();
 		m_RenderPasses.push_back( m_Skinning.get() );
+		m_RenderPasses.push_back( m_FrustumCull.get() );
+		m_RenderPasses.push_back( m_SoftwareOcclusion.get() );
+		m_RenderPasses.push_back( m_GPUCull.get() );
+		m_RenderPasses.push_back( m_HiZ.get() );
 		m_RenderPasses.push_back( m_GBuffer.get() );
 		m_RenderPasses.push_back( m_GBufferDebug.get() );
 		m_RenderPasses.push_back( m_Lighting.get() );
@@ -160,6 +183,11 @@ namespace Boundless {
 		};
 
 		ImageHandle brdfTex = m_Device->CreateImage( brdfDesc );
+		if ( brdfTex == ImageHandle::Invalid ) {
+			printf( "[Engine] Failed to create the BRDF LUT, rendering without IBL\n" );
+			return;
+		}
+
 		m_BrdfLut = m_Device->CreateImageView( brdfTex, brdfDesc );
 
 		vk::PipelineLayout brdfLutGenPipelineLayout = PipelineLayoutBuilder()
@@ -172,8 +200,8 @@ namespace Boundless {
 			.SetPipelineLayout( brdfLutGenPipelineLayout )
 			.Build( *m_Device );
 
-		CommandBuffer commandBuffer = CommandBuffer( *m_Device );
-		commandBuffer.Begin();
+		CommandBuffer commandBuffer = m_Device->GetCommandBuffers().BeginOneShot();
+		commandBuffer.Transition( m_Device->GetImage( brdfTex ), EImageAccess::ColorAttachment, true );
 
 		vk::ClearValue clearValue = { { 0.1f, 0.1f, 0.1f, 1.f } };
 		vk::RenderingAttachmentInfo colorAttachment = vk_util::RenderPassGetColorAttachmentInfo( m_Device->GetImage( m_BrdfLut ), &clearValue, vk::ImageLayout::eAttachmentOptimal );
@@ -188,19 +216,9 @@ namespace Boundless {
 		commandBuffer->draw( 3, 1, 0, 0 );
 
 		commandBuffer.EndRendering();
-		commandBuffer.ImageBarrier( 
-			m_Device->GetImage( brdfTex ),
-			vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
-			vk::AccessFlagBits::eShaderRead,
-			vk::ImageLayout::eUndefined,
-			vk::ImageLayout::eShaderReadOnlyOptimal,
-			vk::PipelineStageFlagBits::eColorAttachmentOutput,
-			vk::PipelineStageFlagBits::eFragmentShader,
-			vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers }
-		);
+		commandBuffer.Transition( m_Device->GetImage( brdfTex ), EImageAccess::FragmentShaderRead );
 
-		commandBuffer.End();
-		commandBuffer.Submit( m_Device->GetQueue() );
+		m_Device->GetCommandBuffers().SubmitOneShot( commandBuffer );
 
 		const vk::Device& device = m_Device->GetDevice();
 		device.destroyPipelineLayout( brdfLutGenPipelineLayout );
@@ -234,19 +252,20 @@ namespace Boundless {
 		const vk::Device& device = m_Device->GetDevice();
 
 		if ( m_ResizeRequested ) {
-			device.waitIdle();
-
 			OnResize();
 			
 			m_ResizeRequested = false;
 		}
 
 		FrameData& currentFrame = GetCurrentFrame();
+		CommandBufferManager& commandBuffers = m_Device->GetCommandBuffers();
 
-		while ( vk::Result::eTimeout == device.waitForFences( currentFrame.m_InFlightFence, vk::True, std::numeric_limits<uint64_t>::max() ) )
-			_mm_pause();
+		// Frame N waits for frame N - m_FramesInFlight, the slot's previous user, sleeping until the GPU got there.
+		commandBuffers.WaitTimeline( currentFrame.m_TimelineValue );
 
-		device.resetFences( currentFrame.m_InFlightFence );
+		// The queue runs frames in order, every frame before the slot's previous user is done as well.
+		uint64_t completedFrames = m_CurrentFrame >= m_FramesInFlight ? m_CurrentFrame - m_FramesInFlight + 1 : 0;
+		m_Device->BeginFrame( m_CurrentFrame, completedFrames );
 		
 		try {
 			const auto [ result, value ] = device.acquireNextImageKHR( m_Swapchain, std::numeric_limits<uint64_t>::max(), currentFrame.m_ImageAvailableSemaphore, VK_NULL_HANDLE );
@@ -256,10 +275,18 @@ namespace Boundless {
 			return;
 		}
 
+		// Comes out of this thread's pool for the frame, reset as a whole once the frame is done.
+		currentFrame.m_CommandBuffer = commandBuffers.GetFrameCommandBuffer();
+
 		CommandBuffer& commandBuffer = GetCommandBuffer();
-		commandBuffer->reset();
-		
 		commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+
+		// Streamed texture levels go out first, this frame already waits on them and can sample the new views.
+		m_Scene.RequestTextureResolutions( m_Scene.GetMainCamera(), float( m_SwapchainExtents.height ) );
+		m_TextureLoader->Update();
+
+		// Async uploads finished (or in flight) on the transfer queue, the submit waits on their timeline value.
+		uint64_t transferWaitValue = m_Device->AcquireTransfers( commandBuffer );
 		{
 			commandBuffer.BindDefaults( *m_Device );
 
@@ -276,15 +303,79 @@ namespace Boundless {
 			m_FrameConstants.m_CameraPosition = camera.GetInvViewMatrix()[ 3 ];
 			m_FrameConstants.m_SunColor = { 1.f, 1.f, 1.f, 1.f };
 			m_FrameConstants.m_SunDirection = glm::normalize( glm::vec4{ 0.25f, -0.9f, 0.f, 1.f } );
-			m_FrameConstants.m_IblTextures = { m_DiffuseIbl, m_SpecularIbl, m_BrdfLut, 0 };
+			m_FrameConstants.m_IblTextures = { int( m_Device->GetImageBindlessIndex( m_DiffuseIbl ) ), int( m_Device->GetImageBindlessIndex( m_SpecularIbl ) ), int( m_Device->GetImageBindlessIndex( m_BrdfLut ) ), 0 };
 
-			Buffer& frameConstantsBuffer = m_Device->GetBuffer( m_FrameConstantsBuffer );
-			frameConstantsBuffer.Patch( &m_FrameConstants, sizeof( m_FrameConstants ) );
+			Frustum frustum = Frustum::FromMatrix( camera.GetViewProjectionMatrix() );
+			std::copy( frustum.m_Planes.begin(), frustum.m_Planes.end(), m_FrameConstants.m_FrustumPlanes );
+
+			// Copied on the GPU timeline, the copy waits for the frames in flight still reading the buffer.
+			commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eUniformRead, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite );
+			m_Device->UploadBuffer( commandBuffer, m_Device->GetBuffer( m_FrameConstantsBuffer ), &m_FrameConstants, sizeof( m_FrameConstants ) );
+			commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eUniformRead );
+
+			m_TextureLoader->RecordFrame( commandBuffer );
 
 			m_Skinning->Dispatch(commandBuffer, *m_Device, m_Scene );
 
-			// GBuffer.
-			GBufferOutput gbufferOutput = m_GBuffer->Render( commandBuffer, *m_Device, m_FrameConstantsBuffer, m_Scene );
+			m_Scene.UpdateInstances( *m_Device, commandBuffer );
+
+			// Render targets live in the frame graph, passes only declare what they use. Barriers between them are derived
+			// from that, unused passes are culled.
+			RenderGraph& graph = *m_RenderGraph;
+			graph.Reset();
+
+			const RenderGraphResource gbuffer = graph.CreateImage( "GBuffer", m_GBuffer->GetRenderTargetDesc() );
+			const RenderGraphResource depth = graph.CreateImage( "Depth", m_GBuffer->GetDepthTargetDesc() );
+			const RenderGraphResource lighting = graph.CreateImage( "Lighting", m_Lighting->GetRenderTargetDesc() );
+			const RenderGraphResource composite = graph.CreateImage( "Composite", m_Composite->GetRenderTargetDesc() );
+			const RenderGraphResource gbufferDebug = graph.CreateImage( "GBuffer Debug", m_GBufferDebug->GetRenderTargetDesc() );
+
+			// Views only exist once the graph is compiled, i.e. inside the passes.
+			auto gbufferTargets = [ &graph, gbuffer, depth ]() { return GBufferOutput{ graph.GetView( gbuffer ), graph.GetView( depth ) }; };
+
+			// Culling & GBuffer. Culling only writes buffers, those passes are kept for their side effects.
+			GPUCullOutput earlyOutput = {};
+			GPUCullOutput lateOutput = {};
+			HiZOutput hiZOutput = {};
+
+			if ( m_GPUCulling && m_OcclusionCulling ) {
+				// Draw what was visible last frame, build the Hi-Z from that depth and draw whatever else passes against it.
+				graph.AddPass( "Early Cull" ).SideEffects().Execute( [ & ]( CommandBuffer& cmd ) {
+					earlyOutput = m_GPUCull->Dispatch( cmd, *m_Device, m_FrameConstantsBuffer, m_Scene, ECullPhase::Early );
+				} );
+
+				graph.AddPass( "Early GBuffer" ).Write( gbuffer, EImageAccess::ColorAttachment ).Write( depth, EImageAccess::DepthAttachment ).Execute( [ & ]( CommandBuffer& cmd ) {
+					m_GBuffer->RenderIndirect( cmd, *m_Device, gbufferTargets(), m_FrameConstantsBuffer, m_Scene, earlyOutput );
+				} );
+
+				graph.AddPass( "HiZ" ).Read( depth, EImageAccess::ComputeShaderRead ).SideEffects().Execute( [ & ]( CommandBuffer& cmd ) {
+					hiZOutput = m_HiZ->Dispatch( cmd, *m_Device, graph.GetView( depth ) );
+				} );
+
+				graph.AddPass( "Late Cull" ).SideEffects().Execute( [ & ]( CommandBuffer& cmd ) {
+					lateOutput = m_GPUCull->Dispatch( cmd, *m_Device, m_FrameConstantsBuffer, m_Scene, ECullPhase::Late, hiZOutput );
+				} );
+
+				graph.AddPass( "Late GBuffer" ).Modify( gbuffer, EImageAccess::ColorAttachment ).Modify( depth, EImageAccess::DepthAttachment ).Execute( [ & ]( CommandBuffer& cmd ) {
+					m_GBuffer->RenderIndirect( cmd, *m_Device, gbufferTargets(), m_FrameConstantsBuffer, m_Scene, lateOutput, false );
+				} );
+			} else if ( m_GPUCulling ) {
+				graph.AddPass( "Cull" ).SideEffects().Execute( [ & ]( CommandBuffer& cmd ) {
+					earlyOutput = m_GPUCull->Dispatch( cmd, *m_Device, m_FrameConstantsBuffer, m_Scene, ECullPhase::FrustumOnly );
+				} );
+
+				graph.AddPass( "GBuffer" ).Write( gbuffer, EImageAccess::ColorAttachment ).Write( depth, EImageAccess::DepthAttachment ).Execute( [ & ]( CommandBuffer& cmd ) {
+					m_GBuffer->RenderIndirect( cmd, *m_Device, gbufferTargets(), m_FrameConstantsBuffer, m_Scene, earlyOutput );
+				} );
+			} else {
+				const std::vector<entt::entity>* visibleEntities = &m_FrustumCull->Dispatch( m_Scene, camera );
+				if ( m_SoftwareOcclusionCulling )
+					visibleEntities = &m_SoftwareOcclusion->Dispatch( m_Scene, camera, *visibleEntities, m_ThreadPool );
+
+				graph.AddPass( "GBuffer" ).Write( gbuffer, EImageAccess::ColorAttachment ).Write( depth, EImageAccess::DepthAttachment ).Execute( [ & ]( CommandBuffer& cmd ) {
+					m_GBuffer->Render( cmd, *m_Device, gbufferTargets(), m_FrameConstantsBuffer, m_Scene, *visibleEntities, m_ThreadPool );
+				} );
+			}
 
 			// RT Shadows.
 			{
@@ -302,9 +393,13 @@ namespace Boundless {
 			}
 			
 			// Lighting.
-			{
-				m_Lighting->Render( commandBuffer, *m_Device, m_FrameConstantsBuffer, m_Scene, gbufferOutput );
-			}
+			graph.AddPass( "Lighting" )
+				.Read( gbuffer, EImageAccess::FragmentShaderRead )
+				.Read( depth, EImageAccess::FragmentShaderRead )
+				.Write( lighting, EImageAccess::ColorAttachment )
+				.Execute( [ & ]( CommandBuffer& cmd ) {
+					m_Lighting->Render( cmd, *m_Device, graph.GetView( lighting ), m_FrameConstantsBuffer, m_Scene, gbufferTargets() );
+				} );
 
 			// Bloom.
 			{
@@ -312,43 +407,56 @@ namespace Boundless {
 			}
 
 			// Post Processing.
-			{
-				m_Composite->Render(commandBuffer, *m_Device, m_Lighting->GetRenderTargetView() );
-			}
+			graph.AddPass( "Composite" ).Read( lighting, EImageAccess::FragmentShaderRead ).Write( composite, EImageAccess::ColorAttachment ).Execute( [ & ]( CommandBuffer& cmd ) {
+				m_Composite->Render( cmd, *m_Device, graph.GetView( composite ), graph.GetView( lighting ) );
+			} );
 
 			bool debugGBuffer = false;
+			uint32_t gbufferChannel = 1; // 0 - abledo, 1 - normal, 2 - metallic, 3 - roughness, 4 - albedo
 
-			// GBuffer Debug.
-			if( debugGBuffer )
-			{
-				uint32_t gbufferChannel = 1; // 0 - abledo, 1 - normal, 2 - metallic, 3 - roughness, 4 - albedo
-				m_GBufferDebug->Render( commandBuffer, *m_Device, m_GBuffer->GetRenderTargetView(), m_GBuffer->GetDepthBufferView(), gbufferChannel );
-			}
+			// GBuffer Debug, culled unless it is what gets displayed (lighting & composite are culled when it is).
+			graph.AddPass( "GBuffer Debug" )
+				.Read( gbuffer, EImageAccess::FragmentShaderRead )
+				.Read( depth, EImageAccess::FragmentShaderRead )
+				.Write( gbufferDebug, EImageAccess::ColorAttachment )
+				.Execute( [ & ]( CommandBuffer& cmd ) {
+					m_GBufferDebug->Render( cmd, *m_Device, graph.GetView( gbufferDebug ), graph.GetView( gbuffer ), graph.GetView( depth ), gbufferChannel );
+				} );
 
 			// Final Pass.
-			{
-				ImageHandle outputTexture = m_Composite->GetRenderTargetView();
-				if ( debugGBuffer )
-					outputTexture = m_GBufferDebug->GetRenderTargetView();
+			const RenderGraphResource outputTexture = debugGBuffer ? gbufferDebug : composite;
+			graph.AddPass( "Final" ).Read( outputTexture, EImageAccess::FragmentShaderRead ).SideEffects().Execute( [ & ]( CommandBuffer& cmd ) {
+				RenderFinalPass( cmd, graph.GetView( outputTexture ) );
+			} );
 
-				RenderFinalPass(commandBuffer, outputTexture);	
-			}
+			graph.Compile();
+			graph.Execute( commandBuffer );
 		}
 
 		commandBuffer.End();
 
 		// Present.
+		currentFrame.m_TimelineValue = commandBuffers.ReserveTimelineValue();
+
 		vk::CommandBufferSubmitInfo cmdInfo = vk::CommandBufferSubmitInfo( commandBuffer );
-		vk::SemaphoreSubmitInfo waitInfo    = vk::SemaphoreSubmitInfo( currentFrame.m_ImageAvailableSemaphore, 1, vk::PipelineStageFlagBits2::eColorAttachmentOutput, 0 );
-		vk::SemaphoreSubmitInfo signalInfo  = vk::SemaphoreSubmitInfo( m_SwapchainRenderFinishedSemaphores[ m_CurrentImageIndex ], 1, vk::PipelineStageFlagBits2::eAllGraphics, 0 );
+		std::array<vk::SemaphoreSubmitInfo, 2> signalInfos = {
+			vk::SemaphoreSubmitInfo( m_SwapchainRenderFinishedSemaphores[ m_CurrentImageIndex ], 1, vk::PipelineStageFlagBits2::eAllGraphics, 0 ),
+			vk::SemaphoreSubmitInfo( commandBuffers.GetTimeline(), currentFrame.m_TimelineValue, vk::PipelineStageFlagBits2::eAllCommands, 0 )
+		};
+
+		std::array<vk::SemaphoreSubmitInfo, 2> waitInfos = {
+			vk::SemaphoreSubmitInfo( currentFrame.m_ImageAvailableSemaphore, 1, vk::PipelineStageFlagBits2::eColorAttachmentOutput, 0 ),
+			vk::SemaphoreSubmitInfo( m_Device->GetTransferTimeline(), transferWaitValue, vk::PipelineStageFlagBits2::eAllCommands, 0 )
+		};
 
 		vk::SubmitInfo2 submitInfo =  {};
 		submitInfo.setCommandBufferInfos( cmdInfo )
-			.setWaitSemaphoreInfos( waitInfo )
-			.setSignalSemaphoreInfos( signalInfo );
+			.setWaitSemaphoreInfoCount( transferWaitValue > 0 ? 2 : 1 )
+			.setPWaitSemaphoreInfos( waitInfos.data() )
+			.setSignalSemaphoreInfos( signalInfos );
 
 		const vk::Queue& queue = m_Device->GetQueue();
-		queue.submit2( submitInfo, currentFrame.m_InFlightFence );
+		queue.submit2( submitInfo );
 
 		vk::PresentInfoKHR presentInfo = {};
 		presentInfo.setSwapchains( m_Swapchain )
@@ -363,7 +471,17 @@ namespace Boundless {
 			m_ResizeRequested = true;
 		}
 
-		m_CurrentFrame = ( m_CurrentFrame + 1 ) % MaxFramesInFlight;
+		m_CurrentFrame++;
+	}
+
+	void Engine::SetFramesInFlight( uint32_t framesInFlight ) {
+		framesInFlight = std::clamp( framesInFlight, 1u, MaxFramesInFlight );
+		if ( framesInFlight == m_FramesInFlight )
+			return;
+
+		// Frames map to other slots afterwards, nothing may be in flight on the old ones.
+		m_Device->GetDevice().waitIdle();
+		m_FramesInFlight = framesInFlight;
 	}
 
 	void Engine::OnResize() {
@@ -396,6 +514,11 @@ namespace Boundless {
 	void Engine::RenderFinalPass( CommandBuffer& commandBuffer, ImageHandle texture ) {
 		vk::Image currentImage = m_SwapchainImages[ m_CurrentImageIndex ];
 		vk::ImageView currentView = m_SwapchainImageViews[ m_CurrentImageIndex ];
+		vk::ImageSubresourceRange range = { vk::ImageAspectFlagBits::eColor, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers };
+
+		// Swapchain images aren't tracked, the contents are replaced every frame. The color output stage is the one the
+		// image available semaphore is waited on.
+		commandBuffer.ImageBarrier( currentImage, ImageState{ vk::ImageLayout::eUndefined, vk::PipelineStageFlagBits2::eColorAttachmentOutput }, ImageState::FromAccess( EImageAccess::ColorAttachment ), range );
 
 		vk::ClearValue clearValue = { { 0.1f, 0.1f, 0.1f, 1.f } };
 		vk::RenderingAttachmentInfo colorAttachment = vk_util::RenderPassGetColorAttachmentInfo( currentView, &clearValue, vk::ImageLayout::eAttachmentOptimal );
@@ -405,22 +528,13 @@ namespace Boundless {
 		commandBuffer.SetScissorAndViewport( float( m_SwapchainExtents.width ), float( m_SwapchainExtents.height ), 0.f, 0.f, 0.f, 1.f, false );
 		commandBuffer.BindPipeline( m_FullscreenPipeline );
 
-		BlitPushConstants pc = { uint32_t( texture ) };
+		BlitPushConstants pc = { m_Device->GetImageBindlessIndex( texture ) };
 		commandBuffer.BindPushConstants( *m_Device, &pc, sizeof( pc ) );
 		
 		commandBuffer->setCullMode( vk::CullModeFlagBits::eFront );
 		commandBuffer->draw(3, 1, 0, 0 );
 
 		commandBuffer.EndRendering();
-		commandBuffer.ImageBarrier(
-			currentImage,
-			vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
-			vk::AccessFlags{},
-			vk::ImageLayout::eUndefined,
-			vk::ImageLayout::ePresentSrcKHR,
-			vk::PipelineStageFlagBits::eColorAttachmentOutput,
-			vk::PipelineStageFlagBits::eBottomOfPipe, 
-			vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers }
-		);
+		commandBuffer.ImageBarrier( currentImage, ImageState::FromAccess( EImageAccess::ColorAttachment ), ImageState::FromAccess( EImageAccess::Present ), range );
 	}
 }
\ No newline at end of file
@@ -6,6 +6,9 @@
 #include "Scene.hpp"
 
 #include "RenderPasses.hpp"
+#include "RenderGraph.hpp"
+#include "ThreadPool.hpp"
+#include "TextureLoader.hpp"
 
 namespace Boundless {
 	// TODO: Shader classes for organization...
@@ -19,6 +22,8 @@ namespace Boundless {
 		IDxcBlob* FullscreenBlitPixelShader;
 		IDxcBlob* BrdfGenPixelShader;
 		IDxcBlob* SkinningShader;
+		IDxcBlob* CullShader;
+		IDxcBlob* HiZShader;
 	};
 
 	extern EngineShaders g_EngineShaders;
@@ -30,13 +35,13 @@ namespace Boundless {
 		glm::vec4  m_SunDirection;
 		glm::vec4  m_SunColor;
 		glm::ivec4 m_IblTextures;
+		glm::vec4  m_FrustumPlanes[ 6 ];
 	};
 
 	struct FrameData {
-		CommandBuffer   m_CommandBuffer;
-		vk::CommandPool m_CommandPool;
+		CommandBuffer   m_CommandBuffer; // From the device's CommandBufferManager, replaced every frame.
 		vk::Semaphore   m_ImageAvailableSemaphore;
-		vk::Fence	    m_InFlightFence;
+		uint64_t		m_TimelineValue = 0; // Graphics timeline value the slot's last frame signals.
 	};
 
 	class Engine {
@@ -48,9 +53,13 @@ namespace Boundless {
 
 		bool ShouldExit();
 
-		constexpr static const int MaxFramesInFlight = 2;
+		constexpr static const uint32_t MaxFramesInFlight = 3;
 
-		FrameData& GetCurrentFrame() { return m_FrameData[ m_CurrentFrame % MaxFramesInFlight ]; }
+		// Frames the CPU may record ahead of the GPU, 1 to MaxFramesInFlight. Changing it waits for the GPU to go idle.
+		void SetFramesInFlight( uint32_t framesInFlight );
+		uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+
+		FrameData& GetCurrentFrame() { return m_FrameData[ m_CurrentFrame % m_FramesInFlight ]; }
 		CommandBuffer& GetCommandBuffer() { return GetCurrentFrame().m_CommandBuffer; }
 	private:
 		void Update( float deltaTime );
@@ -74,23 +83,34 @@ namespace Boundless {
 		vk::Format									   m_SwapchainImageFormat;
 		vk::SwapchainKHR							   m_Swapchain;
 		std::array<FrameData, MaxFramesInFlight>	   m_FrameData;
+		uint32_t									   m_FramesInFlight = 2;
 		bool										   m_ResizeRequested = false;
 		uint32_t									   m_CurrentImageIndex = 0;
-		uint32_t									   m_CurrentFrame = 0;
+		uint64_t									   m_CurrentFrame = 0; // Monotonic, used to retire released resources.
 		
 		// Render passes.
 		std::unique_ptr<SkinningPass>				   m_Skinning;
+		std::unique_ptr<FrustumCullPass>			   m_FrustumCull;
+		std::unique_ptr<SoftwareOcclusionPass>		   m_SoftwareOcclusion;
+		std::unique_ptr<GPUCullPass>				   m_GPUCull;
+		std::unique_ptr<HiZPass>					   m_HiZ;
 		std::unique_ptr<GBufferPass>				   m_GBuffer;
 		std::unique_ptr<GBufferDebugPass>			   m_GBufferDebug;
 		std::unique_ptr<LightingPass>				   m_Lighting;
 		std::unique_ptr<CompositePass>				   m_Composite;
 		std::vector<BaseRenderPass*>				   m_RenderPasses;
+		std::unique_ptr<RenderGraph>				   m_RenderGraph; // Owns the passes' render targets.
 
 		Scene										   m_Scene; // This should maybe be moved somewhere else.
 		ShaderCompiler								   m_ShaderCompiler;
 		FrameConstants								   m_FrameConstants = {};
 		BufferHandle								   m_FrameConstantsBuffer = BufferHandle::Invalid;
 		vk::Pipeline								   m_FullscreenPipeline;
+		bool										   m_GPUCulling = true; // Falls back to CPU culling & per mesh draws when false.
+		bool										   m_OcclusionCulling = true; // Two phase Hi-Z occlusion culling, GPU culling only.
+		bool										   m_SoftwareOcclusionCulling = true; // CPU culling only.
+		ThreadPool									   m_ThreadPool;
+		std::unique_ptr<TextureLoader>				   m_TextureLoader; // Decodes on m_ThreadPool, declared after it.
 
 		// TODO: move/remove these.
 		void GenerateBrdfLut();
@@ -0,0 +1,71 @@
+#include "Pch.hpp"
+#include "FreeListAllocator.hpp"
+
+namespace Boundless {
+	FreeListAllocator::FreeListAllocator( uint64_t size ) : m_Size( size ) {
+		if ( size > 0 )
+			m_FreeBlocks.emplace( 0, size );
+	}
+
+	uint64_t FreeListAllocator::Allocate( uint64_t size, uint64_t alignment ) {
+		if ( size == 0 )
+			return InvalidOffset;
+
+		for ( auto it = m_FreeBlocks.begin(); it != m_FreeBlocks.end(); ++it ) {
+			const auto [ blockOffset, blockSize ] = *it;
+
+			uint64_t offset = ( blockOffset + alignment - 1 ) / alignment * alignment;
+			uint64_t padding = offset - blockOffset;
+			if ( padding + size > blockSize )
+				continue;
+
+			m_FreeBlocks.erase( it );
+
+			// Give the alignment padding and the tail back to the free list.
+			if ( padding > 0 )
+				m_FreeBlocks.emplace( blockOffset, padding );
+
+			if ( uint64_t tail = blockSize - padding - size; tail > 0 )
+				m_FreeBlocks.emplace( offset + size, tail );
+
+			m_UsedSize += size;
+			return offset;
+		}
+
+		return InvalidOffset;
+	}
+
+	void FreeListAllocator::Free( uint64_t offset, uint64_t size ) {
+		if ( offset == InvalidOffset || size == 0 )
+			return;
+
+		m_UsedSize -= std::min( m_UsedSize, size );
+
+		auto next = m_FreeBlocks.lower_bound( offset );
+
+		// Merge with the following block.
+		if ( next != m_FreeBlocks.end() && offset + size == next->first ) {
+			size += next->second;
+			next = m_FreeBlocks.erase( next );
+		}
+
+		// Merge with the preceding block.
+		if ( next != m_FreeBlocks.begin() ) {
+			auto prev = std::prev( next );
+			if ( prev->first + prev->second == offset ) {
+				prev->second += size;
+				return;
+			}
+		}
+
+		m_FreeBlocks.emplace_hint( next, offset, size );
+	}
+
+	uint64_t FreeListAllocator::GetLargestFreeBlock() const {
+		uint64_t largest = 0;
+		for ( const auto& [ offset, size ] : m_FreeBlocks )
+			largest = std::max( largest, size );
+
+		return largest;
+	}
+}
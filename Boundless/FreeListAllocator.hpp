@@ -0,0 +1,27 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	// Offset allocator over a fixed size range. Does no memory management itself, used to suballocate
+	// big GPU buffers. Free blocks are kept sorted by offset and merged with their neighbours on free.
+	class FreeListAllocator {
+	public:
+		constexpr static const uint64_t InvalidOffset = UINT64_MAX;
+
+		FreeListAllocator() = default;
+		explicit FreeListAllocator( uint64_t size );
+
+		// First fit, returns InvalidOffset when no free block is large enough.
+		uint64_t Allocate( uint64_t size, uint64_t alignment = 1 );
+		void Free( uint64_t offset, uint64_t size );
+
+		uint64_t GetSize() const { return m_Size; }
+		uint64_t GetUsedSize() const { return m_UsedSize; }
+		uint64_t GetLargestFreeBlock() const;
+		size_t GetFreeBlockCount() const { return m_FreeBlocks.size(); }
+	private:
+		std::map<uint64_t, uint64_t> m_FreeBlocks; // Offset -> size.
+		uint64_t					 m_Size = 0;
+		uint64_t					 m_UsedSize = 0;
+	};
+}
@@ -134,6 +134,7 @@ namespace Boundless {
 		}
 
 		mesh.PackVertexData();
+		mesh.ComputeBounds();
 	}
 
 	void GLTFImporter::LoadMaterials( const tinygltf::Model& model ) {
@@ -0,0 +1,111 @@
+#include "Pch.hpp"
+#include "GeometryPool.hpp"
+#include "Device.hpp"
+#include "UploadBatch.hpp"
+
+namespace Boundless {
+	void GeometryPool::Create( Device& device, const Desc& desc ) {
+		m_Desc = desc;
+
+		m_VertexBuffer = device.CreateBuffer(
+			Buffer::Desc{
+				.m_Size = vk::DeviceSize( desc.m_MaxVertices ) * desc.m_VertexStride,
+				.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Category = EMemoryCategory::Geometry,
+				.m_HostWrite = true
+			}
+		);
+
+		m_IndexBuffer = device.CreateBuffer(
+			Buffer::Desc{
+				.m_Size = vk::DeviceSize( desc.m_MaxIndices ) * sizeof( uint32_t ),
+				.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Category = EMemoryCategory::Geometry,
+				.m_HostWrite = true
+			}
+		);
+
+		// Without both buffers the pool stays uncreated and empty, every Allocate fails.
+		if ( m_VertexBuffer == BufferHandle::Invalid || m_IndexBuffer == BufferHandle::Invalid ) {
+			printf( "[GeometryPool] Failed to allocate the vertex/index buffers (%u vertices, %u indices)\n", desc.m_MaxVertices, desc.m_MaxIndices );
+
+			if ( m_VertexBuffer != BufferHandle::Invalid )
+				device.ReleaseBuffer( m_VertexBuffer );
+
+			if ( m_IndexBuffer != BufferHandle::Invalid )
+				device.ReleaseBuffer( m_IndexBuffer );
+
+			m_VertexBuffer = BufferHandle::Invalid;
+			m_IndexBuffer = BufferHandle::Invalid;
+			return;
+		}
+
+		m_VertexAllocator = FreeListAllocator( desc.m_MaxVertices );
+		m_IndexAllocator = FreeListAllocator( desc.m_MaxIndices );
+	}
+
+	GeometryAllocation GeometryPool::Allocate( uint32_t vertexCount, uint32_t indexCount ) {
+		GeometryAllocation allocation = {};
+		if ( vertexCount == 0 )
+			return allocation;
+
+		uint64_t vertexOffset = m_VertexAllocator.Allocate( vertexCount );
+		if ( vertexOffset == FreeListAllocator::InvalidOffset ) {
+			printf( "[GeometryPool] Out of vertex space (%u requested, %llu free)\n", vertexCount, m_VertexAllocator.GetSize() - m_VertexAllocator.GetUsedSize() );
+			return allocation;
+		}
+
+		uint64_t indexOffset = FreeListAllocator::InvalidOffset;
+		if ( indexCount > 0 ) {
+			indexOffset = m_IndexAllocator.Allocate( indexCount );
+			if ( indexOffset == FreeListAllocator::InvalidOffset ) {
+				printf( "[GeometryPool] Out of index space (%u requested, %llu free)\n", indexCount, m_IndexAllocator.GetSize() - m_IndexAllocator.GetUsedSize() );
+				m_VertexAllocator.Free( vertexOffset, vertexCount );
+				return allocation;
+			}
+		}
+
+		allocation.m_VertexOffset = uint32_t( vertexOffset );
+		allocation.m_VertexCount = vertexCount;
+		allocation.m_IndexOffset = indexCount > 0 ? uint32_t( indexOffset ) : GeometryAllocation::InvalidOffset;
+		allocation.m_IndexCount = indexCount;
+
+		return allocation;
+	}
+
+	void GeometryPool::Free( GeometryAllocation& allocation ) {
+		if ( !allocation.IsValid() )
+			return;
+
+		m_VertexAllocator.Free( allocation.m_VertexOffset, allocation.m_VertexCount );
+
+		if ( allocation.m_IndexCount > 0 )
+			m_IndexAllocator.Free( allocation.m_IndexOffset, allocation.m_IndexCount );
+
+		allocation = {};
+	}
+
+	void GeometryPool::Upload( Device& device, UploadBatch& batch, const GeometryAllocation& allocation, const void* vertices, const uint32_t* indices ) {
+		if ( !allocation.IsValid() )
+			return;
+
+		const vk::DeviceSize vertexSize = vk::DeviceSize( allocation.m_VertexCount ) * m_Desc.m_VertexStride;
+		const vk::DeviceSize indexSize = indices ? vk::DeviceSize( allocation.m_IndexCount ) * sizeof( uint32_t ) : 0;
+
+		if ( vertices )
+			batch.UploadBuffer( device.GetBuffer( m_VertexBuffer ), vertices, vertexSize, vk::DeviceSize( allocation.m_VertexOffset ) * m_Desc.m_VertexStride );
+
+		if ( indexSize > 0 )
+			batch.UploadBuffer( device.GetBuffer( m_IndexBuffer ), indices, indexSize, vk::DeviceSize( allocation.m_IndexOffset ) * sizeof( uint32_t ) );
+	}
+
+	vk::DeviceAddress GeometryPool::GetVertexAddress( Device& device, const GeometryAllocation& allocation ) const {
+		return device.GetBuffer( m_VertexBuffer ).GetDeviceAddress() + vk::DeviceSize( allocation.m_VertexOffset ) * m_Desc.m_VertexStride;
+	}
+
+	vk::DeviceAddress GeometryPool::GetIndexAddress( Device& device, const GeometryAllocation& allocation ) const {
+		return device.GetBuffer( m_IndexBuffer ).GetDeviceAddress() + vk::DeviceSize( allocation.m_IndexOffset ) * sizeof( uint32_t );
+	}
+}
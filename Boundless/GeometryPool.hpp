@@ -0,0 +1,54 @@
+#pragma once
+#include "Buffer.hpp"
+#include "FreeListAllocator.hpp"
+
+namespace Boundless {
+	class Device;
+	class UploadBatch;
+
+	// Element offsets of a mesh inside the geometry pool. Indices stay relative to the mesh's first vertex.
+	struct GeometryAllocation {
+		constexpr static const uint32_t InvalidOffset = UINT32_MAX;
+
+		uint32_t m_VertexOffset = InvalidOffset;
+		uint32_t m_VertexCount = 0;
+		uint32_t m_IndexOffset = InvalidOffset;
+		uint32_t m_IndexCount = 0;
+
+		bool IsValid() const { return m_VertexOffset != InvalidOffset; }
+	};
+
+	// One vertex buffer and one index buffer shared by every mesh in the scene, suballocated through free lists.
+	// Draws only differ in their offsets, so the index buffer is bound once per pass.
+	class GeometryPool {
+	public:
+		struct Desc {
+			uint32_t m_VertexStride;
+			uint32_t m_MaxVertices = 1u << 21;
+			uint32_t m_MaxIndices  = 1u << 23;
+		};
+
+		void Create( Device& device, const Desc& desc );
+		bool IsCreated() const { return m_VertexBuffer != BufferHandle::Invalid; }
+
+		// indexCount can be zero for vertex only allocations (e.g. skinning output).
+		GeometryAllocation Allocate( uint32_t vertexCount, uint32_t indexCount );
+		void Free( GeometryAllocation& allocation );
+
+		// Records the copies into the batch, nothing is submitted here.
+		void Upload( Device& device, UploadBatch& batch, const GeometryAllocation& allocation, const void* vertices, const uint32_t* indices );
+
+		BufferHandle GetVertexBuffer() const { return m_VertexBuffer; }
+		BufferHandle GetIndexBuffer() const { return m_IndexBuffer; }
+		uint32_t GetVertexStride() const { return m_Desc.m_VertexStride; }
+
+		vk::DeviceAddress GetVertexAddress( Device& device, const GeometryAllocation& allocation ) const;
+		vk::DeviceAddress GetIndexAddress( Device& device, const GeometryAllocation& allocation ) const;
+	private:
+		Desc			  m_Desc{};
+		BufferHandle	  m_VertexBuffer = BufferHandle::Invalid;
+		BufferHandle	  m_IndexBuffer = BufferHandle::Invalid;
+		FreeListAllocator m_VertexAllocator;
+		FreeListAllocator m_IndexAllocator;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "VkUtil.hpp"
+#include "BindlessSlots.hpp"
 
 namespace Boundless {
 	struct SamplerDesc {
@@ -10,8 +11,34 @@ namespace Boundless {
 		bool m_Anisotropic = true;
 	};
 
+	// How a pass is about to use an image, maps to the layout, stages and accesses of the barrier CommandBuffer::Transition
+	// records.
+	enum class EImageAccess {
+		Undefined,
+		ColorAttachment,
+		DepthAttachment,
+		FragmentShaderRead,
+		ComputeShaderRead,
+		ShaderRead,			// Fragment and compute.
+		ComputeShaderWrite, // Storage image, General layout.
+		TransferSrc,
+		TransferDst,
+		Present
+	};
+
+	// Last known state of a subresource: its layout and the stages/accesses which touched it since the last barrier.
+	struct ImageState {
+		vk::ImageLayout			m_Layout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags2 m_Stages = vk::PipelineStageFlagBits2::eNone;
+		vk::AccessFlags2		m_Access = vk::AccessFlagBits2::eNone;
+
+		static ImageState FromAccess( EImageAccess access );
+		bool operator==( const ImageState& other ) const = default;
+	};
+
 	class Image {
 		friend class Device;
+		friend class CommandBuffer;
 	public:
 		struct Desc {
 			vk::ImageType			m_Type = vk::ImageType::e2D;
@@ -23,11 +50,12 @@ namespace Boundless {
 			vk::ImageTiling			m_Tiling = vk::ImageTiling::eOptimal; // I have never not used optimal...
 			vk::SampleCountFlagBits m_Samples = vk::SampleCountFlagBits::e1;
 			vk::ImageUsageFlags     m_Usage;
-			vk::ImageLayout			__Layout = vk::ImageLayout::eUndefined; 
+			vk::ComponentMapping	m_Swizzle = {}; // Only used by views, not part of the image's identity.
+			vk::ImageCreateFlags	m_Flags = {};	// eCubeCompatible with 6 layers gets cube views.
 
 			bool operator==( const Desc& other ) const {
-				return std::tie( m_Type, m_Width, m_Height, m_Levels, m_Layers, m_Format, m_Tiling, m_Samples, m_Usage ) ==
-					std::tie( other.m_Type, other.m_Width, other.m_Height, other.m_Levels, other.m_Layers, other.m_Format, other.m_Tiling, other.m_Samples, other.m_Usage );
+				return std::tie( m_Type, m_Width, m_Height, m_Levels, m_Layers, m_Format, m_Tiling, m_Samples, m_Usage, m_Flags ) ==
+					std::tie( other.m_Type, other.m_Width, other.m_Height, other.m_Levels, other.m_Layers, other.m_Format, other.m_Tiling, other.m_Samples, other.m_Usage, other.m_Flags );
 			}
 		};
 
@@ -38,9 +66,15 @@ namespace Boundless {
 		operator vk::ImageView& ( ) { return m_ImageView; }
 		operator const vk::ImageView& ( ) const { return m_ImageView; }
 
+		const Image::Desc& GetDesc() const { return m_Desc; }
 		vk::Format GetFormat() const { return m_Desc.m_Format; }
 		vk::ImageUsageFlags GetUsage() const { return m_Desc.m_Usage; }
-		vk::ImageLayout GetLayout() const { return m_Desc.__Layout; }
+		vk::ImageLayout GetLayout( uint32_t level = 0, uint32_t layer = 0 ) const { return GetState( level, layer ).m_Layout; }
+		// Tracked per level and layer by CommandBuffer::Transition in recording order. Only images have a state, not views,
+		// uploads and host copies aren't tracked (sampled only textures are never transitioned through the tracker).
+		const ImageState& GetState( uint32_t level = 0, uint32_t layer = 0 ) const { return m_States[ layer * m_Desc.m_Levels + level ]; }
+		// Forgets the tracked state, e.g. for targets whose contents were transitioned by something else.
+		void ResetState( const ImageState& state = {} ) { std::fill( m_States.begin(), m_States.end(), state ); }
 
 		uint32_t GetLayers() const { return m_Desc.m_Layers; }
 		uint32_t GetLevels() const { return m_Desc.m_Levels; }
@@ -56,7 +90,10 @@ namespace Boundless {
 			vk::ImageView m_ImageView;
 		};
 
-		VmaAllocation m_Allocation{};
-		Image::Desc   m_Desc{};
+		VmaAllocation			m_Allocation{};
+		Image::Desc				m_Desc{};
+		std::vector<ImageState> m_States; // Layer major, one per level.
+		bool					m_Aliased = false; // Bound to memory owned by someone else, see Device::CreateAliasedImage.
+		uint32_t				m_BindlessSlot = BindlessSlots::Invalid; // Sampled views only.
 	};
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "Pch.hpp"
+#include "MemoryTracker.hpp"
+
+namespace Boundless {
+	static double ToMegabytes( uint64_t bytes ) {
+		return double( bytes ) / ( 1024.0 * 1024.0 );
+	}
+
+	const char* MemoryTracker::GetCategoryName( EMemoryCategory category ) {
+		switch ( category ) {
+		case EMemoryCategory::Buffers:				  return "Buffers";
+		case EMemoryCategory::Geometry:				  return "Geometry";
+		case EMemoryCategory::Textures:				  return "Textures";
+		case EMemoryCategory::RenderTargets:		  return "RenderTargets";
+		case EMemoryCategory::AccelerationStructures: return "AccelerationStructures";
+		case EMemoryCategory::Staging:				  return "Staging";
+		default:									  return "Unknown";
+		}
+	}
+
+	void MemoryTracker::Create( VmaAllocator allocator, bool hasBudgetExtension ) {
+		m_Allocator = allocator;
+		m_HasBudgetExtension = hasBudgetExtension;
+
+		const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+		vmaGetMemoryProperties( m_Allocator, &memoryProperties );
+
+		m_Heaps.resize( memoryProperties->memoryHeapCount );
+		for ( uint32_t i = 0; i < memoryProperties->memoryHeapCount; i++ )
+			m_Heaps[ i ].m_DeviceLocal = ( memoryProperties->memoryHeaps[ i ].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT ) != 0;
+
+		if ( !m_HasBudgetExtension )
+			printf( "[Memory] VK_EXT_memory_budget is not supported, budgets are estimated from heap sizes\n" );
+
+		Update();
+	}
+
+	void MemoryTracker::Add( EMemoryCategory category, uint64_t size ) {
+		Counter& counter = m_Counters[ size_t( category ) ];
+
+		const uint64_t bytes = counter.m_Bytes.fetch_add( size ) + size;
+		counter.m_Allocations++;
+
+		uint64_t peak = counter.m_PeakBytes.load();
+		while ( bytes > peak && !counter.m_PeakBytes.compare_exchange_weak( peak, bytes ) ) { }
+	}
+
+	void MemoryTracker::Remove( EMemoryCategory category, uint64_t size ) {
+		Counter& counter = m_Counters[ size_t( category ) ];
+
+		counter.m_Bytes -= size;
+		counter.m_Allocations--;
+	}
+
+	MemoryTracker::CategoryStats MemoryTracker::GetStats( EMemoryCategory category ) const {
+		const Counter& counter = m_Counters[ size_t( category ) ];
+		return CategoryStats{ counter.m_Bytes.load(), counter.m_PeakBytes.load(), counter.m_Allocations.load() };
+	}
+
+	void MemoryTracker::Update() {
+		if ( m_Allocator == VK_NULL_HANDLE )
+			return;
+
+		std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets = {};
+		vmaGetHeapBudgets( m_Allocator, budgets.data() );
+
+		bool nearBudget = false, recovered = true;
+		for ( size_t i = 0; i < m_Heaps.size(); i++ ) {
+			HeapStats& heap = m_Heaps[ i ];
+			heap.m_Usage = budgets[ i ].usage;
+			heap.m_Budget = budgets[ i ].budget;
+			heap.m_PeakUsage = std::max( heap.m_PeakUsage, heap.m_Usage );
+
+			if ( !heap.m_DeviceLocal || heap.m_Budget == 0 )
+				continue;
+
+			const double fraction = double( heap.m_Usage ) / double( heap.m_Budget );
+			nearBudget |= fraction >= WarningThreshold;
+			recovered &= fraction < RecoveryThreshold;
+		}
+
+		if ( nearBudget && !m_NearBudget ) {
+			printf( "[Memory] Device local memory is over %d%% of its budget\n", int( WarningThreshold * 100.f ) );
+			Dump();
+			m_NearBudget = true;
+		} else if ( m_NearBudget && recovered ) {
+			printf( "[Memory] Device local memory is back under %d%% of its budget\n", int( RecoveryThreshold * 100.f ) );
+			m_NearBudget = false;
+		}
+	}
+
+	void MemoryTracker::Dump() const {
+		printf( "[Memory] %-24s %12s %12s %8s\n", "Category", "Live (MB)", "Peak (MB)", "Count" );
+
+		uint64_t totalBytes = 0;
+		for ( uint32_t i = 0; i < uint32_t( EMemoryCategory::Count ); i++ ) {
+			const CategoryStats stats = GetStats( EMemoryCategory( i ) );
+			totalBytes += stats.m_Bytes;
+
+			printf( "[Memory] %-24s %12.2f %12.2f %8llu\n", GetCategoryName( EMemoryCategory( i ) ), ToMegabytes( stats.m_Bytes ), ToMegabytes( stats.m_PeakBytes ), stats.m_Allocations );
+		}
+
+		printf( "[Memory] %-24s %12.2f\n", "Total", ToMegabytes( totalBytes ) );
+
+		for ( size_t i = 0; i < m_Heaps.size(); i++ ) {
+			const HeapStats& heap = m_Heaps[ i ];
+			printf( "[Memory] Heap %zu (%s): %.2f / %.2f MB%s, peak %.2f MB\n", i, heap.m_DeviceLocal ? "device local" : "host",
+				ToMegabytes( heap.m_Usage ), ToMegabytes( heap.m_Budget ), m_HasBudgetExtension ? "" : " (estimated)", ToMegabytes( heap.m_PeakUsage ) );
+		}
+	}
+}
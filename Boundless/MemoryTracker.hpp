@@ -0,0 +1,68 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	// What an allocation is for, only used for reporting.
+	enum class EMemoryCategory : uint32_t {
+		Buffers,				// Anything not covered below (constants, culling output, readback).
+		Geometry,				// Vertex/index pools and skinning inputs.
+		Textures,				// Sampled images.
+		RenderTargets,			// Attachments, storage images and GPU written pyramids.
+		AccelerationStructures, // BLAS/TLAS storage, instances and build scratch.
+		Staging,				// Upload ring and staging buffers.
+		Count
+	};
+
+	// Per category accounting of live device allocations, on top of the per heap budgets VMA reports
+	// (VK_EXT_memory_budget when the device has it, heap sizes otherwise). Counters are atomic, any thread may
+	// create or release resources. Heap budgets are refreshed once a frame by Update.
+	class MemoryTracker {
+	public:
+		// Fraction of a device local heap's budget past which Update warns, it warns again once usage fell below
+		// the recovery threshold and crossed the warning one a second time.
+		constexpr static const float WarningThreshold = 0.9f;
+		constexpr static const float RecoveryThreshold = 0.85f;
+
+		struct CategoryStats {
+			uint64_t m_Bytes = 0;
+			uint64_t m_PeakBytes = 0;
+			uint64_t m_Allocations = 0;
+		};
+
+		struct HeapStats {
+			uint64_t m_Usage = 0;
+			uint64_t m_Budget = 0;
+			uint64_t m_PeakUsage = 0;
+			bool	 m_DeviceLocal = false;
+		};
+
+		void Create( VmaAllocator allocator, bool hasBudgetExtension );
+
+		void Add( EMemoryCategory category, uint64_t size );
+		void Remove( EMemoryCategory category, uint64_t size );
+
+		void Update();
+
+		CategoryStats GetStats( EMemoryCategory category ) const;
+		const std::vector<HeapStats>& GetHeaps() const { return m_Heaps; }
+		// True while a device local heap is past WarningThreshold, callers can hold back optional allocations.
+		bool IsNearBudget() const { return m_NearBudget; }
+
+		// Prints live bytes, peaks and allocation counts per category followed by the heap budgets.
+		void Dump() const;
+
+		static const char* GetCategoryName( EMemoryCategory category );
+	private:
+		struct Counter {
+			std::atomic<uint64_t> m_Bytes = 0;
+			std::atomic<uint64_t> m_PeakBytes = 0;
+			std::atomic<uint64_t> m_Allocations = 0;
+		};
+
+		VmaAllocator											m_Allocator = VK_NULL_HANDLE;
+		bool													m_HasBudgetExtension = false;
+		std::array<Counter, size_t( EMemoryCategory::Count )>	m_Counters;
+		std::vector<HeapStats>									m_Heaps;
+		bool													m_NearBudget = false;
+	};
+}
@@ -31,6 +31,53 @@ namespace Boundless {
 		}
 	}
 
+	void Mesh::ComputeBounds() {
+		m_LocalBounds = {};
+
+		for ( const glm::vec3& position : m_Positions ) {
+			m_LocalBounds.m_Min = glm::min( m_LocalBounds.m_Min, position );
+			m_LocalBounds.m_Max = glm::max( m_LocalBounds.m_Max, position );
+		}
+
+		if ( !m_LocalBounds.IsValid() )
+			return;
+
+		// Sphere around the box center, tight enough for culling and cheap to build.
+		glm::vec3 center = m_LocalBounds.GetCenter();
+		float radiusSq = 0.f;
+		for ( const glm::vec3& position : m_Positions ) {
+			glm::vec3 delta = position - center;
+			radiusSq = std::max( radiusSq, glm::dot( delta, delta ) );
+		}
+
+		m_LocalBounds.m_Sphere = glm::vec4( center, std::sqrt( radiusSq ) );
+		m_WorldBounds = m_LocalBounds;
+	}
+
+	Bounds Bounds::Transform( const glm::mat4& transform ) const {
+		if ( !IsValid() )
+			return *this;
+
+		// Arvo - transform the center and re-project the extents onto the new axes.
+		glm::vec3 center = glm::vec3( transform * glm::vec4( GetCenter(), 1.f ) );
+		glm::vec3 extents = GetExtents();
+		glm::vec3 newExtents = 
+			glm::abs( glm::vec3( transform[ 0 ] ) ) * extents.x + 
+			glm::abs( glm::vec3( transform[ 1 ] ) ) * extents.y + 
+			glm::abs( glm::vec3( transform[ 2 ] ) ) * extents.z;
+
+		float maxScale = std::sqrt( std::max( { 
+			glm::dot( glm::vec3( transform[ 0 ] ), glm::vec3( transform[ 0 ] ) ),
+			glm::dot( glm::vec3( transform[ 1 ] ), glm::vec3( transform[ 1 ] ) ),
+			glm::dot( glm::vec3( transform[ 2 ] ), glm::vec3( transform[ 2 ] ) ) } ) );
+
+		Bounds result = {};
+		result.m_Min = center - newExtents;
+		result.m_Max = center + newExtents;
+		result.m_Sphere = glm::vec4( glm::vec3( transform * glm::vec4( glm::vec3( m_Sphere ), 1.f ) ), m_Sphere.w * maxScale );
+		return result;
+	}
+
 	void KeyFrame::LoadChannel( const AnimationChannel& channel ) { 
 		if ( channel.m_Type == EChannelType::Translation )
 			m_Translation = channel;
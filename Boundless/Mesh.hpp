@@ -2,6 +2,7 @@
 #include "VkUtil.hpp"
 #include "Image.hpp"
 #include "Buffer.hpp"
+#include "GeometryPool.hpp"
 
 namespace Boundless {
 	struct alignas( 16 ) MeshVertexData {
@@ -12,8 +13,21 @@ namespace Boundless {
 		glm::vec4 m_Tangent{};
 	};
 
+	struct Bounds {
+		glm::vec3 m_Min = glm::vec3( FLT_MAX );
+		glm::vec3 m_Max = glm::vec3( -FLT_MAX );
+		glm::vec4 m_Sphere{}; // xyz - center, w - radius.
+
+		glm::vec3 GetCenter() const { return ( m_Min + m_Max ) * 0.5f; }
+		glm::vec3 GetExtents() const { return ( m_Max - m_Min ) * 0.5f; }
+		bool IsValid() const { return m_Min.x <= m_Max.x; }
+
+		Bounds Transform( const glm::mat4& transform ) const;
+	};
+
 	struct Mesh {
 		void PackVertexData();
+		void ComputeBounds();
 	
 		std::string					 m_Name;
 		std::vector<glm::vec3>		 m_Positions;
@@ -22,10 +36,12 @@ namespace Boundless {
 		std::vector<glm::vec4>		 m_Tangents;
 		std::vector<uint32_t>		 m_Indices;
 		std::vector<MeshVertexData>  m_Vertices;
+		Bounds						 m_LocalBounds;
+		Bounds						 m_WorldBounds;
 
 		uint32_t					 m_Material = 0; // TODO: Fix.
-		BufferHandle				 m_IndexBuffer = BufferHandle::Invalid;
-		BufferHandle				 m_VertexBuffer = BufferHandle::Invalid;
+		GeometryAllocation			 m_Geometry;		  // Offsets into the scene geometry pool.
+		uint32_t					 m_InstanceIndex = 0; // Index into the scene instance buffer.
 		
 		// RT Data.
 		BufferHandle				 m_BlasBuffer = BufferHandle::Invalid;
@@ -36,8 +52,8 @@ namespace Boundless {
 		std::vector<glm::uvec4>		 m_BoneIndices;
 		BufferHandle				 m_BoneIndexBuffer = BufferHandle::Invalid;
 		BufferHandle				 m_BoneWeightBuffer = BufferHandle::Invalid;
-		BufferHandle				 m_SkinnedVertexBuffer = BufferHandle::Invalid;
-		entt::entity				 m_Skeleton;
+		GeometryAllocation			 m_SkinnedGeometry;	  // Skinning output, vertices only.
+		entt::entity				 m_Skeleton = entt::null;
 	};
 
 	enum class EAlphaMode : int32_t {
@@ -150,6 +166,7 @@ namespace Boundless {
 
 	class Animation {
 		friend struct Skeleton;
+		friend class SceneSerializer;
 	public:
 		Animation() = default;
 		Animation( const tinygltf::Model& gltfModel, const tinygltf::Animation& gltfAnimation );
@@ -174,7 +191,7 @@ namespace Boundless {
 
 	struct Skeleton {
 		Bone					m_RootBone;
-		entt::entity			m_Animation;
+		entt::entity			m_Animation = entt::null;
 		std::vector<glm::mat4>  m_InverseBindMatrices;
 		std::vector<glm::mat4>  m_BoneWSTransformMatrices;
 		std::vector<glm::mat4>  m_BoneTransformMatrices;
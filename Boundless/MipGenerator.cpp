@@ -0,0 +1,227 @@
+#include "Pch.hpp"
+#include "MipGenerator.hpp"
+
+#include <immintrin.h>
+
+namespace Boundless {
+	constexpr static const float	KaiserRadius = 3.f; // In destination texels.
+	constexpr static const float	KaiserAlpha = 4.f;
+	constexpr static const uint32_t LinearToSRGBTableSize = 16384;
+
+	struct FilterTap {
+		uint32_t m_Index;
+		float	 m_Weight;
+	};
+
+	// Taps of every destination texel along one axis, texel i uses m_Taps[ m_First[ i ] ] up to m_Taps[ m_First[ i + 1 ] ].
+	struct FilterKernel {
+		std::vector<uint32_t>  m_First;
+		std::vector<FilterTap> m_Taps;
+	};
+
+	static float SRGBToLinear( float value ) {
+		return value <= 0.04045f ? value / 12.92f : std::pow( ( value + 0.055f ) / 1.055f, 2.4f );
+	}
+
+	static float LinearToSRGB( float value ) {
+		return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow( value, 1.f / 2.4f ) - 0.055f;
+	}
+
+	static uint8_t ToUnorm8( float value ) {
+		return uint8_t( std::clamp( value, 0.f, 1.f ) * 255.f + 0.5f );
+	}
+
+	static const std::array<uint8_t, LinearToSRGBTableSize>& GetLinearToSRGBTable() {
+		static const std::array<uint8_t, LinearToSRGBTableSize> table = [] {
+			std::array<uint8_t, LinearToSRGBTableSize> result = {};
+			for ( uint32_t i = 0; i < LinearToSRGBTableSize; i++ )
+				result[ i ] = ToUnorm8( LinearToSRGB( float( i ) / float( LinearToSRGBTableSize - 1 ) ) );
+
+			return result;
+		}();
+
+		return table;
+	}
+
+	// Zeroth order modified Bessel function of the first kind, the series converges quickly for the alphas used here.
+	static float BesselI0( float x ) {
+		float sum = 1.f, term = 1.f;
+		for ( uint32_t k = 1; k < 32 && term > sum * 1e-8f; k++ ) {
+			const float half = x / ( 2.f * float( k ) );
+			term *= half * half;
+			sum += term;
+		}
+
+		return sum;
+	}
+
+	static float EvaluateKaiser( float x ) {
+		const float t = x / KaiserRadius;
+		if ( std::abs( t ) >= 1.f )
+			return 0.f;
+
+		const float pix = 3.14159265f * x;
+		const float sinc = std::abs( x ) < 1e-5f ? 1.f : std::sin( pix ) / pix;
+
+		return sinc * BesselI0( KaiserAlpha * std::sqrt( 1.f - t * t ) ) / BesselI0( KaiserAlpha );
+	}
+
+	static FilterKernel BuildKernel( uint32_t srcSize, uint32_t dstSize, EMipFilter filter ) {
+		FilterKernel kernel = {};
+		kernel.m_First.reserve( dstSize + 1 );
+
+		// Source texels per destination texel, 2 on even sizes and a bit more on odd ones.
+		const float scale = float( srcSize ) / float( dstSize );
+		const float radius = ( filter == EMipFilter::Box ? 0.5f : KaiserRadius ) * scale;
+
+		for ( uint32_t d = 0; d < dstSize; d++ ) {
+			const float center = ( float( d ) + 0.5f ) * scale;
+			const int32_t first = int32_t( std::floor( center - radius ) );
+			const int32_t last = int32_t( std::ceil( center + radius ) );
+
+			kernel.m_First.push_back( uint32_t( kernel.m_Taps.size() ) );
+
+			float totalWeight = 0.f;
+			for ( int32_t s = first; s < last; s++ ) {
+				float weight = 0.f;
+				if ( filter == EMipFilter::Box )
+					weight = std::max( std::min( float( s + 1 ), center + radius ) - std::max( float( s ), center - radius ), 0.f );
+				else
+					weight = EvaluateKaiser( ( float( s ) + 0.5f - center ) / scale );
+
+				if ( weight == 0.f )
+					continue;
+
+				kernel.m_Taps.push_back( FilterTap{ uint32_t( std::clamp( s, 0, int32_t( srcSize ) - 1 ) ), weight } );
+				totalWeight += weight;
+			}
+
+			for ( uint32_t i = kernel.m_First.back(); i < uint32_t( kernel.m_Taps.size() ); i++ )
+				kernel.m_Taps[ i ].m_Weight /= totalWeight;
+		}
+
+		kernel.m_First.push_back( uint32_t( kernel.m_Taps.size() ) );
+		return kernel;
+	}
+
+	// Horizontal pass, one RGBA texel per SSE register.
+	static void FilterRows( const float* src, uint32_t srcWidth, uint32_t height, const FilterKernel& kernel, uint32_t dstWidth, float* dst ) {
+		for ( uint32_t y = 0; y < height; y++ ) {
+			const float* row = src + size_t( y ) * srcWidth * 4;
+			float* out = dst + size_t( y ) * dstWidth * 4;
+
+			for ( uint32_t x = 0; x < dstWidth; x++ ) {
+				__m128 sum = _mm_setzero_ps();
+				for ( uint32_t i = kernel.m_First[ x ]; i < kernel.m_First[ x + 1 ]; i++ ) {
+					const FilterTap& tap = kernel.m_Taps[ i ];
+					sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( row + size_t( tap.m_Index ) * 4 ), _mm_set1_ps( tap.m_Weight ) ) );
+				}
+
+				_mm_storeu_ps( out + size_t( x ) * 4, sum );
+			}
+		}
+	}
+
+	// Vertical pass, whole rows are weighted and accumulated two texels per AVX register.
+	static void FilterColumns( const float* src, uint32_t width, const FilterKernel& kernel, uint32_t dstHeight, float* dst ) {
+		const size_t rowFloats = size_t( width ) * 4;
+
+		for ( uint32_t y = 0; y < dstHeight; y++ ) {
+			float* out = dst + y * rowFloats;
+			std::fill( out, out + rowFloats, 0.f );
+
+			for ( uint32_t i = kernel.m_First[ y ]; i < kernel.m_First[ y + 1 ]; i++ ) {
+				const FilterTap& tap = kernel.m_Taps[ i ];
+				const float* row = src + tap.m_Index * rowFloats;
+
+				const __m256 weight = _mm256_set1_ps( tap.m_Weight );
+				size_t f = 0;
+				for ( ; f + 8 <= rowFloats; f += 8 )
+					_mm256_storeu_ps( out + f, _mm256_add_ps( _mm256_loadu_ps( out + f ), _mm256_mul_ps( _mm256_loadu_ps( row + f ), weight ) ) );
+
+				// Odd width, one texel left.
+				if ( f < rowFloats )
+					_mm_storeu_ps( out + f, _mm_add_ps( _mm_loadu_ps( out + f ), _mm_mul_ps( _mm_loadu_ps( row + f ), _mm256_castps256_ps128( weight ) ) ) );
+			}
+		}
+	}
+
+	MipChain GenerateMips( const uint8_t* pixels, uint32_t width, uint32_t height, const MipDesc& desc ) {
+		MipChain chain = {};
+
+		const uint32_t levelCount = uint32_t( std::floor( std::log2( std::max( width, height ) ) ) ) + 1;
+
+		size_t totalSize = 0;
+		for ( uint32_t level = 0, w = width, h = height; level < levelCount; level++ ) {
+			const size_t size = size_t( w ) * h * 4;
+			chain.m_Levels.push_back( MipLevel{ w, h, totalSize, size } );
+			totalSize += size;
+
+			w = std::max( w / 2, 1u );
+			h = std::max( h / 2, 1u );
+		}
+
+		chain.m_Pixels.resize( totalSize );
+		memcpy( chain.m_Pixels.data(), pixels, chain.m_Levels[ 0 ].m_Size );
+
+		if ( levelCount == 1 )
+			return chain;
+
+		// Alpha is never sRGB encoded.
+		std::array<float, 256> colorToLinear = {};
+		for ( uint32_t i = 0; i < 256; i++ )
+			colorToLinear[ i ] = desc.m_SRGB ? SRGBToLinear( i / 255.f ) : i / 255.f;
+
+		const std::array<uint8_t, LinearToSRGBTableSize>& linearToSRGB = GetLinearToSRGBTable();
+
+		std::vector<float> current( size_t( width ) * height * 4 );
+		for ( size_t i = 0; i < current.size(); i++ )
+			current[ i ] = ( i & 3 ) == 3 ? pixels[ i ] / 255.f : colorToLinear[ pixels[ i ] ];
+
+		std::vector<float> scratch, next;
+
+		for ( uint32_t level = 1; level < levelCount; level++ ) {
+			const MipLevel& src = chain.m_Levels[ level - 1 ];
+			const MipLevel& dst = chain.m_Levels[ level ];
+
+			const FilterKernel kernelX = BuildKernel( src.m_Width, dst.m_Width, desc.m_Filter );
+			const FilterKernel kernelY = BuildKernel( src.m_Height, dst.m_Height, desc.m_Filter );
+
+			scratch.resize( size_t( dst.m_Width ) * src.m_Height * 4 );
+			next.resize( size_t( dst.m_Width ) * dst.m_Height * 4 );
+
+			FilterRows( current.data(), src.m_Width, src.m_Height, kernelX, dst.m_Width, scratch.data() );
+			FilterColumns( scratch.data(), dst.m_Width, kernelY, dst.m_Height, next.data() );
+
+			uint8_t* out = chain.m_Pixels.data() + dst.m_Offset;
+			for ( size_t texel = 0; texel < size_t( dst.m_Width ) * dst.m_Height; texel++ ) {
+				float* color = next.data() + texel * 4;
+
+				if ( desc.m_NormalMap ) {
+					// Renormalized in place, the next level filters unit vectors again.
+					glm::vec3 normal = glm::vec3( color[ 0 ], color[ 1 ], color[ 2 ] ) * 2.f - 1.f;
+					const float length = glm::length( normal );
+					normal = length > 1e-6f ? normal / length : glm::vec3( 0.f, 0.f, 1.f );
+
+					color[ 0 ] = normal.x * 0.5f + 0.5f;
+					color[ 1 ] = normal.y * 0.5f + 0.5f;
+					color[ 2 ] = normal.z * 0.5f + 0.5f;
+				}
+
+				for ( uint32_t c = 0; c < 4; c++ ) {
+					// Clamped in place as well, Kaiser ringing would otherwise build up along the chain.
+					color[ c ] = std::clamp( color[ c ], 0.f, 1.f );
+
+					if ( desc.m_SRGB && c < 3 )
+						out[ texel * 4 + c ] = linearToSRGB[ uint32_t( color[ c ] * float( LinearToSRGBTableSize - 1 ) + 0.5f ) ];
+					else
+						out[ texel * 4 + c ] = ToUnorm8( color[ c ] );
+				}
+			}
+
+			std::swap( current, next );
+		}
+
+		return chain;
+	}
+}
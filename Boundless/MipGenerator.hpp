@@ -0,0 +1,35 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	struct MipLevel {
+		uint32_t m_Width;
+		uint32_t m_Height;
+		size_t	 m_Offset; // Into MipChain::m_Pixels.
+		size_t	 m_Size;
+	};
+
+	// Full mip chain of an RGBA8 image, level 0 first, tightly packed.
+	struct MipChain {
+		std::vector<MipLevel> m_Levels;
+		std::vector<uint8_t>  m_Pixels;
+
+		const uint8_t* GetLevelData( uint32_t level ) const { return m_Pixels.data() + m_Levels[ level ].m_Offset; }
+	};
+
+	enum class EMipFilter {
+		Box,   // Area average. Exactly 2x2 on even sizes, odd sizes get partial weights instead of dropping texels.
+		Kaiser // Kaiser windowed sinc, keeps more detail than the box but rings a little, results are clamped.
+	};
+
+	struct MipDesc {
+		EMipFilter m_Filter = EMipFilter::Box;
+		bool	   m_SRGB = false;		// Filter in linear space, the color channels are sRGB encoded.
+		bool	   m_NormalMap = false; // XYZ are a [0, 1] encoded unit vector, renormalized after filtering.
+	};
+
+	// Builds the mip chain on the CPU, single threaded so callers can run one texture per task.
+	// Each level is filtered from the float version of the level above it (separable, SSE/AVX), so precision isn't lost
+	// to 8 bit rounding along the chain. Addressing is clamped at the edges.
+	MipChain GenerateMips( const uint8_t* pixels, uint32_t width, uint32_t height, const MipDesc& desc );
+}
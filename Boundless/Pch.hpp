@@ -1,10 +1,18 @@
 #pragma once
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
 #include <set>
 #include <string>
@@ -0,0 +1,279 @@
+#include "Pch.hpp"
+#include "RenderGraph.hpp"
+
+namespace Boundless {
+	RenderGraph::Pass& RenderGraph::Pass::Read( RenderGraphResource resource, EImageAccess access ) {
+		m_Accesses.push_back( Access{ resource, access, true, false } );
+		return *this;
+	}
+
+	RenderGraph::Pass& RenderGraph::Pass::Write( RenderGraphResource resource, EImageAccess access ) {
+		m_Accesses.push_back( Access{ resource, access, false, true } );
+		return *this;
+	}
+
+	RenderGraph::Pass& RenderGraph::Pass::Modify( RenderGraphResource resource, EImageAccess access ) {
+		m_Accesses.push_back( Access{ resource, access, true, true } );
+		return *this;
+	}
+
+	RenderGraph::~RenderGraph() {
+		ReleasePlacements();
+	}
+
+	void RenderGraph::Reset() {
+		m_Resources.clear();
+		m_Passes.clear();
+	}
+
+	RenderGraphResource RenderGraph::CreateImage( const std::string& name, const Image::Desc& desc ) {
+		m_Resources.push_back( Resource{ .m_Name = name, .m_Desc = desc } );
+		return RenderGraphResource( m_Resources.size() - 1 );
+	}
+
+	RenderGraph::Pass& RenderGraph::AddPass( const std::string& name ) {
+		Pass& pass = m_Passes.emplace_back();
+		pass.m_Name = name;
+		return pass;
+	}
+
+	void RenderGraph::Compile() {
+		CullPasses();
+		ComputeLifetimes();
+
+		std::vector<Lifetime> lifetimes;
+		for ( const Resource& resource : m_Resources )
+			lifetimes.push_back( Lifetime{ resource.m_Desc, resource.m_FirstPass, resource.m_LastPass } );
+
+		if ( lifetimes != m_Lifetimes ) {
+			ReleasePlacements();
+			m_Lifetimes = std::move( lifetimes );
+			Allocate();
+		}
+
+		for ( size_t i = 0; i < m_Resources.size(); i++ ) {
+			m_Resources[ i ].m_Image = m_Placements[ i ].m_Image;
+			m_Resources[ i ].m_View = m_Placements[ i ].m_View;
+		}
+	}
+
+	void RenderGraph::CullPasses() {
+		m_Stats.m_Passes = uint32_t( m_Passes.size() );
+		m_Stats.m_CulledPasses = 0;
+
+		// Walks back from the passes with side effects, a pass is kept when a kept pass reads something it writes.
+		std::vector<bool> needed( m_Resources.size(), false );
+
+		for ( size_t i = m_Passes.size(); i-- > 0; ) {
+			Pass& pass = m_Passes[ i ];
+
+			pass.m_Culled = !pass.m_SideEffects;
+			for ( const Pass::Access& access : pass.m_Accesses ) {
+				if ( access.m_Write && needed[ size_t( access.m_Resource ) ] )
+					pass.m_Culled = false;
+			}
+
+			if ( pass.m_Culled ) {
+				m_Stats.m_CulledPasses++;
+				continue;
+			}
+
+			// A whole write ends the chain, earlier writers are only needed through this pass' reads.
+			for ( const Pass::Access& access : pass.m_Accesses ) {
+				if ( access.m_Write && !access.m_Read )
+					needed[ size_t( access.m_Resource ) ] = false;
+			}
+
+			for ( const Pass::Access& access : pass.m_Accesses ) {
+				if ( access.m_Read )
+					needed[ size_t( access.m_Resource ) ] = true;
+			}
+		}
+	}
+
+	void RenderGraph::ComputeLifetimes() {
+		for ( uint32_t i = 0; i < uint32_t( m_Passes.size() ); i++ ) {
+			const Pass& pass = m_Passes[ i ];
+			if ( pass.m_Culled )
+				continue;
+
+			for ( const Pass::Access& access : pass.m_Accesses ) {
+				Resource& resource = m_Resources[ size_t( access.m_Resource ) ];
+
+				if ( resource.m_FirstPass == Unused ) {
+					resource.m_FirstPass = i;
+
+					if ( access.m_Read )
+						printf( "[RenderGraph] %s reads %s before anything wrote it\n", pass.m_Name.c_str(), resource.m_Name.c_str() );
+				}
+
+				resource.m_LastPass = i;
+			}
+		}
+	}
+
+	void RenderGraph::Allocate() {
+		m_Placements.assign( m_Resources.size(), Placement{} );
+		m_Stats.m_Images = 0;
+		m_Stats.m_TotalBytes = 0;
+
+		std::vector<size_t> order;
+		std::vector<vk::MemoryRequirements> imageRequirements( m_Resources.size() );
+		vk::MemoryRequirements requirements = { 0, 1, ~0u };
+
+		for ( size_t i = 0; i < m_Resources.size(); i++ ) {
+			if ( m_Lifetimes[ i ].m_FirstPass == Unused )
+				continue;
+
+			imageRequirements[ i ] = m_Device.GetImageMemoryRequirements( m_Lifetimes[ i ].m_Desc );
+			requirements.alignment = std::max( requirements.alignment, imageRequirements[ i ].alignment );
+			requirements.memoryTypeBits &= imageRequirements[ i ].memoryTypeBits;
+
+			m_Stats.m_Images++;
+			m_Stats.m_TotalBytes += imageRequirements[ i ].size;
+			order.push_back( i );
+		}
+
+		if ( order.empty() )
+			return;
+
+		// Largest first, smaller images then fill the gaps left next to them.
+		std::stable_sort( order.begin(), order.end(), [ & ]( size_t a, size_t b ) { return imageRequirements[ a ].size > imageRequirements[ b ].size; } );
+
+		auto overlaps = [ this ]( size_t a, size_t b ) {
+			return m_Lifetimes[ a ].m_FirstPass <= m_Lifetimes[ b ].m_LastPass && m_Lifetimes[ b ].m_FirstPass <= m_Lifetimes[ a ].m_LastPass;
+		};
+
+		for ( size_t orderIndex = 0; orderIndex < order.size(); orderIndex++ ) {
+			const size_t index = order[ orderIndex ];
+			const vk::DeviceSize alignment = imageRequirements[ index ].alignment;
+
+			Placement& placement = m_Placements[ index ];
+			placement.m_Size = imageRequirements[ index ].size;
+
+			// Already placed images alive at the same time, in memory order. Take the first gap that fits.
+			std::vector<const Placement*> live;
+			for ( size_t i = 0; i < orderIndex; i++ ) {
+				if ( overlaps( index, order[ i ] ) )
+					live.push_back( &m_Placements[ order[ i ] ] );
+			}
+
+			std::sort( live.begin(), live.end(), []( const Placement* a, const Placement* b ) { return a->m_Offset < b->m_Offset; } );
+
+			vk::DeviceSize offset = 0;
+			for ( const Placement* other : live ) {
+				if ( offset + placement.m_Size <= other->m_Offset )
+					break;
+
+				offset = std::max( offset, ( other->m_Offset + other->m_Size + alignment - 1 ) / alignment * alignment );
+			}
+
+			placement.m_Offset = offset;
+			requirements.size = std::max( requirements.size, offset + placement.m_Size );
+		}
+
+		if ( requirements.memoryTypeBits != 0 )
+			m_Memory = m_Device.AllocateAliasedMemory( requirements );
+
+		if ( m_Memory == VK_NULL_HANDLE )
+			printf( "[RenderGraph] Transient images can't share memory, allocating them separately\n" );
+
+		for ( size_t index : order ) {
+			Placement& placement = m_Placements[ index ];
+			const Image::Desc& desc = m_Lifetimes[ index ].m_Desc;
+
+			if ( m_Memory != VK_NULL_HANDLE )
+				placement.m_Image = m_Device.CreateAliasedImage( desc, m_Memory, placement.m_Offset );
+
+			// Gets memory of its own when it can't be placed in the shared block, it overlaps nothing there then.
+			if ( placement.m_Image == ImageHandle::Invalid ) {
+				placement.m_Image = m_Device.CreateImage( desc );
+				placement.m_Size = 0;
+			}
+
+			if ( placement.m_Image == ImageHandle::Invalid ) {
+				printf( "[RenderGraph] Failed to create transient image %zu (%ux%u)\n", index, desc.m_Width, desc.m_Height );
+				continue;
+			}
+
+			placement.m_View = m_Device.CreateImageView( placement.m_Image );
+		}
+
+		m_Stats.m_AliasedBytes = m_Memory != VK_NULL_HANDLE ? requirements.size : m_Stats.m_TotalBytes;
+		PrintStats();
+	}
+
+	void RenderGraph::ReleasePlacements() {
+		for ( const Placement& placement : m_Placements ) {
+			if ( placement.m_View != ImageHandle::Invalid )
+				m_Device.ReleaseImageView( placement.m_View );
+
+			if ( placement.m_Image != ImageHandle::Invalid )
+				m_Device.ReleaseImage( placement.m_Image );
+		}
+
+		// Queued after the images, they are gone by the time it is freed.
+		if ( m_Memory != VK_NULL_HANDLE )
+			m_Device.ReleaseAliasedMemory( m_Memory );
+
+		m_Placements.clear();
+		m_Lifetimes.clear();
+		m_Memory = VK_NULL_HANDLE;
+	}
+
+	ImageState RenderGraph::GetAliasedState( size_t index ) {
+		// Whatever last touched the memory, earlier this frame or in the previous one, has to be done before the image
+		// overwrites it. Its own previous use included.
+		const Placement& placement = m_Placements[ index ];
+		ImageState state = {};
+
+		for ( const Placement& other : m_Placements ) {
+			if ( other.m_Image == ImageHandle::Invalid || other.m_Offset >= placement.m_Offset + placement.m_Size || placement.m_Offset >= other.m_Offset + other.m_Size )
+				continue;
+
+			const Image& image = m_Device.GetImage( other.m_Image );
+			for ( uint32_t layer = 0; layer < image.GetLayers(); layer++ ) {
+				for ( uint32_t level = 0; level < image.GetLevels(); level++ ) {
+					state.m_Stages |= image.GetState( level, layer ).m_Stages;
+					state.m_Access |= image.GetState( level, layer ).m_Access;
+				}
+			}
+		}
+
+		return state;
+	}
+
+	void RenderGraph::Execute( CommandBuffer& commandBuffer ) {
+		for ( Pass& pass : m_Passes ) {
+			if ( pass.m_Culled )
+				continue;
+
+			for ( const Pass::Access& access : pass.m_Accesses ) {
+				Resource& resource = m_Resources[ size_t( access.m_Resource ) ];
+				Image& image = m_Device.GetImage( resource.m_Image );
+
+				// Nothing is kept from the previous frame, the first use always starts from undefined contents.
+				bool discard = !access.m_Read;
+				if ( !resource.m_Used ) {
+					if ( m_Memory != VK_NULL_HANDLE )
+						image.ResetState( GetAliasedState( size_t( access.m_Resource ) ) );
+
+					resource.m_Used = true;
+					discard = true;
+				}
+
+				commandBuffer.Transition( image, access.m_Access, discard );
+			}
+
+			commandBuffer.FlushBarriers();
+
+			if ( pass.m_Execute )
+				pass.m_Execute( commandBuffer );
+		}
+	}
+
+	void RenderGraph::PrintStats() const {
+		printf( "[RenderGraph] %u passes (%u culled), %u transient images in %.1f MB (%.1f MB without aliasing)\n",
+			m_Stats.m_Passes, m_Stats.m_CulledPasses, m_Stats.m_Images, m_Stats.m_AliasedBytes / ( 1024.0 * 1024.0 ), m_Stats.m_TotalBytes / ( 1024.0 * 1024.0 ) );
+	}
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include "Device.hpp"
+
+namespace Boundless {
+	enum class RenderGraphResource : uint32_t { Invalid = 0xFFFFFFFF };
+
+	// Frame graph over the frame's render targets, rebuilt every frame.
+	//
+	// Passes declare what they read and write and run in the order they were added, which is always a valid one as a
+	// pass can only use what earlier passes wrote. Compile culls passes whose outputs nobody reads (unless they have side
+	// effects, e.g. buffer writes or the swapchain blit) and places the transient images: each lives from its first to its
+	// last use, images whose lifetimes don't overlap share memory. Execute moves every image to the state its pass needs
+	// (CommandBuffer::Transition, one pipelineBarrier2 per pass) before running the pass.
+	//
+	// Placements are kept while the frame's graph has the same shape, a change (resize, a different output) releases them
+	// with the current frame and allocates new ones.
+	class RenderGraph {
+	public:
+		class Pass {
+			friend class RenderGraph;
+		public:
+			Pass& Read( RenderGraphResource resource, EImageAccess access );
+			// Overwrites the whole resource (attachments are cleared), what earlier passes wrote is dropped.
+			Pass& Write( RenderGraphResource resource, EImageAccess access );
+			// Reads and writes, e.g. loading attachments to draw more on top.
+			Pass& Modify( RenderGraphResource resource, EImageAccess access );
+			// Never culled, for passes with results outside of the graph.
+			Pass& SideEffects() { m_SideEffects = true; return *this; }
+			Pass& Execute( std::function<void( CommandBuffer& )> execute ) { m_Execute = std::move( execute ); return *this; }
+		private:
+			struct Access {
+				RenderGraphResource m_Resource;
+				EImageAccess		m_Access;
+				bool				m_Read;
+				bool				m_Write;
+			};
+
+			std::string							m_Name;
+			std::vector<Access>					m_Accesses;
+			bool								m_SideEffects = false;
+			bool								m_Culled = false;
+			std::function<void( CommandBuffer& )> m_Execute;
+		};
+
+		struct Stats {
+			uint32_t	   m_Passes = 0;
+			uint32_t	   m_CulledPasses = 0;
+			uint32_t	   m_Images = 0;
+			vk::DeviceSize m_AliasedBytes = 0; // Memory shared by the transient images.
+			vk::DeviceSize m_TotalBytes = 0;   // What they would take with memory of their own.
+		};
+
+		explicit RenderGraph( Device& device ) : m_Device( device ) { }
+		~RenderGraph();
+
+		RenderGraph( const RenderGraph& ) = delete;
+		RenderGraph& operator=( const RenderGraph& ) = delete;
+
+		// Drops the previous frame's passes and resources, placements stay around for Compile to reuse.
+		void Reset();
+
+		// Transient image, its contents don't survive the frame.
+		RenderGraphResource CreateImage( const std::string& name, const Image::Desc& desc );
+		Pass& AddPass( const std::string& name );
+
+		void Compile();
+		void Execute( CommandBuffer& commandBuffer );
+
+		// Valid once compiled, invalid for images only culled passes used.
+		ImageHandle GetImage( RenderGraphResource resource ) const { return m_Resources[ size_t( resource ) ].m_Image; }
+		ImageHandle GetView( RenderGraphResource resource ) const { return m_Resources[ size_t( resource ) ].m_View; }
+
+		const Stats& GetStats() const { return m_Stats; }
+		void PrintStats() const;
+	private:
+		constexpr static const uint32_t Unused = UINT32_MAX;
+
+		struct Resource {
+			std::string m_Name;
+			Image::Desc m_Desc;
+			uint32_t	m_FirstPass = Unused;
+			uint32_t	m_LastPass = Unused;
+			ImageHandle m_Image = ImageHandle::Invalid;
+			ImageHandle m_View = ImageHandle::Invalid;
+			bool		m_Used = false; // Touched by Execute this frame.
+		};
+
+		// What the placements were made for, Compile reuses them while it matches.
+		struct Lifetime {
+			Image::Desc m_Desc;
+			uint32_t	m_FirstPass;
+			uint32_t	m_LastPass;
+
+			bool operator==( const Lifetime& other ) const {
+				return m_Desc == other.m_Desc && m_FirstPass == other.m_FirstPass && m_LastPass == other.m_LastPass;
+			}
+		};
+
+		struct Placement {
+			ImageHandle	   m_Image = ImageHandle::Invalid;
+			ImageHandle	   m_View = ImageHandle::Invalid;
+			vk::DeviceSize m_Offset = 0;
+			vk::DeviceSize m_Size = 0;
+		};
+
+		void CullPasses();
+		void ComputeLifetimes();
+		void Allocate();
+		void ReleasePlacements();
+		ImageState GetAliasedState( size_t index );
+
+		Device&					   m_Device;
+		std::vector<Resource>	   m_Resources;
+		std::deque<Pass>		   m_Passes; // Deque, AddPass hands out references.
+
+		std::vector<Lifetime>	   m_Lifetimes;
+		std::vector<Placement>	   m_Placements; // Indexed like m_Resources.
+		VmaAllocation			   m_Memory = VK_NULL_HANDLE;
+		Stats					   m_Stats;
+	};
+}
@@ -30,54 +30,95 @@ namespace Boundless {
 			.Build( device );
 	}
 
-	GBufferOutput GBufferPass::Render( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene ) {
-		BeginRendering( commandBuffer, device );
-		
+	void GBufferPass::BindSceneData( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene ) {
 		commandBuffer.SetScissorAndViewport(m_Viewport);
 		commandBuffer.BindPipeline(m_Pipeline);
 
 		commandBuffer->setCullMode( vk::CullModeFlagBits::eBack );
 
-		auto& registry = scene.GetRegistry();
+		GBufferPushConstants pc = {
+			.m_FrameConstantsBuffer = device.GetBuffer( frameConstantsBuffer ).GetDeviceAddress(),
+			.m_MaterialsBuffer		= device.GetBuffer( scene.GetMaterialBuffer() ).GetDeviceAddress(),
+			.m_InstancesBuffer		= device.GetBuffer( scene.GetInstanceBuffer() ).GetDeviceAddress(),
+			.m_TextureTableBuffer	= device.GetBuffer( scene.GetTextureTable() ).GetDeviceAddress(),
+		};
 
-		for ( entt::entity entity : registry.view<Mesh>() ) {
-			const Mesh& mesh = registry.get<Mesh>( entity );
-			if ( mesh.m_Indices.empty() )
-				continue;
+		commandBuffer.BindIndexBuffer( device.GetBuffer( scene.GetIndexBuffer() ) );
+		commandBuffer.BindPushConstants( device, &pc, sizeof( pc ) );
+	}
 
-			if ( !registry.all_of<Transform>( entity ) )
-				continue;
+	void GBufferPass::Render( CommandBuffer& commandBuffer, Device& device, const GBufferOutput& targets, BufferHandle frameConstantsBuffer, Scene& scene, const std::vector<entt::entity>& visibleEntities, ThreadPool& threadPool ) {
+		const uint32_t drawCount = scene.GetInstanceCount() > 0 ? uint32_t( visibleEntities.size() ) : 0u;
+		const uint32_t chunkCount = std::min( threadPool.GetThreadCount() + 1, ( drawCount + MinDrawsPerChunk - 1 ) / MinDrawsPerChunk );
 
-			vk::DeviceAddress vertexBuffer = device.GetBuffer( mesh.m_VertexBuffer ).GetDeviceAddress();
-			if ( mesh.m_SkinnedVertexBuffer != BufferHandle::Invalid ) {
-				vertexBuffer = device.GetBuffer( mesh.m_SkinnedVertexBuffer ).GetDeviceAddress();
+		if ( chunkCount <= 1 ) {
+			BeginRendering( commandBuffer, device, { targets.m_GBuffer }, targets.m_DepthBuffer );
+
+			if ( drawCount > 0 ) {
+				BindSceneData( commandBuffer, device, frameConstantsBuffer, scene );
+				RecordDraws( commandBuffer, scene, visibleEntities, 0, drawCount );
 			}
 
-			Transform& transform = registry.get<Transform>( entity );
-			glm::mat4 worldTransform = transform.m_WorldTransform;
+			EndRendering( commandBuffer, device );
+			return;
+		}
 
-			vk::DeviceAddress frameConstants = device.GetBuffer( frameConstantsBuffer ).GetDeviceAddress();
-			vk::DeviceAddress sceneMaterials = device.GetBuffer( scene.GetMaterialBuffer() ).GetDeviceAddress();
-			uint32_t materialIndex		     = mesh.m_Material;
+		// Every chunk goes into a secondary command buffer of the thread recording it, executed in draw order below.
+		const std::vector<vk::Format> colorFormats = m_RenderTargetDescs | std::views::transform( &Image::Desc::m_Format ) | std::ranges::to<std::vector>();
 
-			GBufferPushConstants pc = {
-				.m_FrameConstantsBuffer = frameConstants,
-				.m_MaterialsBuffer		= sceneMaterials,
-				.m_VertexBuffer			= vertexBuffer,
-				.m_WorldTransform		= worldTransform,
-				.m_MaterialIndex		= materialIndex,
-			};
+		vk::CommandBufferInheritanceRenderingInfo inheritanceInfo = {};
+		inheritanceInfo.setColorAttachmentFormats( colorFormats )
+			.setDepthAttachmentFormat( m_DepthDesc.m_Format )
+			.setRasterizationSamples( vk::SampleCountFlagBits::e1 );
 
-			Buffer& indexBuffer = device.GetBuffer( mesh.m_IndexBuffer );
-			commandBuffer.BindIndexBuffer( indexBuffer );
-			commandBuffer.BindPushConstants( device, &pc, sizeof( pc ) );
-			commandBuffer->drawIndexed( uint32_t( mesh.m_Indices.size() ), 1, 0, 0, 0 );
-		}
+		const uint32_t drawsPerChunk = ( drawCount + chunkCount - 1 ) / chunkCount;
+		std::vector<vk::CommandBuffer> secondaries( chunkCount );
+
+		threadPool.ParallelFor( chunkCount, [ & ]( uint32_t begin, uint32_t end ) {
+			for ( uint32_t chunk = begin; chunk < end; chunk++ ) {
+				CommandBuffer secondary = device.GetCommandBuffers().GetFrameCommandBuffer( vk::CommandBufferLevel::eSecondary );
+				secondary.BeginSecondary( inheritanceInfo );
+
+				// Nothing is inherited from the primary, state is bound again per chunk.
+				secondary.BindDefaults( device );
+				BindSceneData( secondary, device, frameConstantsBuffer, scene );
+				RecordDraws( secondary, scene, visibleEntities, chunk * drawsPerChunk, std::min( ( chunk + 1 ) * drawsPerChunk, drawCount ) );
+
+				secondary.End();
+				secondaries[ chunk ] = secondary;
+			}
+		} );
 
+		BeginRendering( commandBuffer, device, { targets.m_GBuffer }, targets.m_DepthBuffer, true, vk::RenderingFlagBits::eContentsSecondaryCommandBuffers );
+		commandBuffer->executeCommands( secondaries );
 		EndRendering( commandBuffer, device );
-		AddExitBarriers( commandBuffer, device );
+	}
 
-		return GBufferOutput{ m_RenderTargetViews[ 0 ], m_DepthTargetView };
+	void GBufferPass::RecordDraws( CommandBuffer& commandBuffer, const Scene& scene, const std::vector<entt::entity>& visibleEntities, uint32_t begin, uint32_t end ) {
+		// Const, reads from several threads at once must not create storage.
+		const entt::registry& registry = scene.GetRegistry();
+
+		// firstInstance selects the mesh instance in the vertex shader.
+		for ( uint32_t i = begin; i < end; i++ ) {
+			const Mesh& mesh = registry.get<Mesh>( visibleEntities[ i ] );
+			commandBuffer->drawIndexed( mesh.m_Geometry.m_IndexCount, 1, mesh.m_Geometry.m_IndexOffset, 0, mesh.m_InstanceIndex );
+		}
+	}
+
+	void GBufferPass::RenderIndirect( CommandBuffer& commandBuffer, Device& device, const GBufferOutput& targets, BufferHandle frameConstantsBuffer, Scene& scene, const GPUCullOutput& cullOutput, bool clear ) {
+		BeginRendering( commandBuffer, device, { targets.m_GBuffer }, targets.m_DepthBuffer, clear );
+
+		if ( cullOutput.m_MaxDrawCount > 0 ) {
+			BindSceneData( commandBuffer, device, frameConstantsBuffer, scene );
+
+			commandBuffer->drawIndexedIndirectCount( 
+				device.GetBuffer( cullOutput.m_DrawCommands ), cullOutput.m_DrawCommandsOffset, 
+				device.GetBuffer( cullOutput.m_DrawCount ), cullOutput.m_DrawCountOffset, 
+				cullOutput.m_MaxDrawCount, sizeof( vk::DrawIndexedIndirectCommand ) 
+			);
+		}
+
+		EndRendering( commandBuffer, device );
 	}
 
 	// ------------------
@@ -100,15 +141,15 @@ namespace Boundless {
 			.Build( device );
 	}
 	
-	void GBufferDebugPass::Render( CommandBuffer& commandBuffer, Device& device, ImageHandle gbufferTexture, ImageHandle depthTexture, uint32_t channelIndex ) {
-		BeginRendering( commandBuffer, device );
+	void GBufferDebugPass::Render( CommandBuffer& commandBuffer, Device& device, ImageHandle target, ImageHandle gbufferTexture, ImageHandle depthTexture, uint32_t channelIndex ) {
+		BeginRendering( commandBuffer, device, { target }, ImageHandle::Invalid );
 
 		commandBuffer.SetScissorAndViewport( float( m_Viewport.Size.width ), float( m_Viewport.Size.height ), 0.f, 0.f, 0.f, 1.f, false );
 		commandBuffer.BindPipeline(m_Pipeline);
 
 		GBufferDebugPushConstants pc = {
-			.m_GBufferTexture = uint32_t( gbufferTexture ),
-			.m_DepthTexture = uint32_t( depthTexture ),
+			.m_GBufferTexture = device.GetImageBindlessIndex( gbufferTexture ),
+			.m_DepthTexture = device.GetImageBindlessIndex( depthTexture ),
 			.m_GBufferChannel = channelIndex
 		};
 
@@ -118,7 +159,6 @@ namespace Boundless {
 		commandBuffer->draw( 3, 1, 0, 0 );
 
 		EndRendering( commandBuffer, device );
-		AddExitBarriers( commandBuffer, device );
 	}
 
 	// -------------
@@ -141,8 +181,8 @@ namespace Boundless {
 			.Build( device );
 	}
 
-	void LightingPass::Render( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene, const GBufferOutput& gbufferOutput ) {
-		BeginRendering( commandBuffer, device );
+	void LightingPass::Render( CommandBuffer& commandBuffer, Device& device, ImageHandle target, BufferHandle frameConstantsBuffer, Scene& scene, const GBufferOutput& gbufferOutput ) {
+		BeginRendering( commandBuffer, device, { target }, ImageHandle::Invalid );
 
 		commandBuffer.SetScissorAndViewport( float( m_Viewport.Size.width ), float( m_Viewport.Size.height ), 0.f, 0.f, 0.f, 1.f, false );
 		commandBuffer.BindPipeline( m_Pipeline );
@@ -151,8 +191,8 @@ namespace Boundless {
 
 		LightingPushConstants pc = {
 			.m_FrameConstantsBuffer = frameConstants,
-			.m_GBufferTexture = uint32_t( gbufferOutput.m_GBuffer ),
-			.m_GBufferDepthTexture = uint32_t( gbufferOutput.m_DepthBuffer ),
+			.m_GBufferTexture = device.GetImageBindlessIndex( gbufferOutput.m_GBuffer ),
+			.m_GBufferDepthTexture = device.GetImageBindlessIndex( gbufferOutput.m_DepthBuffer ),
 		};
 
 		commandBuffer.BindPushConstants( device, &pc, sizeof( pc ) );
@@ -161,7 +201,6 @@ namespace Boundless {
 		commandBuffer->draw( 3, 1, 0, 0 );
 
 		EndRendering( commandBuffer, device );
-		AddExitBarriers( commandBuffer, device );
 	}
 
 	// -------------
@@ -184,14 +223,14 @@ namespace Boundless {
 			.Build( device );
 	}
 	
-	void CompositePass::Render( CommandBuffer& commandBuffer, Device& device, ImageHandle texture ) { 
-		BeginRendering( commandBuffer, device );
+	void CompositePass::Render( CommandBuffer& commandBuffer, Device& device, ImageHandle target, ImageHandle texture ) { 
+		BeginRendering( commandBuffer, device, { target }, ImageHandle::Invalid );
 
 		commandBuffer.SetScissorAndViewport( float( m_Viewport.Size.width ), float( m_Viewport.Size.height ), 0.f, 0.f, 0.f, 1.f, false );
 		commandBuffer.BindPipeline( m_Pipeline );
 
 		CompositePushConstants pc = {
-			.m_Texture = uint32_t( texture ),
+			.m_Texture = device.GetImageBindlessIndex( texture ),
 			.m_ApplyGammaCurve = 1,
 			.m_ApplyTonemapping = 1,
 		};
@@ -202,7 +241,6 @@ namespace Boundless {
 		commandBuffer->draw( 3, 1, 0, 0 );
 
 		EndRendering( commandBuffer, device );
-		AddExitBarriers( commandBuffer, device );
 	}
 
 	// -------------------
@@ -231,6 +269,317 @@ namespace Boundless {
 		
 	}
 
+	// -----------------
+	// Frustum Cull Pass
+	// -----------------
+	FrustumCullPass::FrustumCullPass() : BaseRenderPass( Viewport(), "Frustum Cull Pass" ) {}
+
+	void FrustumCullPass::CreatePassResources( Device& device ) {
+
+	}
+
+	const std::vector<entt::entity>& FrustumCullPass::Dispatch( Scene& scene, const Camera& camera ) {
+		auto& registry = scene.GetRegistry();
+
+		m_Boxes.Clear();
+		m_Entities.clear();
+		m_VisibleIds.clear();
+		m_VisibleEntities.clear();
+
+		auto view = registry.view<Mesh, Transform>();
+		for ( auto [ entity, mesh, transform ] : view.each() ) {
+			if ( mesh.m_Indices.empty() )
+				continue;
+
+			// Skinned meshes can animate outside of their bind pose bounds, always draw them.
+			if ( !mesh.m_WorldBounds.IsValid() || mesh.m_SkinnedGeometry.IsValid() ) {
+				m_VisibleEntities.push_back( entity );
+				continue;
+			}
+
+			m_Boxes.Add( mesh.m_WorldBounds.GetCenter(), mesh.m_WorldBounds.GetExtents(), uint32_t( m_Entities.size() ) );
+			m_Entities.push_back( entity );
+		}
+
+		m_Boxes.Pad();
+
+		FrustumCullBoxes( Frustum::FromMatrix( camera.GetViewProjectionMatrix() ), m_Boxes, m_VisibleIds );
+
+		for ( uint32_t id : m_VisibleIds )
+			m_VisibleEntities.push_back( m_Entities[ id ] );
+
+		return m_VisibleEntities;
+	}
+
+	// -----------------------
+	// Software Occlusion Pass
+	// -----------------------
+	SoftwareOcclusionPass::SoftwareOcclusionPass() : BaseRenderPass( Viewport(), "Software Occlusion Pass" ) {}
+
+	void SoftwareOcclusionPass::CreatePassResources( Device& device ) {
+
+	}
+
+	const std::vector<entt::entity>& SoftwareOcclusionPass::Dispatch( Scene& scene, const Camera& camera, const std::vector<entt::entity>& visibleEntities, ThreadPool& threadPool ) {
+		auto& registry = scene.GetRegistry();
+
+		m_Boxes.Clear();
+		m_Entities.clear();
+		m_VisibleIds.clear();
+		m_VisibleEntities.clear();
+
+		glm::vec3 cameraPosition = camera.GetInvViewMatrix()[ 3 ];
+
+		// Alpha tested and blended surfaces have holes or show what's behind them, they can't be drawn as solid depth.
+		m_OpaqueMaterials.clear();
+		for ( entt::entity entity : registry.view<Material>() ) {
+			const Material& material = registry.get<Material>( entity );
+			const size_t index = size_t( material.m_Index );
+
+			if ( index >= m_OpaqueMaterials.size() )
+				m_OpaqueMaterials.resize( index + 1, false );
+
+			m_OpaqueMaterials[ index ] = material.m_AlphaMode == EAlphaMode::Opaque;
+		}
+
+		// Score occluders by their approximate projected size.
+		std::vector<std::pair<float, entt::entity>> occluders;
+
+		for ( entt::entity entity : visibleEntities ) {
+			const Mesh& mesh = registry.get<Mesh>( entity );
+
+			if ( !mesh.m_WorldBounds.IsValid() || mesh.m_SkinnedGeometry.IsValid() ) {
+				m_VisibleEntities.push_back( entity );
+				continue;
+			}
+
+			// Still tested as an occludee either way.
+			if ( mesh.m_Material < m_OpaqueMaterials.size() && m_OpaqueMaterials[ mesh.m_Material ] ) {
+				const glm::vec4& sphere = mesh.m_WorldBounds.m_Sphere;
+				float distance = std::max( glm::length( glm::vec3( sphere ) - cameraPosition ), 1e-3f );
+				occluders.emplace_back( sphere.w / distance, entity );
+			}
+
+			m_Boxes.Add( mesh.m_WorldBounds.GetCenter(), mesh.m_WorldBounds.GetExtents(), uint32_t( m_Entities.size() ) );
+			m_Entities.push_back( entity );
+		}
+
+		m_Boxes.Pad();
+
+		size_t occluderCount = std::min( occluders.size(), MaxOccluders );
+		std::partial_sort( occluders.begin(), occluders.begin() + occluderCount, occluders.end(), std::greater<>() );
+
+		m_Occlusion.Begin( camera.GetViewProjectionMatrix() );
+
+		for ( size_t i = 0; i < occluderCount; i++ ) {
+			entt::entity entity = occluders[ i ].second;
+			const Mesh& mesh = registry.get<Mesh>( entity );
+
+			m_Occlusion.AddOccluder( mesh.m_Positions, mesh.m_Indices, registry.get<Transform>( entity ).m_WorldTransform );
+		}
+
+		m_Occlusion.Rasterize( &threadPool );
+		m_Occlusion.TestBoxes( m_Boxes, m_VisibleIds, &threadPool );
+
+		for ( uint32_t id : m_VisibleIds )
+			m_VisibleEntities.push_back( m_Entities[ id ] );
+
+		return m_VisibleEntities;
+	}
+
+	// -------------
+	// GPU Cull Pass
+	// -------------
+	GPUCullPass::GPUCullPass() : BaseRenderPass( Viewport(), "GPU Cull Pass" ) {}
+
+	void GPUCullPass::CreatePassResources( Device& device ) {
+		m_Pipeline = m_ComputePipelineBuilder.SetPipelineLayout( device.GetGlobalPipelineLayout() )
+			.SetShaderBlob( { g_EngineShaders.CullShader, vk::ShaderStageFlagBits::eCompute } )
+			.Build( device );
+
+		m_DrawCountBuffer = device.CreateBuffer( Buffer::Desc{
+				.m_Size = 2 * sizeof( uint32_t ), // Early & late draw counts.
+				.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Pool = EMemoryPool::Scratch
+			} );
+
+		if ( m_DrawCountBuffer == BufferHandle::Invalid )
+			printf( "[GPUCullPass] Failed to allocate the draw count buffer, nothing will be drawn\n" );
+	}
+
+	GPUCullOutput GPUCullPass::Dispatch( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene, ECullPhase phase, const HiZOutput& hiZ ) {
+		uint32_t instanceCount = scene.GetInstanceCount();
+		bool isLate = phase == ECullPhase::Late;
+
+		// Nothing to cull into, or the late phase without the early phase's buffers or a Hi-Z to test against.
+		const bool missingBuffers = m_DrawCountBuffer == BufferHandle::Invalid || ( isLate && ( m_DrawCommandsBuffer == BufferHandle::Invalid || hiZ.m_Buffer == BufferHandle::Invalid ) );
+		if ( instanceCount == 0 || missingBuffers )
+			return GPUCullOutput{ m_DrawCommandsBuffer, 0, m_DrawCountBuffer, 0, 0 };
+
+		// The late phase reuses the buffers set up by the early phase this frame.
+		if ( !isLate ) {
+			// Wait for last frame's draws & visibility writes before touching the buffers again.
+			commandBuffer.StageBarrier( 
+				vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eShaderWrite, 
+				vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite 
+			);
+
+			if ( instanceCount > m_MaxDrawCount ) {
+				if ( m_DrawCommandsBuffer != BufferHandle::Invalid )
+					device.ReleaseBuffer( m_DrawCommandsBuffer );
+
+				if ( m_VisibilityBuffer != BufferHandle::Invalid )
+					device.ReleaseBuffer( m_VisibilityBuffer );
+
+				m_DrawCommandsBuffer = device.CreateBuffer( Buffer::Desc{
+						.m_Size = 2 * instanceCount * sizeof( vk::DrawIndexedIndirectCommand ),
+						.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+						.m_Pool = EMemoryPool::Scratch
+					} );
+
+				m_VisibilityBuffer = device.CreateBuffer( Buffer::Desc{
+						.m_Size = instanceCount * sizeof( uint32_t ),
+						.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+						.m_Pool = EMemoryPool::Scratch
+					} );
+
+				// Skip the frame's culling and drawing, the next frame tries again.
+				if ( m_DrawCommandsBuffer == BufferHandle::Invalid || m_VisibilityBuffer == BufferHandle::Invalid ) {
+					printf( "[GPUCullPass] Failed to allocate the draw buffers for %u instances\n", instanceCount );
+
+					if ( m_DrawCommandsBuffer != BufferHandle::Invalid )
+						device.ReleaseBuffer( m_DrawCommandsBuffer );
+
+					if ( m_VisibilityBuffer != BufferHandle::Invalid )
+						device.ReleaseBuffer( m_VisibilityBuffer );
+
+					m_DrawCommandsBuffer = BufferHandle::Invalid;
+					m_VisibilityBuffer = BufferHandle::Invalid;
+					m_MaxDrawCount = 0;
+					return GPUCullOutput{ m_DrawCommandsBuffer, 0, m_DrawCountBuffer, 0, 0 };
+				}
+
+				// Nothing was visible last frame, the late phase will draw everything that passes.
+				commandBuffer->fillBuffer( device.GetBuffer( m_VisibilityBuffer ), 0, vk::WholeSize, 0 );
+
+				m_MaxDrawCount = instanceCount;
+			}
+
+			commandBuffer->fillBuffer( device.GetBuffer( m_DrawCountBuffer ), 0, vk::WholeSize, 0 );
+			commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite );
+		}
+
+		GPUCullOutput output = {
+			.m_DrawCommands = m_DrawCommandsBuffer,
+			.m_DrawCommandsOffset = isLate ? m_MaxDrawCount * sizeof( vk::DrawIndexedIndirectCommand ) : 0,
+			.m_DrawCount = m_DrawCountBuffer,
+			.m_DrawCountOffset = isLate ? sizeof( uint32_t ) : 0,
+			.m_MaxDrawCount = instanceCount,
+		};
+
+		CullPushConstants pc = {
+			.m_FrameConstantsBuffer = device.GetBuffer( frameConstantsBuffer ).GetDeviceAddress(),
+			.m_InstancesBuffer = device.GetBuffer( scene.GetInstanceBuffer() ).GetDeviceAddress(),
+			.m_DrawCommandsBuffer = device.GetBufferBindlessIndex( m_DrawCommandsBuffer ),
+			.m_DrawCommandsOffset = uint32_t( output.m_DrawCommandsOffset ),
+			.m_DrawCountBuffer = device.GetBufferBindlessIndex( m_DrawCountBuffer ),
+			.m_DrawCountOffset = uint32_t( output.m_DrawCountOffset ),
+			.m_InstanceCount = instanceCount,
+			.m_Phase = uint32_t( phase ),
+			.m_VisibilityBuffer = device.GetBufferBindlessIndex( m_VisibilityBuffer ),
+			.m_HiZBuffer = device.GetBufferBindlessIndex( hiZ.m_Buffer ),
+			.m_HiZMipCount = hiZ.m_MipCount,
+			.m_HiZWidth = hiZ.m_Width,
+			.m_HiZHeight = hiZ.m_Height,
+		};
+
+		commandBuffer.BindComputePipeline( m_Pipeline );
+		commandBuffer.BindPushConstants( device, &pc, sizeof( pc ) );
+		commandBuffer->dispatch( ( instanceCount + 63 ) / 64, 1, 1 );
+
+		// Also covers the skinning writes read by the GBuffer vertex shader.
+		commandBuffer.StageBarrier( 
+			vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderWrite, 
+			vk::PipelineStageFlagBits2::eDrawIndirect | vk::PipelineStageFlagBits2::eVertexShader, vk::AccessFlagBits2::eIndirectCommandRead | vk::AccessFlagBits2::eShaderRead 
+		);
+
+		return output;
+	}
+
+	// ----------
+	// Hi-Z Pass
+	// ----------
+	HiZPass::HiZPass( const Viewport& viewport ) : BaseRenderPass( viewport, "HiZ Pass" ) {}
+
+	vk::Extent2D HiZPass::GetMipSize( vk::Extent2D depthSize, uint32_t mip ) {
+		uint32_t divisor = 2u << mip;
+		return vk::Extent2D{ std::max( ( depthSize.width + divisor - 1 ) / divisor, 1u ), std::max( ( depthSize.height + divisor - 1 ) / divisor, 1u ) };
+	}
+
+	void HiZPass::CreatePassResources( Device& device ) {
+		m_Pipeline = m_ComputePipelineBuilder.SetPipelineLayout( device.GetGlobalPipelineLayout() )
+			.SetShaderBlob( { g_EngineShaders.HiZShader, vk::ShaderStageFlagBits::eCompute } )
+			.Build( device );
+
+		vk::DeviceSize bufferSize = HeaderSize;
+		vk::Extent2D   mipSize = {};
+
+		m_MipCount = 0;
+		do {
+			mipSize = GetMipSize( m_Viewport.Size, m_MipCount++ );
+			bufferSize += mipSize.width * mipSize.height * sizeof( float );
+		} while ( mipSize.width > 1 || mipSize.height > 1 );
+
+		if ( m_HiZBuffer != BufferHandle::Invalid )
+			device.ReleaseBuffer( m_HiZBuffer );
+
+		m_HiZBuffer = device.CreateBuffer( Buffer::Desc{
+				.m_Size = bufferSize,
+				.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Pool = EMemoryPool::Scratch,
+				.m_Category = EMemoryCategory::RenderTargets
+			} );
+
+		if ( m_HiZBuffer == BufferHandle::Invalid )
+			printf( "[HiZPass] Failed to allocate the %llu byte Hi-Z buffer, occlusion culling is skipped\n", bufferSize );
+	}
+
+	HiZOutput HiZPass::Dispatch( CommandBuffer& commandBuffer, Device& device, ImageHandle depthTexture ) {
+		// Invalid output, the late cull phase skips itself.
+		if ( m_HiZBuffer == BufferHandle::Invalid )
+			return HiZOutput{};
+
+		const vk::Extent2D& depthSize = m_Viewport.Size;
+		uint32_t groupsX = ( depthSize.width + 63 ) / 64;
+		uint32_t groupsY = ( depthSize.height + 63 ) / 64;
+
+		// Reset the workgroup counter once the previous readers are done.
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite );
+		commandBuffer->fillBuffer( device.GetBuffer( m_HiZBuffer ), 0, HeaderSize, 0 );
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite );
+
+		HiZPushConstants pc = {
+			.m_DepthTexture = device.GetImageBindlessIndex( depthTexture ),
+			.m_HiZBuffer = device.GetBufferBindlessIndex( m_HiZBuffer ),
+			.m_DepthWidth = depthSize.width,
+			.m_DepthHeight = depthSize.height,
+			.m_MipCount = m_MipCount,
+			.m_GroupCount = groupsX * groupsY,
+		};
+
+		commandBuffer.BindComputePipeline( m_Pipeline );
+		commandBuffer.BindPushConstants( device, &pc, sizeof( pc ) );
+		commandBuffer->dispatch( groupsX, groupsY, 1 );
+
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderWrite, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderRead );
+
+		return HiZOutput{ m_HiZBuffer, m_MipCount, depthSize.width, depthSize.height };
+	}
+
 	// -------------
 	// Skinning Pass
 	// -------------
@@ -244,37 +593,55 @@ namespace Boundless {
 
 	void SkinningPass::Dispatch( CommandBuffer& commandBuffer, Device& device, Scene& scene ) { 
 		auto& registry = scene.GetRegistry();
+		const GeometryPool& geometryPool = scene.GetGeometryPool();
 
-		auto view = registry.view<Mesh>();
-		for( auto [ entity, mesh ] : view.each() ) {
-			if ( !registry.valid( mesh.m_Skeleton ) || !registry.all_of<Skeleton>( mesh.m_Skeleton ) )
-				continue;
+		auto getSkeleton = [ & ]( const Mesh& mesh ) -> Skeleton* {
+			if ( !registry.valid( mesh.m_Skeleton ) || !registry.all_of<Skeleton>( mesh.m_Skeleton ) || !mesh.m_SkinnedGeometry.IsValid() )
+				return nullptr;
 
 			Skeleton& skeleton = registry.get<Skeleton>( mesh.m_Skeleton );
+			return skeleton.m_BoneTransformsBuffer != BufferHandle::Invalid ? &skeleton : nullptr;
+		};
+
+		// Meshes share skeletons, every palette is uploaded once with one barrier pair around all of the copies.
+		m_Skeletons.clear();
+		for ( auto [ entity, mesh ] : registry.view<Mesh>().each() ) {
+			if ( getSkeleton( mesh ) && std::find( m_Skeletons.begin(), m_Skeletons.end(), mesh.m_Skeleton ) == m_Skeletons.end() )
+				m_Skeletons.push_back( mesh.m_Skeleton );
+		}
 
-			// Upload bone matrix data.
-			Buffer& boneMatrixBuffer = device.GetBuffer( skeleton.m_BoneTransformsBuffer );
+		if ( m_Skeletons.empty() )
+			return;
 
-			glm::mat4* boneMatricesData = skeleton.m_BoneTransformMatrices.data();
-			size_t boneMatricesSize = skeleton.m_BoneTransformMatrices.size() * sizeof( glm::mat4 );
+		// Earlier frames in flight may still be reading the previous palettes.
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eUniformRead, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite );
 
-			std::unique_ptr<StagingBuffer> stagingBuffer = device.CreateStagingBuffer( boneMatricesSize );
-			stagingBuffer->Patch( boneMatricesData, boneMatricesSize );
+		for ( entt::entity entity : m_Skeletons ) {
+			const Skeleton& skeleton = registry.get<Skeleton>( entity );
+			device.UploadBuffer( commandBuffer, device.GetBuffer( skeleton.m_BoneTransformsBuffer ), skeleton.m_BoneTransformMatrices.data(), skeleton.m_BoneTransformMatrices.size() * sizeof( glm::mat4 ) );
+		}
+
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eComputeShader, vk::AccessFlagBits2::eShaderRead );
+		commandBuffer.BindComputePipeline( m_Pipeline );
 
-			commandBuffer.CopyBuffer( *stagingBuffer, boneMatrixBuffer, boneMatricesSize );
+		for ( auto [ entity, mesh ] : registry.view<Mesh>().each() ) {
+			const Skeleton* skeleton = getSkeleton( mesh );
+			if ( !skeleton )
+				continue;
 
 			SkinningPushConstants pc = {
-				.m_VertexBuffer = device.GetBuffer( mesh.m_VertexBuffer ).GetDeviceAddress(),
-				.m_SkinnedVertexBuffer = device.GetBuffer( mesh.m_SkinnedVertexBuffer ).GetDeviceAddress(),
+				.m_VertexBuffer = geometryPool.GetVertexAddress( device, mesh.m_Geometry ),
+				.m_SkinnedVertexBuffer = geometryPool.GetVertexAddress( device, mesh.m_SkinnedGeometry ),
 				.m_BoneIndicesBuffer = device.GetBuffer( mesh.m_BoneIndexBuffer ).GetDeviceAddress(),
 				.m_BoneWeightsBuffer = device.GetBuffer( mesh.m_BoneWeightBuffer ).GetDeviceAddress(),
-				.m_BoneTransformsBuffer = device.GetBuffer( skeleton.m_BoneTransformsBuffer ).GetDeviceAddress(),
+				.m_BoneTransformsBuffer = device.GetBuffer( skeleton->m_BoneTransformsBuffer ).GetDeviceAddress(),
 				.m_VertexCount = uint32_t( mesh.m_Positions.size() ),
 			};
 			
-			commandBuffer.BindComputePipeline( m_Pipeline );
 			commandBuffer.BindPushConstants( device, &pc, sizeof( pc ) );
-			commandBuffer->dispatch( uint32_t( mesh.m_Positions.size() + 63  / 64 ), 1, 1 );
+
+			// Skinned vertices are packed next to other meshes in the geometry pool, don't overshoot.
+			commandBuffer->dispatch( ( uint32_t( mesh.m_Positions.size() ) + 63 ) / 64, 1, 1 );
 		}
 	}
 }
\ No newline at end of file
@@ -2,15 +2,15 @@
 #include "Scene.hpp"
 #include "Pipelines.hpp"
 #include "BaseRenderPass.hpp"
+#include "Culling.hpp"
+#include "SoftwareOcclusion.hpp"
 
 namespace Boundless {
-	struct alignas( 16 ) GBufferPushConstants {
+	struct GBufferPushConstants {
 		vk::DeviceAddress m_FrameConstantsBuffer;
 		vk::DeviceAddress m_MaterialsBuffer;
-		vk::DeviceAddress m_VertexBuffer;
-		uint8_t           m_Pad0[8];
-		glm::mat4		  m_WorldTransform;
-		uint32_t		  m_MaterialIndex;
+		vk::DeviceAddress m_InstancesBuffer;
+		vk::DeviceAddress m_TextureTableBuffer;
 	};
 
 	struct GBufferDebugPushConstants {
@@ -44,17 +44,73 @@ namespace Boundless {
 		uint32_t		  m_VertexCount;
 	};
 
+	struct CullPushConstants {
+		vk::DeviceAddress m_FrameConstantsBuffer;
+		vk::DeviceAddress m_InstancesBuffer;
+		uint32_t		  m_DrawCommandsBuffer;
+		uint32_t		  m_DrawCommandsOffset;
+		uint32_t		  m_DrawCountBuffer;
+		uint32_t		  m_DrawCountOffset;
+		uint32_t		  m_InstanceCount;
+		uint32_t		  m_Phase;
+		uint32_t		  m_VisibilityBuffer;
+		uint32_t		  m_HiZBuffer;
+		uint32_t		  m_HiZMipCount;
+		uint32_t		  m_HiZWidth;
+		uint32_t		  m_HiZHeight;
+	};
+
+	struct HiZPushConstants {
+		uint32_t m_DepthTexture;
+		uint32_t m_HiZBuffer;
+		uint32_t m_DepthWidth;
+		uint32_t m_DepthHeight;
+		uint32_t m_MipCount;
+		uint32_t m_GroupCount;
+	};
+
+	// Views of the GBuffer targets, rendered to by GBufferPass and sampled by the passes after it.
 	struct GBufferOutput {
 		ImageHandle m_GBuffer;
 		ImageHandle m_DepthBuffer;
 	};
 
+	struct GPUCullOutput {
+		BufferHandle   m_DrawCommands;
+		vk::DeviceSize m_DrawCommandsOffset;
+		BufferHandle   m_DrawCount;
+		vk::DeviceSize m_DrawCountOffset;
+		uint32_t	   m_MaxDrawCount;
+	};
+
+	struct HiZOutput {
+		BufferHandle m_Buffer = BufferHandle::Invalid;
+		uint32_t	 m_MipCount = 0;
+		uint32_t	 m_Width = 0;
+		uint32_t	 m_Height = 0;
+	};
+
+	// Must match CULL_PHASE_* in Types.hlsli.
+	enum class ECullPhase : uint32_t {
+		FrustumOnly,
+		Early,
+		Late
+	};
+
 	class GBufferPass : public BaseRenderPass {
 	public:
 		GBufferPass( const Viewport& viewport );
 		
 		virtual void CreatePassResources( Device& device ) override;
-		[[nodiscard]] GBufferOutput Render( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene );
+		// Large draw lists are split into chunks recorded in parallel on threadPool, each into a secondary command buffer.
+		void Render( CommandBuffer& commandBuffer, Device& device, const GBufferOutput& targets, BufferHandle frameConstantsBuffer, Scene& scene, const std::vector<entt::entity>& visibleEntities, ThreadPool& threadPool );
+		void RenderIndirect( CommandBuffer& commandBuffer, Device& device, const GBufferOutput& targets, BufferHandle frameConstantsBuffer, Scene& scene, const GPUCullOutput& cullOutput, bool clear = true );
+	private:
+		// Below this a chunk costs more to set up and execute than recording it on the calling thread.
+		constexpr static const uint32_t MinDrawsPerChunk = 256u;
+
+		void BindSceneData( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene );
+		void RecordDraws( CommandBuffer& commandBuffer, const Scene& scene, const std::vector<entt::entity>& visibleEntities, uint32_t begin, uint32_t end );
 	};
 
 	class GBufferDebugPass : public BaseRenderPass {
@@ -62,7 +118,7 @@ namespace Boundless {
 		GBufferDebugPass( const Viewport& viewport );
 
 		virtual void CreatePassResources( Device& device ) override;
-		void Render( CommandBuffer& commandBuffer, Device& device, ImageHandle gbufferTexture, ImageHandle depthTexture, uint32_t channelIndex );
+		void Render( CommandBuffer& commandBuffer, Device& device, ImageHandle target, ImageHandle gbufferTexture, ImageHandle depthTexture, uint32_t channelIndex );
 	};
 
 	class LightingPass : public BaseRenderPass {
@@ -70,7 +126,7 @@ namespace Boundless {
 		LightingPass( const Viewport& viewport );
 	
 		virtual void CreatePassResources( Device& device ) override;
-		void Render( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene, const GBufferOutput& gbufferOutput );
+		void Render( CommandBuffer& commandBuffer, Device& device, ImageHandle target, BufferHandle frameConstantsBuffer, Scene& scene, const GBufferOutput& gbufferOutput );
 	};
 
 	class CompositePass : public BaseRenderPass {
@@ -78,7 +134,7 @@ namespace Boundless {
 		CompositePass( const Viewport& viewport );
 
 		virtual void CreatePassResources( Device& device ) override;
-		void Render( CommandBuffer& commandBuffer, Device& device, ImageHandle texture );
+		void Render( CommandBuffer& commandBuffer, Device& device, ImageHandle target, ImageHandle texture );
 	};
 
 	class RaytracedReflectionsPass : public BaseRenderPass {
@@ -89,11 +145,74 @@ namespace Boundless {
 		void Dispatch( CommandBuffer& commandBuffer, Device& device );
 	};
 
-	// TODO: maybe switch the scene rendering to use DrawIndirect? 
-	// Alternative build a buffer with a 1:3 bitfield [draw, entityIndex]
+	// CPU frustum culling, produces the compact list of mesh entities the GBuffer draws.
 	class FrustumCullPass : public BaseRenderPass {
 	public:
+		FrustumCullPass();
+
+		virtual void CreatePassResources( Device& device ) override;
+		const std::vector<entt::entity>& Dispatch( Scene& scene, const Camera& camera );
+
+		size_t GetTestedCount() const { return m_Boxes.m_ValidCount; }
+		size_t GetVisibleCount() const { return m_VisibleEntities.size(); }
+	private:
+		CullBoxes				  m_Boxes;
+		std::vector<entt::entity> m_Entities;
+		std::vector<uint32_t>	  m_VisibleIds;
+		std::vector<entt::entity> m_VisibleEntities;
+	};
+
+	// CPU occlusion culling for the CPU culling path. Rasterizes the largest visible opaque meshes into a
+	// low resolution depth buffer on the worker threads and drops everything hidden behind them.
+	class SoftwareOcclusionPass : public BaseRenderPass {
+	public:
+		SoftwareOcclusionPass();
+
+		virtual void CreatePassResources( Device& device ) override;
+		const std::vector<entt::entity>& Dispatch( Scene& scene, const Camera& camera, const std::vector<entt::entity>& visibleEntities, ThreadPool& threadPool );
+
+		const OcclusionStats& GetStats() const { return m_Occlusion.GetStats(); }
+	private:
+		constexpr static const size_t MaxOccluders = 32;
+
+		SoftwareOcclusion		  m_Occlusion;
+		CullBoxes				  m_Boxes;
+		std::vector<entt::entity> m_Entities;
+		std::vector<uint32_t>	  m_VisibleIds;
+		std::vector<entt::entity> m_VisibleEntities;
+		std::vector<bool>		  m_OpaqueMaterials; // By material index, only opaque meshes occlude.
+	};
+
+	// GPU frustum & occlusion culling, writes one indirect draw per visible instance and the draw count.
+	// Early and late phases write to separate halves of the draw buffers so both can be in flight.
+	class GPUCullPass : public BaseRenderPass {
+	public:
+		GPUCullPass();
+
+		virtual void CreatePassResources( Device& device ) override;
+		[[nodiscard]] GPUCullOutput Dispatch( CommandBuffer& commandBuffer, Device& device, BufferHandle frameConstantsBuffer, Scene& scene, ECullPhase phase, const HiZOutput& hiZ = {} );
+	private:
+		BufferHandle m_DrawCommandsBuffer = BufferHandle::Invalid;
+		BufferHandle m_DrawCountBuffer = BufferHandle::Invalid;
+		BufferHandle m_VisibilityBuffer = BufferHandle::Invalid; // One uint per instance, visible last frame.
+		uint32_t	 m_MaxDrawCount = 0;
+	};
+
+	// Builds a max depth pyramid from a depth buffer in a single compute dispatch, stored in a storage buffer.
+	class HiZPass : public BaseRenderPass {
+	public:
+		HiZPass( const Viewport& viewport );
+
+		virtual void CreatePassResources( Device& device ) override;
+		[[nodiscard]] HiZOutput Dispatch( CommandBuffer& commandBuffer, Device& device, ImageHandle depthTexture );
+
+		// Mirrors HiZMipSize in HiZ.hlsli.
+		static vk::Extent2D GetMipSize( vk::Extent2D depthSize, uint32_t mip );
+	private:
+		constexpr static const vk::DeviceSize HeaderSize = 16;
 
+		BufferHandle m_HiZBuffer = BufferHandle::Invalid;
+		uint32_t	 m_MipCount = 0;
 	};
 
 	class SkinningPass : public BaseRenderPass {
@@ -102,6 +221,8 @@ namespace Boundless {
 
 		virtual void CreatePassResources( Device& device ) override;
 		void Dispatch( CommandBuffer& commandBuffer, Device& device, Scene& scene );
+	private:
+		std::vector<entt::entity> m_Skeletons; // Uploaded this frame.
 	};
 
 	class BloomPass : public BaseRenderPass {
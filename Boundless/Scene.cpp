@@ -8,162 +8,194 @@ namespace Boundless {
 		m_Registry.emplace<Transform>( m_RootEntity );
 		m_Registry.emplace<EntityRelation>( m_RootEntity );
 		m_Registry.emplace<EntityTag>( m_RootEntity, "Root Entity" );
+
+		m_Registry.on_destroy<Material>().connect<&Scene::OnMaterialDestroyed>( *this );
+	}
+
+	void Scene::OnMaterialDestroyed( entt::registry& registry, entt::entity entity ) {
+		if ( !m_TextureLoader )
+			return;
+
+		const Material& mat = registry.get<Material>( entity );
+		m_TextureLoader->Release( mat.m_AlbedoTexture );
+		m_TextureLoader->Release( mat.m_NormalsTexture );
+		m_TextureLoader->Release( mat.m_MetalRoughnessTexture );
+		m_TextureLoader->Release( mat.m_EmissiveTexture );
+	}
+
+	void Scene::ReplaceRegistry( entt::registry&& registry, entt::entity rootEntity ) {
+		// Moving over the registry destroys the old components without signals, clear them first so OnMaterialDestroyed runs.
+		m_Registry.clear<Material>();
+
+		// Materials hold the only texture references, none may be left once they are gone.
+		if ( m_TextureLoader && m_TextureLoader->PrintReferenced() > 0 )
+			printf( "[Scene] Textures still referenced after releasing the scene's materials\n" );
+
+		m_Registry = std::move( registry );
+		m_RootEntity = rootEntity;
+
+		// The hook was connected to the old registry's signals, which went with it.
+		m_Registry.on_destroy<Material>().connect<&Scene::OnMaterialDestroyed>( *this );
 	}
 
-	void Scene::UploadToGPU( Device& device ) { 
-		UploadMeshes( device );
+	void Scene::UploadToGPU( Device& device, TextureLoader& textureLoader ) { 
+		// Geometry, BLAS builds and materials share one submit.
+		UploadBatch batch = UploadBatch( device );
+
+		UploadMeshes( device, batch );
 		UploadTLAS( device );
-		UploadTextures( device );
-		UploadMaterials( device );
+		m_TextureLoader = &textureLoader;
+		UploadTextures( textureLoader );
+		UploadMaterials( device, batch );
 		UploadSkeletons( device );
+		UploadInstances( device );
+
+		batch.Submit();
 	}
 	
-	void Scene::UploadMeshes( Device& device ) { 
-		for ( entt::entity entity : m_Registry.view<Mesh>() ) {
-			Mesh& mesh = m_Registry.get<Mesh>( entity );
+	static vk::DeviceAddress AlignUp( vk::DeviceAddress address, vk::DeviceSize alignment ) {
+		return ( address + alignment - 1 ) / alignment * alignment;
+	}
 
-			if ( mesh.m_VertexBuffer == BufferHandle::Invalid ) {
-				mesh.m_VertexBuffer = device.CreateBuffer(
-					Buffer::Desc{
-						.m_Size = mesh.m_Vertices.size() * sizeof( MeshVertexData ),
-						.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
-					}
-				);
+	static vk::AccelerationStructureBuildGeometryInfoKHR GetBlasBuildInfo( const vk::AccelerationStructureGeometryKHR& geometry ) {
+		vk::AccelerationStructureBuildGeometryInfoKHR buildInfo = {};
+		buildInfo.setType( vk::AccelerationStructureTypeKHR::eBottomLevel )
+			.setFlags( vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace | vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate )
+			.setMode( vk::BuildAccelerationStructureModeKHR::eBuild )
+			.setGeometryCount( 1 )
+			.setPGeometries( &geometry );
+
+		return buildInfo;
+	}
+
+	void Scene::UploadMeshes( Device& device, UploadBatch& batch ) { 
+		// Size the pool for everything loaded so far, the defaults leave headroom for meshes added later.
+		if ( !m_GeometryPool.IsCreated() ) {
+			uint64_t vertexCount = 0;
+			uint64_t indexCount = 0;
+
+			for ( auto [ entity, mesh ] : m_Registry.view<Mesh>().each() ) {
+				vertexCount += mesh.m_Vertices.size();
+				indexCount += mesh.m_Indices.size();
+
+				if ( !mesh.m_BoneWeights.empty() && !mesh.m_BoneIndices.empty() )
+					vertexCount += mesh.m_Vertices.size();
 			}
 
-			if ( mesh.m_IndexBuffer == BufferHandle::Invalid && !mesh.m_Indices.empty() ) {
-				mesh.m_IndexBuffer = device.CreateBuffer(
-					Buffer::Desc{
-						.m_Size = mesh.m_Indices.size() * sizeof( uint32_t ),
-						.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
-					}
-				);
+			GeometryPool::Desc desc = { .m_VertexStride = sizeof( MeshVertexData ) };
+			desc.m_MaxVertices = std::max( desc.m_MaxVertices, uint32_t( vertexCount ) );
+			desc.m_MaxIndices = std::max( desc.m_MaxIndices, uint32_t( indexCount ) );
+
+			m_GeometryPool.Create( device, desc );
+		}
+
+		for ( entt::entity entity : m_Registry.view<Mesh>() ) {
+			Mesh& mesh = m_Registry.get<Mesh>( entity );
+
+			if ( !mesh.m_Geometry.IsValid() ) {
+				mesh.m_Geometry = m_GeometryPool.Allocate( uint32_t( mesh.m_Vertices.size() ), uint32_t( mesh.m_Indices.size() ) );
+				m_GeometryPool.Upload( device, batch, mesh.m_Geometry, mesh.m_Vertices.data(), mesh.m_Indices.data() );
 			}
 
 			if ( !mesh.m_BoneIndices.empty() ) {
 				mesh.m_BoneIndexBuffer = device.CreateBuffer( Buffer::Desc{
 						.m_Size = uint32_t( mesh.m_BoneIndices.size() * sizeof( glm::uvec4 ) ),
 						.m_Usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+						.m_Pool = EMemoryPool::Geometry,
+						.m_Category = EMemoryCategory::Geometry,
+						.m_HostWrite = true
 					} 
 				);
 
-				Buffer& boneIndexBuffer = device.GetBuffer( mesh.m_BoneIndexBuffer );
-
-				size_t bufferSize = mesh.m_BoneIndices.size() * sizeof( glm::uvec4 );
-				std::unique_ptr<StagingBuffer> stagingBuffer = device.CreateStagingBuffer( bufferSize );
-				stagingBuffer->Patch( mesh.m_BoneIndices.data(), bufferSize );
-
-				// TOOD: fix mem leak.
-				CommandBuffer commandBuffer = CommandBuffer( device );
-				commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-				commandBuffer.CopyBuffer( *stagingBuffer, boneIndexBuffer, bufferSize );
-				commandBuffer.End();
-				commandBuffer.Submit( device.GetQueue() );
+				if ( mesh.m_BoneIndexBuffer != BufferHandle::Invalid ) {
+					size_t bufferSize = mesh.m_BoneIndices.size() * sizeof( glm::uvec4 );
+					batch.UploadBuffer( device.GetBuffer( mesh.m_BoneIndexBuffer ), mesh.m_BoneIndices.data(), bufferSize );
+				} else {
+					printf( "[Scene] Failed to allocate bone indices, mesh %s is drawn unskinned\n", mesh.m_Name.c_str() );
+				}
 			}
 
 			if ( !mesh.m_BoneWeights.empty() ) {
 				mesh.m_BoneWeightBuffer = device.CreateBuffer( Buffer::Desc{
 						.m_Size = uint32_t( mesh.m_BoneWeights.size() * sizeof( glm::vec4 ) ),
 						.m_Usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+						.m_Pool = EMemoryPool::Geometry,
+						.m_Category = EMemoryCategory::Geometry,
+						.m_HostWrite = true
 					} 
 				);
 
-				Buffer& boneWeightsBuffer = device.GetBuffer( mesh.m_BoneWeightBuffer );
-
-				size_t bufferSize = mesh.m_BoneWeights.size() * sizeof( glm::vec4 );
-				std::unique_ptr<StagingBuffer> stagingBuffer = device.CreateStagingBuffer( bufferSize );
-				stagingBuffer->Patch( mesh.m_BoneWeights.data(), bufferSize );
-
-				// TOOD: fix mem leak.
-				CommandBuffer commandBuffer = CommandBuffer( device );
-				commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-				commandBuffer.CopyBuffer( *stagingBuffer, boneWeightsBuffer, bufferSize );
-				commandBuffer.End();
-				commandBuffer.Submit( device.GetQueue() );
+				if ( mesh.m_BoneWeightBuffer != BufferHandle::Invalid ) {
+					size_t bufferSize = mesh.m_BoneWeights.size() * sizeof( glm::vec4 );
+					batch.UploadBuffer( device.GetBuffer( mesh.m_BoneWeightBuffer ), mesh.m_BoneWeights.data(), bufferSize );
+				} else {
+					printf( "[Scene] Failed to allocate bone weights, mesh %s is drawn unskinned\n", mesh.m_Name.c_str() );
+				}
 			}
 
-			if ( !mesh.m_BoneWeights.empty() && !mesh.m_BoneIndices.empty() ) {
-				mesh.m_SkinnedVertexBuffer = device.CreateBuffer( Buffer::Desc{
-						.m_Size = mesh.m_Vertices.size() * sizeof( MeshVertexData ),
-						.m_Usage = vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
-					} 
-				);
+			// Without its bone buffers the mesh keeps no skinned copy and SkinningPass skips it.
+			const bool hasBoneBuffers = mesh.m_BoneIndexBuffer != BufferHandle::Invalid && mesh.m_BoneWeightBuffer != BufferHandle::Invalid;
+			if ( hasBoneBuffers && !mesh.m_SkinnedGeometry.IsValid() ) {
+				mesh.m_SkinnedGeometry = m_GeometryPool.Allocate( uint32_t( mesh.m_Vertices.size() ), 0 );
 			}
+		}
 
-			if ( !mesh.m_Indices.empty() ) {
-				Buffer& indexBuffer = device.GetBuffer( mesh.m_IndexBuffer );
-
-				size_t bufferSize = mesh.m_Indices.size() * sizeof( uint32_t );
-				std::unique_ptr<StagingBuffer> stagingBuffer = device.CreateStagingBuffer( bufferSize );
-				stagingBuffer->Patch( mesh.m_Indices.data(), bufferSize );
-
-				CommandBuffer commandBuffer = CommandBuffer( device );
-				commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-				commandBuffer.CopyBuffer( *stagingBuffer, indexBuffer, bufferSize );
-				commandBuffer.End();
-				commandBuffer.Submit( device.GetQueue() );
-			}
+		// BLAS builds read the geometry copied above.
+		CommandBuffer& commandBuffer = batch.GetCommandBuffer();
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, vk::AccessFlagBits2::eShaderRead );
 
-			{
-				Buffer& vertexBuffer = device.GetBuffer( mesh.m_VertexBuffer );
+		struct BlasBuild {
+			Mesh*									 m_Mesh;
+			vk::AccelerationStructureGeometryKHR	 m_Geometry;
+			uint32_t								 m_PrimitiveCount;
+		};
 
-				size_t bufferSize = mesh.m_Vertices.size() * sizeof( MeshVertexData );
-				std::unique_ptr<StagingBuffer> stagingBuffer = device.CreateStagingBuffer( bufferSize );
-				stagingBuffer->Patch( mesh.m_Vertices.data(), bufferSize );
+		std::vector<BlasBuild> builds;
+		vk::DeviceSize scratchSize = 0;
 
-				CommandBuffer commandBuffer = CommandBuffer( device );
-				commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-				commandBuffer.CopyBuffer( *stagingBuffer, vertexBuffer, bufferSize );
-				commandBuffer.End();
-				commandBuffer.Submit( device.GetQueue() );
-			}
+		for ( entt::entity entity : m_Registry.view<Mesh>() ) {
+			Mesh& mesh = m_Registry.get<Mesh>( entity );
 
 			// Build RT BLAS.
-			if(mesh.m_VertexBuffer != BufferHandle::Invalid && mesh.m_IndexBuffer != BufferHandle::Invalid)
+			if ( mesh.m_Geometry.IsValid() && mesh.m_Geometry.m_IndexCount > 0 && mesh.m_Blas == VK_NULL_HANDLE )
 			{
 				vk::AccelerationStructureGeometryTrianglesDataKHR triangles = {};
 				triangles.vertexFormat = vk::Format::eR32G32B32Sfloat;
-				triangles.vertexData.deviceAddress = device.GetBuffer( mesh.m_VertexBuffer ).GetDeviceAddress();
+				triangles.vertexData.deviceAddress = m_GeometryPool.GetVertexAddress( device, mesh.m_Geometry );
 				triangles.vertexStride = sizeof( MeshVertexData );
 				triangles.maxVertex = uint32_t( mesh.m_Positions.size() - 1 );
 				triangles.indexType = vk::IndexType::eUint32;
-				triangles.indexData.deviceAddress = device.GetBuffer( mesh.m_IndexBuffer ).GetDeviceAddress();
-
-				vk::AccelerationStructureGeometryKHR accelerationStructureGeo = {};
-				accelerationStructureGeo.geometryType = vk::GeometryTypeKHR::eTriangles;
-				accelerationStructureGeo.geometry.triangles = triangles;
+				triangles.indexData.deviceAddress = m_GeometryPool.GetIndexAddress( device, mesh.m_Geometry );
 
-				vk::AccelerationStructureBuildGeometryInfoKHR buildInfo = {};
-				buildInfo.setType( vk::AccelerationStructureTypeKHR::eBottomLevel )
-					.setFlags( vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace | vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate )
-					.setMode( vk::BuildAccelerationStructureModeKHR::eBuild )
-					.setGeometries( { accelerationStructureGeo } );
-
-				uint32_t maxPrimitiveCounts = uint32_t( mesh.m_Indices.size() ) / 3;
+				BlasBuild& build = builds.emplace_back();
+				build.m_Mesh = &mesh;
+				build.m_Geometry.geometryType = vk::GeometryTypeKHR::eTriangles;
+				build.m_Geometry.geometry.triangles = triangles;
+				build.m_PrimitiveCount = uint32_t( mesh.m_Indices.size() ) / 3;
 
+				vk::AccelerationStructureBuildGeometryInfoKHR buildInfo = GetBlasBuildInfo( build.m_Geometry );
 
 				vk::AccelerationStructureBuildSizesInfoKHR sizeInfo 
-					= device->getAccelerationStructureBuildSizesKHR( vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, { maxPrimitiveCounts } );
+					= device->getAccelerationStructureBuildSizesKHR( vk::AccelerationStructureBuildTypeKHR::eDevice, buildInfo, { build.m_PrimitiveCount } );
 
 				mesh.m_BlasBuffer = device.CreateBuffer(
 					Buffer::Desc{
 						.m_Size = sizeInfo.accelerationStructureSize,
 						.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+						.m_Pool = EMemoryPool::Geometry,
+						.m_Category = EMemoryCategory::AccelerationStructures
 					}
 				);
 
-				BufferHandle scratchBuffer = device.CreateBuffer( Buffer::Desc {
-						.m_Size = sizeInfo.buildScratchSize,
-						.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-						.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
-					} 
-				);
+				// The mesh is still drawn, it just isn't in the TLAS.
+				if ( mesh.m_BlasBuffer == BufferHandle::Invalid ) {
+					printf( "[Scene] Failed to allocate the BLAS of mesh %s\n", mesh.m_Name.c_str() );
+					builds.pop_back();
+					continue;
+				}
 
 				vk::AccelerationStructureCreateInfoKHR accelerationInfo = {};
 				accelerationInfo.buffer = device.GetBuffer( mesh.m_BlasBuffer ).GetHandle();
@@ -173,30 +205,62 @@ namespace Boundless {
 
 				mesh.m_Blas = device->createAccelerationStructureKHR( accelerationInfo );
 
-				CommandBuffer commandBuffer = CommandBuffer( device );
-				commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+				scratchSize = std::max( scratchSize, sizeInfo.buildScratchSize );
+			}
+		}
 
-				{
-					buildInfo.scratchData.deviceAddress = device.GetBuffer( scratchBuffer ).GetDeviceAddress();
-					buildInfo.dstAccelerationStructure = mesh.m_Blas;
+		if ( !builds.empty() ) {
+			// One scratch buffer sized for the largest build, shared by all of them. Padded so the builds can start at an
+			// aligned address within it.
+			const vk::DeviceSize scratchAlignment = device.GetScratchOffsetAlignment();
+			BufferHandle scratchBuffer = device.CreateBuffer( Buffer::Desc {
+					.m_Size = scratchSize + scratchAlignment - 1,
+					.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+					.m_Pool = EMemoryPool::Scratch,
+					.m_Category = EMemoryCategory::AccelerationStructures,
+					.m_Bindless = false
+				} 
+			);
+
+			// None of the BLASes can be built, drop them so the next upload retries.
+			if ( scratchBuffer == BufferHandle::Invalid ) {
+				printf( "[Scene] Failed to allocate %llu bytes of BLAS build scratch\n", scratchSize );
+
+				for ( BlasBuild& build : builds ) {
+					device->destroyAccelerationStructureKHR( build.m_Mesh->m_Blas );
+					device.ReleaseBuffer( build.m_Mesh->m_BlasBuffer );
+					build.m_Mesh->m_Blas = VK_NULL_HANDLE;
+					build.m_Mesh->m_BlasBuffer = BufferHandle::Invalid;
+				}
+			} else {
+				const vk::DeviceAddress scratchAddress = AlignUp( device.GetBuffer( scratchBuffer ).GetDeviceAddress(), scratchAlignment );
+				const vk::AccessFlags2 scratchAccess = vk::AccessFlagBits2::eAccelerationStructureReadKHR | vk::AccessFlagBits2::eAccelerationStructureWriteKHR;
+
+				for ( size_t i = 0; i < builds.size(); i++ ) {
+					BlasBuild& build = builds[ i ];
+
+					// The previous build has to be done with the shared scratch memory.
+					if ( i > 0 )
+						commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, scratchAccess, vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, scratchAccess );
+
+					vk::AccelerationStructureBuildGeometryInfoKHR buildInfo = GetBlasBuildInfo( build.m_Geometry );
+					buildInfo.scratchData.deviceAddress = scratchAddress;
+					buildInfo.dstAccelerationStructure = build.m_Mesh->m_Blas;
 
 					vk::AccelerationStructureBuildRangeInfoKHR buildRange = {};
-					buildRange.primitiveCount = maxPrimitiveCounts;
+					buildRange.primitiveCount = build.m_PrimitiveCount;
 
 					commandBuffer->buildAccelerationStructuresKHR( { buildInfo }, { &buildRange } );
-
-					vk::AccessFlags2 accessFlags = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite;
-					commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, accessFlags, vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, accessFlags );
 				}
-				
-				commandBuffer.End();
-				commandBuffer.Submit( device.GetQueue() );
-				
-				// TODO: fixme (device->ReleaseBuffer or something)
-				// Wow this looks ghetto (Technically this is because it wastes a slot in the vector now with garbage data...
-				// delete device->GetBuffer(scratchBuffer);
+
+				device.ReleaseBuffer( scratchBuffer );
 			}
 		}
+
+		// The TLAS build reads the BLASes.
+		vk::AccessFlags2 accessFlags = vk::AccessFlagBits2::eAccelerationStructureReadKHR | vk::AccessFlagBits2::eAccelerationStructureWriteKHR;
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, accessFlags, vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR, accessFlags );
 	}
 
 	// TODO: Update blas for animations & Fix the transforms.
@@ -239,10 +303,17 @@ namespace Boundless {
 				.m_Size = sizeof( vk::AccelerationStructureInstanceKHR ) * RTinstances.size(),
 				.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureBuildInputReadOnlyKHR | vk::BufferUsageFlagBits::eShaderDeviceAddress,
 				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
-				.m_Mappable = true
+				.m_Mappable = true,
+				.m_Category = EMemoryCategory::AccelerationStructures
 			}
 		);
 
+		// Ray traced passes see an empty scene without a TLAS, BuildTLAS skips it.
+		if ( m_TLASInstances == BufferHandle::Invalid ) {
+			printf( "[Scene] Failed to allocate the TLAS instances\n" );
+			return;
+		}
+
 		Buffer& tlasInstanceBuffer = device.GetBuffer( m_TLASInstances );
 		tlasInstanceBuffer.Patch( RTinstances.data(), sizeof( vk::AccelerationStructureInstanceKHR ) * RTinstances.size() );
 		
@@ -266,16 +337,35 @@ namespace Boundless {
 				Buffer::Desc{
 					.m_Size = sizeInfo.accelerationStructureSize,
 					.m_Usage = vk::BufferUsageFlagBits::eAccelerationStructureStorageKHR,
-					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+					.m_Pool = EMemoryPool::Geometry,
+					.m_Category = EMemoryCategory::AccelerationStructures
 				});
 
 			m_TLASScratchBuffer = device.CreateBuffer(
 				Buffer::Desc{
-					.m_Size = std::max( sizeInfo.buildScratchSize, sizeInfo.updateScratchSize ),
+					.m_Size = std::max( sizeInfo.buildScratchSize, sizeInfo.updateScratchSize ) + device.GetScratchOffsetAlignment() - 1,
 					.m_Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+					.m_Pool = EMemoryPool::Scratch,
+					.m_Category = EMemoryCategory::AccelerationStructures,
+					.m_Bindless = false
 				});
 
+			if ( m_TLASBuffer == BufferHandle::Invalid || m_TLASScratchBuffer == BufferHandle::Invalid ) {
+				printf( "[Scene] Failed to allocate the TLAS\n" );
+
+				if ( m_TLASBuffer != BufferHandle::Invalid )
+					device.ReleaseBuffer( m_TLASBuffer );
+
+				if ( m_TLASScratchBuffer != BufferHandle::Invalid )
+					device.ReleaseBuffer( m_TLASScratchBuffer );
+
+				m_TLASBuffer = BufferHandle::Invalid;
+				m_TLASScratchBuffer = BufferHandle::Invalid;
+				return;
+			}
+
 			vk::AccelerationStructureCreateInfoKHR accelerationInfo = {};
 			accelerationInfo.buffer = device.GetBuffer(m_TLASBuffer);
 			accelerationInfo.size = sizeInfo.accelerationStructureSize;
@@ -286,6 +376,9 @@ namespace Boundless {
 	}
 
 	void Scene::BuildTLAS( Device& device, CommandBuffer& commandBuffer ) {
+		if ( m_TLAS == VK_NULL_HANDLE || m_TLASInstances == BufferHandle::Invalid )
+			return;
+
 		Buffer& tlasInstanceBuffer = device.GetBuffer( m_TLASInstances );
 		Buffer& tlasScratchBuffer = device.GetBuffer( m_TLASScratchBuffer );
 
@@ -302,7 +395,7 @@ namespace Boundless {
 		buildInfo.pGeometries = &geometry;
 		buildInfo.srcAccelerationStructure = m_TLAS;
 		buildInfo.dstAccelerationStructure = m_TLAS;
-		buildInfo.scratchData.deviceAddress = tlasScratchBuffer.GetDeviceAddress();
+		buildInfo.scratchData.deviceAddress = AlignUp( tlasScratchBuffer.GetDeviceAddress(), device.GetScratchOffsetAlignment() );
 
 		uint32_t tlasInstancesCount = uint32_t( tlasInstanceBuffer.GetSize() ) / sizeof( vk::AccelerationStructureInstanceKHR );
 		vk::AccelerationStructureBuildRangeInfoKHR buildRange = { tlasInstancesCount };
@@ -327,29 +420,72 @@ namespace Boundless {
 		device->updateDescriptorSets( write, {} );
 	}
 	
-	void Scene::UploadTextures( Device& device ) { 
+	void Scene::UploadTextures( TextureLoader& textureLoader ) { 
+		// Materials hold one reference per texture slot, given back when the material is destroyed.
 		for ( auto ent : m_Registry.view<Material>() ) {
 			Material& mat = m_Registry.get<Material>( ent );
 
-			if ( !mat.m_AlbedoTexturePath.empty() ) {
-				mat.m_AlbedoTexture = device.LoadImageFromFile( mat.m_AlbedoTexturePath, true ).first;
+			if ( !mat.m_AlbedoTexturePath.empty() && mat.m_AlbedoTexture == ImageHandle::Invalid ) {
+				mat.m_AlbedoTexture = textureLoader.Load( mat.m_AlbedoTexturePath, ETextureUsage::Albedo );
 			}
 
-			if ( !mat.m_NormalsTexturePath.empty() ) {
-				mat.m_NormalsTexture = device.LoadImageFromFile( mat.m_NormalsTexturePath, false ).first;
+			if ( !mat.m_NormalsTexturePath.empty() && mat.m_NormalsTexture == ImageHandle::Invalid ) {
+				mat.m_NormalsTexture = textureLoader.Load( mat.m_NormalsTexturePath, ETextureUsage::Normal );
 			}
 
-			if ( !mat.m_MetalRoughnessTexturePath.empty() ) {
-				mat.m_MetalRoughnessTexture = device.LoadImageFromFile( mat.m_MetalRoughnessTexturePath, false ).first;
+			if ( !mat.m_MetalRoughnessTexturePath.empty() && mat.m_MetalRoughnessTexture == ImageHandle::Invalid ) {
+				mat.m_MetalRoughnessTexture = textureLoader.Load( mat.m_MetalRoughnessTexturePath, ETextureUsage::MetalRoughness );
 			}
 
-			if ( !mat.m_EmissiveTexturePath.empty() ) {
-				mat.m_EmissiveTexture = device.LoadImageFromFile( mat.m_EmissiveTexturePath, false ).first;
+			if ( !mat.m_EmissiveTexturePath.empty() && mat.m_EmissiveTexture == ImageHandle::Invalid ) {
+				mat.m_EmissiveTexture = textureLoader.Load( mat.m_EmissiveTexturePath, ETextureUsage::Emissive );
 			}
 		}
 	}
-	
-	void Scene::UploadMaterials( Device& device ) { 
+
+	void Scene::RequestTextureResolutions( const Camera& camera, float viewportHeight ) {
+		if ( !m_TextureLoader )
+			return;
+
+		const glm::vec3 cameraPosition = glm::vec3( camera.GetInvViewMatrix()[ 3 ] );
+		const float projectionScale = camera.GetProjectionMatrix()[ 1 ][ 1 ] * viewportHeight;
+
+		// Largest on screen diameter of any mesh using the material, textures are assumed to be mapped over the whole mesh.
+		std::vector<float> materialPixels;
+		for ( auto [ entity, mesh ] : m_Registry.view<Mesh>().each() ) {
+			if ( mesh.m_Geometry.m_IndexCount == 0 )
+				continue;
+
+			float pixels = viewportHeight;
+			if ( mesh.m_WorldBounds.IsValid() ) {
+				const glm::vec4& sphere = mesh.m_WorldBounds.m_Sphere;
+				const float distance = glm::length( glm::vec3( sphere ) - cameraPosition );
+
+				if ( distance > sphere.w )
+					pixels = std::min( sphere.w * projectionScale / distance, viewportHeight );
+			}
+
+			if ( mesh.m_Material >= materialPixels.size() )
+				materialPixels.resize( mesh.m_Material + 1, 0.f );
+
+			materialPixels[ mesh.m_Material ] = std::max( materialPixels[ mesh.m_Material ], pixels );
+		}
+
+		for ( auto ent : m_Registry.view<Material>() ) {
+			const Material& mat = m_Registry.get<Material>( ent );
+			const uint32_t index = uint32_t( mat.m_Index );
+			if ( index >= materialPixels.size() || materialPixels[ index ] <= 0.f )
+				continue;
+
+			const float pixels = materialPixels[ index ];
+			m_TextureLoader->RequestResolution( mat.m_AlbedoTexture, pixels );
+			m_TextureLoader->RequestResolution( mat.m_NormalsTexture, pixels );
+			m_TextureLoader->RequestResolution( mat.m_MetalRoughnessTexture, pixels );
+			m_TextureLoader->RequestResolution( mat.m_EmissiveTexture, pixels );
+		}
+	}
+
+	std::vector<GPUMaterial> Scene::GatherMaterials( Device& device ) { 
 		std::vector<GPUMaterial> materials{};
 
 		for ( auto ent : m_Registry.view<Material>() ) {
@@ -361,10 +497,11 @@ namespace Boundless {
 			gpuMat.m_RoughnessFactor	   = mat.m_RoughnessFactor;
 			gpuMat.m_AlphaMode			   = mat.m_AlphaMode;
 			gpuMat.m_AlphaCutoff		   = mat.m_AlphaCutoff;
-			gpuMat.m_AlbedoTexture         = mat.m_AlbedoTexture;
-			gpuMat.m_NormalsTexture		   = mat.m_NormalsTexture;
-			gpuMat.m_MetalRoughnessTexture = mat.m_MetalRoughnessTexture;
-			gpuMat.m_EmissiveTexture	   = mat.m_EmissiveTexture;
+			// The GPU copy holds the textures' bindless slots, RESOLVE_TEXTURE indexes the texture table with them.
+			gpuMat.m_AlbedoTexture         = ImageHandle( device.GetImageBindlessIndex( mat.m_AlbedoTexture ) );
+			gpuMat.m_NormalsTexture		   = ImageHandle( device.GetImageBindlessIndex( mat.m_NormalsTexture ) );
+			gpuMat.m_MetalRoughnessTexture = ImageHandle( device.GetImageBindlessIndex( mat.m_MetalRoughnessTexture ) );
+			gpuMat.m_EmissiveTexture	   = ImageHandle( device.GetImageBindlessIndex( mat.m_EmissiveTexture ) );
 			gpuMat.m_Albedo				   = mat.m_Albedo;
 			gpuMat.m_Emissive			   = mat.m_Emissive;
 
@@ -378,25 +515,30 @@ namespace Boundless {
 			return a.m_Index < b.m_Index;
 		} );
 
-		size_t bufferSize = materials.size() * sizeof( GPUMaterial );
+		return materials;
+	}
 
-		std::unique_ptr<StagingBuffer> stagingBuffer = device.CreateStagingBuffer( bufferSize );
+	void Scene::UploadMaterials( Device& device, UploadBatch& batch ) { 
+		std::vector<GPUMaterial> materials = GatherMaterials( device );
+
+		size_t bufferSize = materials.size() * sizeof( GPUMaterial );
 
 		m_MaterialBuffer = device.CreateBuffer(
 			Buffer::Desc{
 				.m_Size = bufferSize,
 				.m_Usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Pool = EMemoryPool::Constants,
+				.m_HostWrite = true
 			}
 		);
 
-		stagingBuffer->Patch( materials.data(), materials.size() * sizeof( GPUMaterial ) );
+		if ( m_MaterialBuffer == BufferHandle::Invalid ) {
+			printf( "[Scene] Failed to allocate the material buffer, nothing will be drawn\n" );
+			return;
+		}
 
-		CommandBuffer commandBuffer = CommandBuffer( device );
-		commandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
-		commandBuffer.CopyBuffer( *stagingBuffer, device.GetBuffer( m_MaterialBuffer ), bufferSize );
-		commandBuffer.End();
-		commandBuffer.Submit( device.GetQueue() );
+		batch.UploadBuffer( device.GetBuffer( m_MaterialBuffer ), materials.data(), bufferSize );
 	}
 
 	void Scene::UploadSkeletons( Device& device ) { 
@@ -407,17 +549,80 @@ namespace Boundless {
 
 			Skeleton& skeleton = m_Registry.get<Skeleton>( mesh.m_Skeleton );
 
+			// Meshes sharing the skeleton share its palette.
+			if ( skeleton.m_BoneTransformsBuffer != BufferHandle::Invalid )
+				continue;
+
 			skeleton.m_BoneTransformMatrices.resize( skeleton.m_InverseBindMatrices.size(), glm::mat4( 1.0f ) );
 			skeleton.m_BoneWSTransformMatrices.resize( skeleton.m_InverseBindMatrices.size(), glm::mat4( 1.0f ) );
 
 			skeleton.m_BoneTransformsBuffer = device.CreateBuffer( Buffer::Desc{
 					.m_Size = uint32_t( skeleton.m_BoneTransformMatrices.size() * sizeof( glm::mat4 ) ),
 					.m_Usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
-					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+					.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+					.m_Pool = EMemoryPool::Constants
 				} );
+
+			// SkinningPass skips meshes of skeletons without a palette.
+			if ( skeleton.m_BoneTransformsBuffer == BufferHandle::Invalid )
+				printf( "[Scene] Failed to allocate the bone transforms of mesh %s's skeleton\n", mesh.m_Name.c_str() );
 		}
 	}
 
+	void Scene::UploadInstances( Device& device ) {
+		uint32_t instanceCount = 0;
+		for ( auto [ entity, mesh, transform ] : m_Registry.view<Mesh, Transform>().each() ) {
+			if ( mesh.m_Geometry.m_IndexCount > 0 )
+				mesh.m_InstanceIndex = instanceCount++;
+		}
+
+		// Drawing reads the materials and the texture table, without them there are no instances and every pass skips the scene.
+		if ( instanceCount == 0 || m_MaterialBuffer == BufferHandle::Invalid || GetTextureTable() == BufferHandle::Invalid )
+			return;
+
+		m_InstanceBuffer = device.CreateBuffer( Buffer::Desc{
+				.m_Size = instanceCount * sizeof( GPUMeshInstance ),
+				.m_Usage = vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eTransferDst,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
+			} );
+
+		if ( m_InstanceBuffer == BufferHandle::Invalid ) {
+			printf( "[Scene] Failed to allocate %u instances, nothing will be drawn\n", instanceCount );
+			return;
+		}
+
+		m_Instances.resize( instanceCount );
+	}
+
+	void Scene::UpdateInstances( Device& device, CommandBuffer& commandBuffer ) {
+		if ( m_InstanceBuffer == BufferHandle::Invalid )
+			return;
+
+		for ( auto [ entity, mesh, transform ] : m_Registry.view<Mesh, Transform>().each() ) {
+			if ( mesh.m_Geometry.m_IndexCount == 0 )
+				continue;
+
+			const GeometryAllocation& vertices = mesh.m_SkinnedGeometry.IsValid() ? mesh.m_SkinnedGeometry : mesh.m_Geometry;
+
+			GPUMeshInstance& instance = m_Instances[ mesh.m_InstanceIndex ];
+			instance.m_WorldTransform = transform.m_WorldTransform;
+			instance.m_BoundingSphere = mesh.m_WorldBounds.m_Sphere;
+			instance.m_VertexBuffer	  = m_GeometryPool.GetVertexAddress( device, vertices );
+			instance.m_MaterialIndex  = mesh.m_Material;
+			instance.m_IndexCount	  = mesh.m_Geometry.m_IndexCount;
+			instance.m_FirstIndex	  = mesh.m_Geometry.m_IndexOffset;
+
+			// Skinned meshes can animate outside of their bind pose bounds, never cull them.
+			if ( !mesh.m_WorldBounds.IsValid() || mesh.m_SkinnedGeometry.IsValid() )
+				instance.m_BoundingSphere.w = -1.f;
+		}
+
+		// Copied on the frame's command buffer, frames still in flight read the buffer until the copy waited for them.
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite );
+		device.UploadBuffer( commandBuffer, device.GetBuffer( m_InstanceBuffer ), m_Instances.data(), m_Instances.size() * sizeof( GPUMeshInstance ) );
+		commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead );
+	}
+
 	void PrintEntityName( Scene& scene, entt::entity entity, std::string& tabs ) {
 		auto& registry = scene.GetRegistry();
 
@@ -456,6 +661,9 @@ namespace Boundless {
 		if( Transform* transform = m_Registry.try_get<Transform>( entity ) ) {
 			transform->m_WorldTransform = parentTransform * transform->m_LocalTransform;
 			childTransform = transform->m_WorldTransform;
+
+			if ( Mesh* mesh = m_Registry.try_get<Mesh>( entity ) )
+				mesh->m_WorldBounds = mesh->m_LocalBounds.Transform( transform->m_WorldTransform );
 		}
 
 		for ( entt::entity child : relation.m_Children )
@@ -1,6 +1,8 @@
 #pragma once
 #include "Pch.hpp"
 #include "Device.hpp"
+#include "UploadBatch.hpp"
+#include "TextureLoader.hpp"
 #include "Components.hpp"
 
 namespace Boundless {
@@ -13,22 +15,45 @@ namespace Boundless {
 		std::vector<entt::entity> m_Children{};
 	};
 
+	// Per draw data read by the GBuffer vertex shader and the GPU cull pass, mirrors MeshInstance in Types.hlsli.
+	struct alignas( 16 ) GPUMeshInstance {
+		glm::mat4		  m_WorldTransform;
+		glm::vec4		  m_BoundingSphere; // w < 0 - never culled.
+		vk::DeviceAddress m_VertexBuffer;
+		uint32_t		  m_MaterialIndex;
+		uint32_t		  m_IndexCount;
+		uint32_t		  m_FirstIndex;
+		uint32_t		  m_Pad0[3];
+	};
+
 	class Scene {
+		friend class SceneSerializer;
 	public:
 		Scene();
 
 		entt::registry& GetRegistry() { return m_Registry; }
+		const entt::registry& GetRegistry() const { return m_Registry; }
 
 		// TODO: Remove.
 		Camera& GetMainCamera() { return m_MainCamera; }
 		void SetMainCamera( const Camera& camera ) { m_MainCamera = camera; }
 
-		void UploadToGPU( Device& device );
+		void UploadToGPU( Device& device, TextureLoader& textureLoader );
+		// Tells the texture loader how large each material's textures show up on screen this frame, from the bounds of
+		// the meshes using them.
+		void RequestTextureResolutions( const Camera& camera, float viewportHeight );
 		void BuildTLAS( Device& device, CommandBuffer& commandBuffer );
 		void UpdateTransforms();
 		void UpdateAnimations( float deltaTime );
+		void UpdateInstances( Device& device, CommandBuffer& commandBuffer );
 
 		BufferHandle GetMaterialBuffer() const { return m_MaterialBuffer; }
+		// Material texture handles resolve through it, see TextureLoader.
+		BufferHandle GetTextureTable() const { return m_TextureLoader ? m_TextureLoader->GetTextureTable() : BufferHandle::Invalid; }
+		BufferHandle GetIndexBuffer() const { return m_GeometryPool.GetIndexBuffer(); }
+		const GeometryPool& GetGeometryPool() const { return m_GeometryPool; }
+		BufferHandle GetInstanceBuffer() const { return m_InstanceBuffer; }
+		uint32_t GetInstanceCount() const { return uint32_t( m_Instances.size() ); }
 		vk::AccelerationStructureKHR GetTLAS() const { return m_TLAS; }
 
 		// Entity relations.
@@ -39,17 +64,28 @@ namespace Boundless {
 		entt::entity CreateEntityWithTransform( const std::string& name = "" );
 		entt::entity GetRootEntity() const { return m_RootEntity; }
 	private:
+		// Swaps in a loaded registry. The current materials are destroyed first so their textures are given back.
+		void ReplaceRegistry( entt::registry&& registry, entt::entity rootEntity );
 		void UploadTLAS( Device& device );
-		void UploadMeshes( Device& device );
-		void UploadTextures( Device& device );
-		void UploadMaterials( Device& device );
+		void UploadMeshes( Device& device, UploadBatch& batch );
+		void UploadTextures( TextureLoader& textureLoader );
+		void UploadMaterials( Device& device, UploadBatch& batch );
+		std::vector<GPUMaterial> GatherMaterials( Device& device );
 		void UploadSkeletons( Device& device );
+		void UploadInstances( Device& device );
 		void UpdateTransformsRecursive( entt::entity entity, const glm::mat4& parentTransform );
+		void OnMaterialDestroyed( entt::registry& registry, entt::entity entity );
 
 		Camera						 m_MainCamera; // TODO: Remove.
 		entt::registry				 m_Registry;
 		entt::entity				 m_RootEntity;
 		BufferHandle				 m_MaterialBuffer = BufferHandle::Invalid;
+		TextureLoader*				 m_TextureLoader = nullptr; // Set by UploadToGPU, textures of destroyed materials are released through it.
+
+		// Scene wide draw data.
+		GeometryPool				 m_GeometryPool;
+		BufferHandle				 m_InstanceBuffer = BufferHandle::Invalid;
+		std::vector<GPUMeshInstance> m_Instances;
 
 		// Ray-tracing Data.
 		vk::AccelerationStructureKHR m_TLAS = {};
@@ -0,0 +1,354 @@
+#include "Pch.hpp"
+#include "SceneSerializer.hpp"
+
+namespace Boundless {
+	void OutputArchive::Write( const std::string& value ) {
+		Write( uint64_t( value.size() ) );
+		WriteBytes( value.data(), value.size() );
+	}
+
+	void OutputArchive::WriteBytes( const void* data, size_t size ) {
+		if ( size == 0 )
+			return;
+
+		size_t offset = m_Data.size();
+		m_Data.resize( offset + size );
+		memcpy( m_Data.data() + offset, data, size );
+	}
+
+	template<typename T>
+	void OutputArchive::operator()( const T& component ) {
+		SceneSerializer::Write( *this, component );
+	}
+
+	void InputArchive::Read( std::string& value ) {
+		uint64_t size = 0;
+		Read( size );
+
+		if ( size > m_Data.size() - m_Offset ) {
+			m_Failed = true;
+			return;
+		}
+
+		value.assign( reinterpret_cast<const char*>( m_Data.data() + m_Offset ), size_t( size ) );
+		m_Offset += size_t( size );
+	}
+
+	void InputArchive::ReadBytes( void* data, size_t size ) {
+		if ( size == 0 )
+			return;
+
+		// Keep going with zeroed data on truncated files, the caller checks HasFailed once at the end.
+		if ( m_Failed || size > m_Data.size() - m_Offset ) {
+			m_Failed = true;
+			memset( data, 0, size );
+			return;
+		}
+
+		memcpy( data, m_Data.data() + m_Offset, size );
+		m_Offset += size;
+	}
+
+	template<typename T>
+	void InputArchive::operator()( T& component ) {
+		SceneSerializer::Read( *this, component );
+	}
+
+	SceneSerializer::SceneSerializer( Scene& inScene ) : m_Scene( inScene ) {}
+
+	bool SceneSerializer::SaveToFile( const std::string& path ) {
+		const entt::registry& registry = m_Scene.GetRegistry();
+
+		OutputArchive archive{};
+		archive.Write( m_Scene.m_RootEntity );
+
+		entt::snapshot{ registry }
+			.get<entt::entity>( archive )
+			.get<EntityTag>( archive )
+			.get<EntityRelation>( archive )
+			.get<Transform>( archive )
+			.get<Mesh>( archive )
+			.get<Material>( archive )
+			.get<Skeleton>( archive )
+			.get<Animation>( archive );
+
+		FILE* file = nullptr;
+		if ( fopen_s( &file, path.c_str(), "wb" ) != 0 || !file ) {
+			printf( "[Scene] Failed to open %s for writing\n", path.c_str() );
+			return false;
+		}
+
+		const std::vector<uint8_t>& data = archive.GetData();
+		const Header header = { Magic, Version, data.size() };
+
+		bool written = fwrite( &header, sizeof( Header ), 1, file ) == 1 && fwrite( data.data(), 1, data.size(), file ) == data.size();
+		fclose( file );
+
+		if ( !written ) {
+			printf( "[Scene] Failed to write %s\n", path.c_str() );
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SceneSerializer::LoadFromFile( const std::string& path ) {
+		FILE* file = nullptr;
+		if ( fopen_s( &file, path.c_str(), "rb" ) != 0 || !file )
+			return false;
+
+		// Pull the whole snapshot in with a single read, everything after this is memcpy out of memory.
+		fseek( file, 0, SEEK_END );
+		long fileSize = ftell( file );
+		fseek( file, 0, SEEK_SET );
+
+		std::vector<uint8_t> data( fileSize > 0 ? size_t( fileSize ) : 0 );
+		size_t read = fread( data.data(), 1, data.size(), file );
+		fclose( file );
+
+		if ( read != data.size() ) {
+			printf( "[Scene] Failed to read %s\n", path.c_str() );
+			return false;
+		}
+
+		InputArchive archive( std::move( data ) );
+
+		Header header = {};
+		archive.Read( header );
+
+		if ( header.m_Magic != Magic || header.m_Version != Version ) {
+			printf( "[Scene] %s is not a compatible scene snapshot (version %u, expected %u)\n", path.c_str(), header.m_Version, Version );
+			return false;
+		}
+
+		// Reject truncated files up front, the entt loader asserts on garbage identifiers.
+		if ( header.m_PayloadSize != archive.GetRemaining() ) {
+			printf( "[Scene] %s is truncated\n", path.c_str() );
+			return false;
+		}
+
+		entt::entity rootEntity = entt::null;
+		archive.Read( rootEntity );
+
+		// The loader restores the original entity identifiers, which needs a registry that never handed any out.
+		entt::registry registry{};
+
+		entt::snapshot_loader{ registry }
+			.get<entt::entity>( archive )
+			.get<EntityTag>( archive )
+			.get<EntityRelation>( archive )
+			.get<Transform>( archive )
+			.get<Mesh>( archive )
+			.get<Material>( archive )
+			.get<Skeleton>( archive )
+			.get<Animation>( archive );
+
+		if ( archive.HasFailed() || !registry.valid( rootEntity ) ) {
+			printf( "[Scene] %s is corrupt\n", path.c_str() );
+			return false;
+		}
+
+		m_Scene.ReplaceRegistry( std::move( registry ), rootEntity );
+
+		return true;
+	}
+
+	bool SceneSerializer::IsUpToDate( const std::string& snapshotPath, const std::string& sourcePath ) {
+		std::error_code error{};
+
+		auto snapshotTime = std::filesystem::last_write_time( snapshotPath, error );
+		if ( error )
+			return false;
+
+		auto sourceTime = std::filesystem::last_write_time( sourcePath, error );
+		if ( error )
+			return true; // Source asset is gone, the snapshot is all there is.
+
+		return snapshotTime >= sourceTime;
+	}
+
+	// ---------------------------------------------------------------------------------------------------
+	// Component serializers.
+	// ---------------------------------------------------------------------------------------------------
+
+	void SceneSerializer::Write( OutputArchive& archive, const EntityTag& tag ) {
+		archive.Write( tag.m_Name );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, EntityTag& tag ) {
+		archive.Read( tag.m_Name );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const EntityRelation& relation ) {
+		archive.Write( relation.m_Parent );
+		archive.Write( relation.m_Children );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, EntityRelation& relation ) {
+		archive.Read( relation.m_Parent );
+		archive.Read( relation.m_Children );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const Transform& transform ) {
+		archive.Write( transform.m_LocalTransform );
+		archive.Write( transform.m_WorldTransform );
+		archive.Write( transform.m_Translation );
+		archive.Write( transform.m_Scale );
+		archive.Write( transform.m_Rotation );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, Transform& transform ) {
+		archive.Read( transform.m_LocalTransform );
+		archive.Read( transform.m_WorldTransform );
+		archive.Read( transform.m_Translation );
+		archive.Read( transform.m_Scale );
+		archive.Read( transform.m_Rotation );
+		transform.m_Parent = nullptr;
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const Mesh& mesh ) {
+		archive.Write( mesh.m_Name );
+		archive.Write( mesh.m_Positions );
+		archive.Write( mesh.m_Normals );
+		archive.Write( mesh.m_Texcoords );
+		archive.Write( mesh.m_Tangents );
+		archive.Write( mesh.m_Indices );
+		archive.Write( mesh.m_Vertices );
+		archive.Write( mesh.m_LocalBounds );
+		archive.Write( mesh.m_WorldBounds );
+		archive.Write( mesh.m_Material );
+		archive.Write( mesh.m_BoneWeights );
+		archive.Write( mesh.m_BoneIndices );
+		archive.Write( mesh.m_Skeleton );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, Mesh& mesh ) {
+		// GPU handles keep their defaults, Scene::UploadToGPU recreates them.
+		archive.Read( mesh.m_Name );
+		archive.Read( mesh.m_Positions );
+		archive.Read( mesh.m_Normals );
+		archive.Read( mesh.m_Texcoords );
+		archive.Read( mesh.m_Tangents );
+		archive.Read( mesh.m_Indices );
+		archive.Read( mesh.m_Vertices );
+		archive.Read( mesh.m_LocalBounds );
+		archive.Read( mesh.m_WorldBounds );
+		archive.Read( mesh.m_Material );
+		archive.Read( mesh.m_BoneWeights );
+		archive.Read( mesh.m_BoneIndices );
+		archive.Read( mesh.m_Skeleton );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const Material& material ) {
+		// Texture handles are runtime only, the paths are what gets restored.
+		GPUMaterial gpuMaterial = material;
+		gpuMaterial.m_AlbedoTexture = ImageHandle::Invalid;
+		gpuMaterial.m_NormalsTexture = ImageHandle::Invalid;
+		gpuMaterial.m_MetalRoughnessTexture = ImageHandle::Invalid;
+		gpuMaterial.m_EmissiveTexture = ImageHandle::Invalid;
+
+		archive.Write( gpuMaterial );
+		archive.Write( material.m_AlbedoTexturePath );
+		archive.Write( material.m_NormalsTexturePath );
+		archive.Write( material.m_MetalRoughnessTexturePath );
+		archive.Write( material.m_EmissiveTexturePath );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, Material& material ) {
+		archive.Read( static_cast<GPUMaterial&>( material ) );
+		archive.Read( material.m_AlbedoTexturePath );
+		archive.Read( material.m_NormalsTexturePath );
+		archive.Read( material.m_MetalRoughnessTexturePath );
+		archive.Read( material.m_EmissiveTexturePath );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const Bone& bone ) {
+		archive.Write( bone.m_Index );
+		archive.Write( bone.m_Name );
+		archive.Write( uint64_t( bone.m_Children.size() ) );
+
+		for ( const Bone& child : bone.m_Children )
+			Write( archive, child );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, Bone& bone ) {
+		uint64_t childCount = 0;
+		archive.Read( bone.m_Index );
+		archive.Read( bone.m_Name );
+		archive.Read( childCount );
+
+		if ( archive.HasFailed() || childCount > archive.GetRemaining() )
+			return;
+
+		bone.m_Children.resize( size_t( childCount ) );
+		for ( Bone& child : bone.m_Children )
+			Read( archive, child );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const Skeleton& skeleton ) {
+		// Bone matrices and the transform buffer are rebuilt by Scene::UploadSkeletons.
+		Write( archive, skeleton.m_RootBone );
+		archive.Write( skeleton.m_Animation );
+		archive.Write( skeleton.m_InverseBindMatrices );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, Skeleton& skeleton ) {
+		Read( archive, skeleton.m_RootBone );
+		archive.Read( skeleton.m_Animation );
+		archive.Read( skeleton.m_InverseBindMatrices );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const AnimationChannel& channel ) {
+		archive.Write( channel.m_Type );
+		archive.Write( channel.m_Sampler.m_Interpolation );
+		archive.Write( channel.m_Sampler.m_Inputs );
+		archive.Write( channel.m_Sampler.m_Outputs );
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, AnimationChannel& channel ) {
+		archive.Read( channel.m_Type );
+		archive.Read( channel.m_Sampler.m_Interpolation );
+		archive.Read( channel.m_Sampler.m_Inputs );
+		archive.Read( channel.m_Sampler.m_Outputs );
+	}
+
+	void SceneSerializer::Write( OutputArchive& archive, const Animation& animation ) {
+		archive.Write( animation.m_Name );
+		archive.Write( animation.m_Start );
+		archive.Write( animation.m_End );
+		archive.Write( animation.m_CurTime );
+		archive.Write( animation.m_IsPaused );
+		archive.Write( uint64_t( animation.m_KeyFrames.size() ) );
+
+		for ( const auto& [ name, keyFrame ] : animation.m_KeyFrames ) {
+			archive.Write( name );
+			Write( archive, keyFrame.m_Translation );
+			Write( archive, keyFrame.m_Rotation );
+			Write( archive, keyFrame.m_Scale );
+		}
+	}
+
+	void SceneSerializer::Read( InputArchive& archive, Animation& animation ) {
+		uint64_t keyFrameCount = 0;
+		archive.Read( animation.m_Name );
+		archive.Read( animation.m_Start );
+		archive.Read( animation.m_End );
+		archive.Read( animation.m_CurTime );
+		archive.Read( animation.m_IsPaused );
+		archive.Read( keyFrameCount );
+
+		if ( archive.HasFailed() || keyFrameCount > archive.GetRemaining() )
+			return;
+
+		animation.m_KeyFrames.reserve( size_t( keyFrameCount ) );
+		for ( uint64_t i = 0; i < keyFrameCount && !archive.HasFailed(); i++ ) {
+			std::string name{};
+			archive.Read( name );
+
+			KeyFrame& keyFrame = animation.m_KeyFrames[ name ];
+			Read( archive, keyFrame.m_Translation );
+			Read( archive, keyFrame.m_Rotation );
+			Read( archive, keyFrame.m_Scale );
+		}
+	}
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include "Pch.hpp"
+#include "Scene.hpp"
+
+namespace Boundless {
+	// Flat little-endian byte stream used for the scene snapshot. Trivially copyable data and arrays of it
+	// are written as raw memory so loading is a single file read followed by straight memcpys into the pools.
+	class OutputArchive {
+	public:
+		template<typename T>
+		void Write( const T& value ) {
+			static_assert( std::is_trivially_copyable_v<T> );
+			WriteBytes( &value, sizeof( T ) );
+		}
+
+		template<typename T>
+		void Write( const std::vector<T>& values ) {
+			static_assert( std::is_trivially_copyable_v<T> );
+			Write( uint64_t( values.size() ) );
+			WriteBytes( values.data(), values.size() * sizeof( T ) );
+		}
+
+		void Write( const std::string& value );
+		void WriteBytes( const void* data, size_t size );
+
+		// entt::snapshot interface.
+		void operator()( std::underlying_type_t<entt::entity> value ) { Write( value ); }
+		void operator()( entt::entity entity ) { Write( entity ); }
+
+		template<typename T>
+		void operator()( const T& component );
+
+		const std::vector<uint8_t>& GetData() const { return m_Data; }
+	private:
+		std::vector<uint8_t> m_Data;
+	};
+
+	class InputArchive {
+	public:
+		InputArchive( std::vector<uint8_t>&& data ) : m_Data( std::move( data ) ) { }
+
+		template<typename T>
+		void Read( T& value ) {
+			static_assert( std::is_trivially_copyable_v<T> );
+			ReadBytes( &value, sizeof( T ) );
+		}
+
+		template<typename T>
+		void Read( std::vector<T>& values ) {
+			static_assert( std::is_trivially_copyable_v<T> );
+			uint64_t count = 0;
+			Read( count );
+
+			if ( count > GetRemaining() / sizeof( T ) ) {
+				m_Failed = true;
+				return;
+			}
+
+			values.resize( size_t( count ) );
+			ReadBytes( values.data(), values.size() * sizeof( T ) );
+		}
+
+		void Read( std::string& value );
+		void ReadBytes( void* data, size_t size );
+
+		// entt::snapshot_loader interface.
+		void operator()( std::underlying_type_t<entt::entity>& value ) { Read( value ); }
+		void operator()( entt::entity& entity ) { Read( entity ); }
+
+		template<typename T>
+		void operator()( T& component );
+
+		bool HasFailed() const { return m_Failed; }
+		size_t GetRemaining() const { return m_Data.size() - m_Offset; }
+	private:
+		std::vector<uint8_t> m_Data;
+		size_t				 m_Offset = 0;
+		bool				 m_Failed = false;
+	};
+
+	// Saves and restores the whole scene registry as a binary snapshot, so levels only go through the
+	// glTF importer once. GPU resources are not part of the snapshot, call Scene::UploadToGPU after loading.
+	class SceneSerializer {
+	public:
+		SceneSerializer( Scene& inScene );
+
+		bool SaveToFile( const std::string& path );
+		bool LoadFromFile( const std::string& path );
+
+		// True when the snapshot exists and is newer than the source asset it was created from.
+		static bool IsUpToDate( const std::string& snapshotPath, const std::string& sourcePath );
+	private:
+		friend class OutputArchive;
+		friend class InputArchive;
+
+		constexpr static const uint32_t Magic = 'NCSB';
+		constexpr static const uint32_t Version = 1;
+
+		struct Header {
+			uint32_t m_Magic;
+			uint32_t m_Version;
+			uint64_t m_PayloadSize;
+		};
+
+		// Component serializers, bump Version whenever one of these changes.
+		static void Write( OutputArchive& archive, const EntityTag& tag );
+		static void Write( OutputArchive& archive, const EntityRelation& relation );
+		static void Write( OutputArchive& archive, const Transform& transform );
+		static void Write( OutputArchive& archive, const Mesh& mesh );
+		static void Write( OutputArchive& archive, const Material& material );
+		static void Write( OutputArchive& archive, const Bone& bone );
+		static void Write( OutputArchive& archive, const Skeleton& skeleton );
+		static void Write( OutputArchive& archive, const AnimationChannel& channel );
+		static void Write( OutputArchive& archive, const Animation& animation );
+
+		static void Read( InputArchive& archive, EntityTag& tag );
+		static void Read( InputArchive& archive, EntityRelation& relation );
+		static void Read( InputArchive& archive, Transform& transform );
+		static void Read( InputArchive& archive, Mesh& mesh );
+		static void Read( InputArchive& archive, Material& material );
+		static void Read( InputArchive& archive, Bone& bone );
+		static void Read( InputArchive& archive, Skeleton& skeleton );
+		static void Read( InputArchive& archive, AnimationChannel& channel );
+		static void Read( InputArchive& archive, Animation& animation );
+
+		Scene& m_Scene;
+	};
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	// Handle based storage with slot reuse. A handle packs the slot index in the low bits and the slot's
+	// generation in the high bits, so a handle to a removed (and possibly reused) slot can be detected.
+	// Elements live in a deque, references stay valid while other elements are added or removed.
+	//
+	// Bit 31 is never set on a valid handle, Invalid (-1) never collides with one.
+	template<typename T, typename Handle>
+	class SlotMap {
+	public:
+		constexpr static const uint32_t IndexBits = 20;
+		constexpr static const uint32_t IndexMask = ( 1u << IndexBits ) - 1;
+		constexpr static const uint32_t GenerationMask = 0x7FFu; // 11 bits.
+
+		template<typename... Args>
+		Handle Emplace( Args&&... args ) {
+			uint32_t index = 0;
+
+			if ( !m_FreeIndices.empty() ) {
+				// Reuse the oldest freed slot first, keeps stale handles detectable for as long as possible.
+				index = m_FreeIndices.front();
+				m_FreeIndices.pop_front();
+			} else {
+				index = uint32_t( m_Slots.size() );
+				if ( index > IndexMask ) {
+					printf( "[SlotMap] Out of slots\n" );
+					return Handle::Invalid;
+				}
+
+				m_Slots.emplace_back();
+				m_Generations.push_back( 0 );
+			}
+
+			m_Slots[ index ].emplace( std::forward<Args>( args )... );
+			m_Count++;
+
+			return MakeHandle( index, m_Generations[ index ] );
+		}
+
+		void Remove( Handle handle ) {
+			if ( !IsValid( handle ) ) {
+				ReportStaleHandle( handle, "Remove" );
+				return;
+			}
+
+			uint32_t index = GetIndex( handle );
+			m_Slots[ index ].reset();
+			m_Generations[ index ] = ( m_Generations[ index ] + 1 ) & GenerationMask;
+			m_FreeIndices.push_back( index );
+			m_Count--;
+		}
+
+		T& Get( Handle handle ) {
+#ifdef _DEBUG
+			if ( !IsValid( handle ) )
+				ReportStaleHandle( handle, "Get" );
+#endif
+			return *m_Slots[ GetIndex( handle ) ];
+		}
+
+		const T& Get( Handle handle ) const {
+#ifdef _DEBUG
+			if ( !IsValid( handle ) )
+				ReportStaleHandle( handle, "Get" );
+#endif
+			return *m_Slots[ GetIndex( handle ) ];
+		}
+
+		bool IsValid( Handle handle ) const {
+			if ( handle == Handle::Invalid )
+				return false;
+
+			uint32_t index = GetIndex( handle );
+			return index < m_Slots.size() && m_Slots[ index ].has_value() && m_Generations[ index ] == GetGeneration( handle );
+		}
+
+		size_t GetCount() const { return m_Count; }
+		size_t GetCapacity() const { return m_Slots.size(); }
+
+		template<typename Func>
+		void ForEach( Func&& func ) {
+			for ( uint32_t i = 0; i < uint32_t( m_Slots.size() ); i++ ) {
+				if ( m_Slots[ i ].has_value() )
+					func( MakeHandle( i, m_Generations[ i ] ), *m_Slots[ i ] );
+			}
+		}
+
+		static uint32_t GetIndex( Handle handle ) { return uint32_t( handle ) & IndexMask; }
+		static uint32_t GetGeneration( Handle handle ) { return ( uint32_t( handle ) >> IndexBits ) & GenerationMask; }
+	private:
+		static Handle MakeHandle( uint32_t index, uint32_t generation ) { return Handle( ( generation << IndexBits ) | index ); }
+
+		void ReportStaleHandle( Handle handle, const char* operation ) const {
+			printf( "[SlotMap] %s with stale handle 0x%08x (index %u, generation %u)\n", operation, uint32_t( handle ), GetIndex( handle ), GetGeneration( handle ) );
+#ifdef _DEBUG
+			__debugbreak();
+#endif
+		}
+
+		std::deque<std::optional<T>> m_Slots;
+		std::vector<uint32_t>		 m_Generations;
+		std::deque<uint32_t>		 m_FreeIndices;
+		size_t						 m_Count = 0;
+	};
+}
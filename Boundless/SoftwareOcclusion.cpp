@@ -0,0 +1,286 @@
+#include "Pch.hpp"
+#include "SoftwareOcclusion.hpp"
+
+namespace Boundless {
+	// Anything closer to the camera plane than this is treated as crossing it.
+	constexpr static const float MinClipW = 1e-4f;
+
+	static float ElapsedMs( std::chrono::high_resolution_clock::time_point start ) {
+		return std::chrono::duration<float, std::milli>( std::chrono::high_resolution_clock::now() - start ).count();
+	}
+
+	SoftwareOcclusion::SoftwareOcclusion( uint32_t width, uint32_t height ) {
+		// Rows are processed 8 pixels at a time.
+		m_Width = std::max( ( width + 7u ) & ~7u, 8u );
+		m_Height = std::max( height, 1u );
+		m_Depth.resize( m_Width * m_Height, FLT_MAX );
+	}
+
+	void SoftwareOcclusion::Begin( const glm::mat4& viewProjection ) {
+		m_ViewProjection = viewProjection;
+		m_Occluders.clear();
+		m_Stats = {};
+
+		std::fill( m_Depth.begin(), m_Depth.end(), FLT_MAX );
+	}
+
+	void SoftwareOcclusion::AddOccluder( const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const glm::mat4& worldTransform ) {
+		if ( positions.empty() || indices.size() < 3 )
+			return;
+
+		m_Occluders.push_back( Occluder{ &positions, &indices, m_ViewProjection * worldTransform } );
+	}
+
+	void SoftwareOcclusion::TransformOccluder( const Occluder& occluder, std::vector<ScreenTriangle>& outTriangles ) const {
+		const std::vector<glm::vec3>& positions = *occluder.m_Positions;
+		const std::vector<uint32_t>& indices = *occluder.m_Indices;
+
+		outTriangles.clear();
+
+		for ( size_t i = 0; i + 2 < indices.size(); i += 3 ) {
+			ScreenTriangle triangle = {};
+			bool		   clipped = false;
+
+			for ( uint32_t v = 0; v < 3; v++ ) {
+				glm::vec4 clip = occluder.m_Transform * glm::vec4( positions[ indices[ i + v ] ], 1.f );
+
+				// Dropping an occluder triangle is always conservative, so skip clipping against the near plane.
+				if ( clip.w < MinClipW ) {
+					clipped = true;
+					break;
+				}
+
+				float invW = 1.f / clip.w;
+				triangle.m_Vertices[ v ] = glm::vec3(
+					( clip.x * invW * 0.5f + 0.5f ) * float( m_Width ),
+					( 0.5f - clip.y * invW * 0.5f ) * float( m_Height ),
+					clip.z * invW
+				);
+			}
+
+			if ( clipped )
+				continue;
+
+			const glm::vec3* v = triangle.m_Vertices;
+			float minX = std::min( { v[ 0 ].x, v[ 1 ].x, v[ 2 ].x } );
+			float maxX = std::max( { v[ 0 ].x, v[ 1 ].x, v[ 2 ].x } );
+			triangle.m_MinY = std::min( { v[ 0 ].y, v[ 1 ].y, v[ 2 ].y } );
+			triangle.m_MaxY = std::max( { v[ 0 ].y, v[ 1 ].y, v[ 2 ].y } );
+
+			if ( maxX < 0.f || minX > float( m_Width ) || triangle.m_MaxY < 0.f || triangle.m_MinY > float( m_Height ) )
+				continue;
+
+			outTriangles.push_back( triangle );
+		}
+	}
+
+	void SoftwareOcclusion::Rasterize( ThreadPool* threadPool ) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		m_Triangles.resize( m_Occluders.size() );
+
+		auto transform = [ this ]( uint32_t begin, uint32_t end ) {
+			for ( uint32_t i = begin; i < end; i++ )
+				TransformOccluder( m_Occluders[ i ], m_Triangles[ i ] );
+		};
+
+		auto rasterize = [ this ]( uint32_t begin, uint32_t end ) {
+			for ( uint32_t band = begin; band < end; band++ )
+				RasterizeBand( band * BandHeight, std::min( ( band + 1 ) * BandHeight, m_Height ) );
+		};
+
+		uint32_t bandCount = ( m_Height + BandHeight - 1 ) / BandHeight;
+
+		if ( threadPool ) {
+			threadPool->ParallelFor( uint32_t( m_Occluders.size() ), transform );
+			threadPool->ParallelFor( bandCount, rasterize );
+		} else {
+			transform( 0, uint32_t( m_Occluders.size() ) );
+			rasterize( 0, bandCount );
+		}
+
+		m_Stats.m_OccluderCount = uint32_t( m_Occluders.size() );
+		for ( const std::vector<ScreenTriangle>& triangles : m_Triangles )
+			m_Stats.m_OccluderTriangles += uint32_t( triangles.size() );
+
+		m_Stats.m_RasterTimeMs = ElapsedMs( start );
+	}
+
+	void SoftwareOcclusion::RasterizeBand( uint32_t beginRow, uint32_t endRow ) {
+		for ( const std::vector<ScreenTriangle>& triangles : m_Triangles ) {
+			for ( const ScreenTriangle& triangle : triangles ) {
+				if ( triangle.m_MaxY < float( beginRow ) || triangle.m_MinY > float( endRow ) )
+					continue;
+
+				RasterizeTriangle( triangle, beginRow, endRow );
+			}
+		}
+	}
+
+	// Edge function rasterizer sampling pixel centers, 8 pixels per iteration.
+	void SoftwareOcclusion::RasterizeTriangle( const ScreenTriangle& triangle, uint32_t beginRow, uint32_t endRow ) {
+		glm::vec3 v0 = triangle.m_Vertices[ 0 ];
+		glm::vec3 v1 = triangle.m_Vertices[ 1 ];
+		glm::vec3 v2 = triangle.m_Vertices[ 2 ];
+
+		float area = ( v1.x - v0.x ) * ( v2.y - v0.y ) - ( v1.y - v0.y ) * ( v2.x - v0.x );
+		if ( std::abs( area ) < 1e-8f )
+			return;
+
+		// No backface culling, flip the winding so the edge functions are positive inside.
+		if ( area < 0.f ) {
+			std::swap( v1, v2 );
+			area = -area;
+		}
+
+		// Edge i is opposite vertex i: w(p) = A * p.x + B * p.y + C.
+		const glm::vec3* edgeStart[ 3 ] = { &v1, &v2, &v0 };
+		const glm::vec3* edgeEnd[ 3 ] = { &v2, &v0, &v1 };
+
+		float a[ 3 ], b[ 3 ], c[ 3 ];
+		for ( uint32_t i = 0; i < 3; i++ ) {
+			a[ i ] = -( edgeEnd[ i ]->y - edgeStart[ i ]->y );
+			b[ i ] = edgeEnd[ i ]->x - edgeStart[ i ]->x;
+			c[ i ] = -( a[ i ] * edgeStart[ i ]->x + b[ i ] * edgeStart[ i ]->y );
+		}
+
+		// Depth plane from the barycentrics.
+		float invArea = 1.f / area;
+		float zA = ( a[ 0 ] * v0.z + a[ 1 ] * v1.z + a[ 2 ] * v2.z ) * invArea;
+		float zB = ( b[ 0 ] * v0.z + b[ 1 ] * v1.z + b[ 2 ] * v2.z ) * invArea;
+		float zC = ( c[ 0 ] * v0.z + c[ 1 ] * v1.z + c[ 2 ] * v2.z ) * invArea;
+
+		float minXf = std::min( { v0.x, v1.x, v2.x } );
+		float maxXf = std::max( { v0.x, v1.x, v2.x } );
+
+		int32_t minX = std::max( int32_t( std::floor( minXf ) ), 0 ) & ~7;
+		int32_t maxX = std::min( int32_t( std::ceil( maxXf ) ), int32_t( m_Width ) );
+		int32_t minY = std::max( int32_t( std::floor( triangle.m_MinY ) ), int32_t( beginRow ) );
+		int32_t maxY = std::min( int32_t( std::ceil( triangle.m_MaxY ) ), int32_t( endRow ) );
+
+		const __m256 laneOffsets = _mm256_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f );
+		const __m256 zero = _mm256_setzero_ps();
+
+		__m256 edgeA[ 3 ];
+		for ( uint32_t i = 0; i < 3; i++ )
+			edgeA[ i ] = _mm256_set1_ps( a[ i ] );
+
+		__m256 depthA = _mm256_set1_ps( zA );
+
+		for ( int32_t y = minY; y < maxY; y++ ) {
+			float py = float( y ) + 0.5f;
+
+			__m256 edgeRow[ 3 ];
+			for ( uint32_t i = 0; i < 3; i++ )
+				edgeRow[ i ] = _mm256_set1_ps( b[ i ] * py + c[ i ] );
+
+			__m256 depthRow = _mm256_set1_ps( zB * py + zC );
+			float* row = &m_Depth[ size_t( y ) * m_Width ];
+
+			for ( int32_t x = minX; x < maxX; x += 8 ) {
+				__m256 px = _mm256_add_ps( _mm256_set1_ps( float( x ) ), laneOffsets );
+
+				__m256 w0 = _mm256_fmadd_ps( edgeA[ 0 ], px, edgeRow[ 0 ] );
+				__m256 w1 = _mm256_fmadd_ps( edgeA[ 1 ], px, edgeRow[ 1 ] );
+				__m256 w2 = _mm256_fmadd_ps( edgeA[ 2 ], px, edgeRow[ 2 ] );
+
+				__m256 inside = _mm256_and_ps( _mm256_and_ps( _mm256_cmp_ps( w0, zero, _CMP_GE_OQ ), _mm256_cmp_ps( w1, zero, _CMP_GE_OQ ) ), _mm256_cmp_ps( w2, zero, _CMP_GE_OQ ) );
+				if ( _mm256_testz_ps( inside, inside ) )
+					continue;
+
+				__m256 depth = _mm256_fmadd_ps( depthA, px, depthRow );
+				__m256 current = _mm256_loadu_ps( row + x );
+
+				_mm256_storeu_ps( row + x, _mm256_blendv_ps( current, _mm256_min_ps( current, depth ), inside ) );
+			}
+		}
+	}
+
+	bool SoftwareOcclusion::IsOccluded( const glm::vec3& center, const glm::vec3& extents ) const {
+		glm::vec2 screenMin = glm::vec2( FLT_MAX );
+		glm::vec2 screenMax = glm::vec2( -FLT_MAX );
+		float	  minDepth = FLT_MAX;
+
+		for ( uint32_t i = 0; i < 8; i++ ) {
+			glm::vec3 corner = center + extents * glm::vec3( ( i & 1 ) ? 1.f : -1.f, ( i & 2 ) ? 1.f : -1.f, ( i & 4 ) ? 1.f : -1.f );
+			glm::vec4 clip = m_ViewProjection * glm::vec4( corner, 1.f );
+
+			// Crosses the camera plane, can't be projected safely.
+			if ( clip.w < MinClipW )
+				return false;
+
+			float invW = 1.f / clip.w;
+			glm::vec2 screen = glm::vec2( ( clip.x * invW * 0.5f + 0.5f ) * float( m_Width ), ( 0.5f - clip.y * invW * 0.5f ) * float( m_Height ) );
+
+			screenMin = glm::min( screenMin, screen );
+			screenMax = glm::max( screenMax, screen );
+			minDepth = std::min( minDepth, clip.z * invW );
+		}
+
+		int32_t minX = std::max( int32_t( std::floor( screenMin.x ) ), 0 );
+		int32_t maxX = std::min( int32_t( std::ceil( screenMax.x ) ), int32_t( m_Width ) );
+		int32_t minY = std::max( int32_t( std::floor( screenMin.y ) ), 0 );
+		int32_t maxY = std::min( int32_t( std::ceil( screenMax.y ) ), int32_t( m_Height ) );
+
+		// Off screen, leave that decision to the frustum culler.
+		if ( minX >= maxX || minY >= maxY )
+			return false;
+
+		const __m256i lanes = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+		const __m256i rectMin = _mm256_set1_epi32( minX - 1 );
+		const __m256i rectMax = _mm256_set1_epi32( maxX );
+		const __m256  boxDepth = _mm256_set1_ps( minDepth );
+
+		// Visible as soon as any depth under the rect is behind the box.
+		for ( int32_t y = minY; y < maxY; y++ ) {
+			const float* row = &m_Depth[ size_t( y ) * m_Width ];
+
+			for ( int32_t x = minX & ~7; x < maxX; x += 8 ) {
+				__m256i index = _mm256_add_epi32( _mm256_set1_epi32( x ), lanes );
+				__m256 inRect = _mm256_castsi256_ps( _mm256_and_si256( _mm256_cmpgt_epi32( index, rectMin ), _mm256_cmpgt_epi32( rectMax, index ) ) );
+				__m256 behind = _mm256_cmp_ps( _mm256_loadu_ps( row + x ), boxDepth, _CMP_GE_OQ );
+
+				if ( !_mm256_testz_ps( inRect, behind ) )
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	void SoftwareOcclusion::TestBoxes( const CullBoxes& boxes, std::vector<uint32_t>& outVisible, ThreadPool* threadPool ) {
+		auto start = std::chrono::high_resolution_clock::now();
+
+		const uint32_t count = uint32_t( boxes.GetCount() );
+
+		std::vector<uint8_t> visible( count, 0 );
+		auto test = [ & ]( uint32_t begin, uint32_t end ) {
+			for ( uint32_t i = begin; i < end; i++ ) {
+				if ( boxes.m_Ids[ i ] == UINT32_MAX )
+					continue;
+
+				glm::vec3 center = { boxes.m_CenterX[ i ], boxes.m_CenterY[ i ], boxes.m_CenterZ[ i ] };
+				glm::vec3 extents = { boxes.m_ExtentX[ i ], boxes.m_ExtentY[ i ], boxes.m_ExtentZ[ i ] };
+				visible[ i ] = IsOccluded( center, extents ) ? 0 : 1;
+			}
+		};
+
+		if ( threadPool )
+			threadPool->ParallelFor( count, test, 64 );
+		else
+			test( 0, count );
+
+		uint32_t visibleCount = 0;
+		for ( uint32_t i = 0; i < count; i++ ) {
+			if ( !visible[ i ] )
+				continue;
+
+			outVisible.push_back( boxes.m_Ids[ i ] );
+			visibleCount++;
+		}
+
+		m_Stats.m_TestedCount += uint32_t( boxes.m_ValidCount );
+		m_Stats.m_OccludedCount += uint32_t( boxes.m_ValidCount ) - visibleCount;
+		m_Stats.m_TestTimeMs += ElapsedMs( start );
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Pch.hpp"
+#include "Culling.hpp"
+#include "ThreadPool.hpp"
+
+namespace Boundless {
+	struct OcclusionStats {
+		uint32_t m_OccluderCount = 0;
+		uint32_t m_OccluderTriangles = 0;
+		uint32_t m_TestedCount = 0;
+		uint32_t m_OccludedCount = 0;
+		float	 m_RasterTimeMs = 0.f;
+		float	 m_TestTimeMs = 0.f;
+	};
+
+	// Low resolution CPU depth buffer for occlusion culling, no GPU resources involved.
+	// Usage per frame: Begin, AddOccluder for a handful of large meshes, Rasterize, then TestBoxes.
+	// Depth is NDC z of viewProjection (smaller is closer), cleared to FLT_MAX.
+	class SoftwareOcclusion {
+	public:
+		explicit SoftwareOcclusion( uint32_t width = 256, uint32_t height = 128 );
+
+		void Begin( const glm::mat4& viewProjection );
+
+		// The vertex and index data is referenced, not copied, and must stay alive until Rasterize returns.
+		void AddOccluder( const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, const glm::mat4& worldTransform );
+
+		// Transforms occluders and rasterizes them in horizontal bands, both spread across the pool when given.
+		void Rasterize( ThreadPool* threadPool = nullptr );
+
+		bool IsOccluded( const glm::vec3& center, const glm::vec3& extents ) const;
+
+		// Appends the ids of every box that is not occluded to outVisible, padding boxes are skipped.
+		void TestBoxes( const CullBoxes& boxes, std::vector<uint32_t>& outVisible, ThreadPool* threadPool = nullptr );
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+		const std::vector<float>& GetDepth() const { return m_Depth; }
+		const OcclusionStats& GetStats() const { return m_Stats; }
+	private:
+		struct Occluder {
+			const std::vector<glm::vec3>* m_Positions;
+			const std::vector<uint32_t>*  m_Indices;
+			glm::mat4					  m_Transform; // viewProjection * world.
+		};
+
+		// Screen space triangle, x/y in pixels and z in NDC.
+		struct ScreenTriangle {
+			glm::vec3 m_Vertices[ 3 ];
+			float	  m_MinY;
+			float	  m_MaxY;
+		};
+
+		void TransformOccluder( const Occluder& occluder, std::vector<ScreenTriangle>& outTriangles ) const;
+		void RasterizeBand( uint32_t beginRow, uint32_t endRow );
+		void RasterizeTriangle( const ScreenTriangle& triangle, uint32_t beginRow, uint32_t endRow );
+
+		constexpr static const uint32_t BandHeight = 8;
+
+		uint32_t								 m_Width;
+		uint32_t								 m_Height;
+		glm::mat4								 m_ViewProjection = glm::mat4( 1.f );
+		std::vector<float>						 m_Depth;
+		std::vector<Occluder>					 m_Occluders;
+		std::vector<std::vector<ScreenTriangle>> m_Triangles; // Per occluder.
+		OcclusionStats							 m_Stats;
+	};
+}
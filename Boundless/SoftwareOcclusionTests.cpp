@@ -0,0 +1,129 @@
+#include "Pch.hpp"
+#include "SoftwareOcclusionTests.hpp"
+#include "SoftwareOcclusion.hpp"
+
+namespace Boundless {
+	// Camera at the origin looking down -Z, the buffer's 2:1 aspect.
+	static glm::mat4 GetTestViewProjection() {
+		const glm::mat4 projection = glm::perspectiveRH( glm::radians( 60.f ), 2.f, 0.1f, 100.f );
+		const glm::mat4 view = glm::lookAtRH( glm::vec3( 0.f ), glm::vec3( 0.f, 0.f, -1.f ), glm::vec3( 0.f, 1.f, 0.f ) );
+		return projection * view;
+	}
+
+	static bool Check( bool condition, const char* name, int& failures ) {
+		printf( "[SoftwareOcclusionTests] %s: %s\n", condition ? "PASS" : "FAIL", name );
+		if ( !condition )
+			failures++;
+
+		return condition;
+	}
+
+	static bool Contains( const std::vector<uint32_t>& ids, uint32_t id ) {
+		return std::find( ids.begin(), ids.end(), id ) != ids.end();
+	}
+
+	enum ETestBox : uint32_t {
+		InFront,	   // Between the camera and the occluder.
+		Behind,		   // Fully hidden behind the occluder.
+		PartlyCovered, // Behind it, straddling its edge.
+		NearPlane,	   // Crosses the camera plane, can't be projected.
+		BehindCamera,
+		OffScreen,
+		Count
+	};
+
+	static void AddTestBoxes( CullBoxes& boxes ) {
+		boxes.Clear();
+		boxes.Add( glm::vec3( 0.f, 0.f, -5.f ), glm::vec3( 0.5f ), InFront );
+		boxes.Add( glm::vec3( 0.f, 0.f, -20.f ), glm::vec3( 1.f ), Behind );
+		// The occluder's edge at x = 4, z = -10 lines up with x = 8 at z = -20.
+		boxes.Add( glm::vec3( 8.f, 0.f, -20.f ), glm::vec3( 1.f ), PartlyCovered );
+		boxes.Add( glm::vec3( 0.f, 0.f, 0.f ), glm::vec3( 1.f ), NearPlane );
+		boxes.Add( glm::vec3( 0.f, 0.f, 20.f ), glm::vec3( 1.f ), BehindCamera );
+		boxes.Add( glm::vec3( 100.f, 0.f, -20.f ), glm::vec3( 1.f ), OffScreen );
+		boxes.Pad();
+	}
+
+	// An 8x8 quad facing the camera at z = -10.
+	static void TestQuadOccluder( int& failures ) {
+		const std::vector<glm::vec3> positions = { { -4.f, -4.f, -10.f }, { 4.f, -4.f, -10.f }, { 4.f, 4.f, -10.f }, { -4.f, 4.f, -10.f } };
+		const std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+
+		CullBoxes boxes;
+		AddTestBoxes( boxes );
+
+		SoftwareOcclusion occlusion;
+		occlusion.Begin( GetTestViewProjection() );
+		occlusion.AddOccluder( positions, indices, glm::mat4( 1.f ) );
+		occlusion.Rasterize();
+
+		std::vector<uint32_t> visible;
+		occlusion.TestBoxes( boxes, visible );
+
+		Check( Contains( visible, InFront ), "box in front of the occluder is visible", failures );
+		Check( !Contains( visible, Behind ), "box behind the occluder is occluded", failures );
+		Check( Contains( visible, PartlyCovered ), "partly covered box is visible", failures );
+		Check( Contains( visible, NearPlane ), "box crossing the near plane is visible", failures );
+		Check( Contains( visible, BehindCamera ), "box behind the camera is visible", failures );
+		Check( Contains( visible, OffScreen ), "off screen box is left to the frustum culler", failures );
+		Check( visible.size() == Count - 1, "padding boxes are skipped", failures );
+
+		const OcclusionStats& stats = occlusion.GetStats();
+		Check( stats.m_OccluderCount == 1, "stats count the occluder", failures );
+		Check( stats.m_OccluderTriangles == 2, "stats count the occluder's triangles", failures );
+		Check( stats.m_TestedCount == Count, "stats count the tested boxes", failures );
+		Check( stats.m_OccludedCount == 1, "stats count the occluded box", failures );
+	}
+
+	// A quad reaching from in front of the camera to far behind it, every triangle crosses the camera plane.
+	static void TestNearPlaneOccluder( int& failures ) {
+		const std::vector<glm::vec3> positions = { { -4.f, -4.f, 5.f }, { 4.f, -4.f, 5.f }, { 4.f, 4.f, -50.f }, { -4.f, 4.f, -50.f } };
+		const std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+
+		CullBoxes boxes;
+		AddTestBoxes( boxes );
+
+		SoftwareOcclusion occlusion;
+		occlusion.Begin( GetTestViewProjection() );
+		occlusion.AddOccluder( positions, indices, glm::mat4( 1.f ) );
+		occlusion.Rasterize();
+
+		std::vector<uint32_t> visible;
+		occlusion.TestBoxes( boxes, visible );
+
+		const OcclusionStats& stats = occlusion.GetStats();
+		Check( stats.m_OccluderTriangles == 0, "occluder triangles crossing the camera plane are dropped", failures );
+		Check( stats.m_OccludedCount == 0 && visible.size() == Count, "nothing is occluded by a dropped occluder", failures );
+	}
+
+	// Same scene rasterized and tested on the pool, has to match the single threaded result.
+	static void TestThreadPool( int& failures ) {
+		const std::vector<glm::vec3> positions = { { -4.f, -4.f, -10.f }, { 4.f, -4.f, -10.f }, { 4.f, 4.f, -10.f }, { -4.f, 4.f, -10.f } };
+		const std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 3 };
+
+		CullBoxes boxes;
+		AddTestBoxes( boxes );
+
+		ThreadPool threadPool;
+		SoftwareOcclusion occlusion;
+		occlusion.Begin( GetTestViewProjection() );
+		occlusion.AddOccluder( positions, indices, glm::mat4( 1.f ) );
+		occlusion.Rasterize( &threadPool );
+
+		std::vector<uint32_t> visible;
+		occlusion.TestBoxes( boxes, visible, &threadPool );
+
+		Check( !Contains( visible, Behind ) && visible.size() == Count - 1, "thread pool result matches", failures );
+	}
+
+	int RunSoftwareOcclusionTests() {
+		int failures = 0;
+
+		TestQuadOccluder( failures );
+		TestNearPlaneOccluder( failures );
+		TestThreadPool( failures );
+
+		printf( "[SoftwareOcclusionTests] %d failed\n", failures );
+		return failures;
+	}
+}
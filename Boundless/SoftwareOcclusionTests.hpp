@@ -0,0 +1,7 @@
+#pragma once
+
+namespace Boundless {
+	// CPU only checks of SoftwareOcclusion against synthetic scenes, no window or device. Run with
+	// Boundless --test-occlusion, returns the number of failed checks.
+	int RunSoftwareOcclusionTests();
+}
@@ -0,0 +1,189 @@
+#include "Pch.hpp"
+#include "TextureCooker.hpp"
+#include "MipGenerator.hpp"
+#include "BlockCompression.hpp"
+#include "Scene.hpp"
+
+#include <ktx.h>
+
+namespace Boundless {
+	static const char* GetUsageName( ETextureUsage usage ) {
+		switch ( usage ) {
+		case ETextureUsage::Albedo:			return "albedo";
+		case ETextureUsage::Normal:			return "normal";
+		case ETextureUsage::MetalRoughness: return "metalrough";
+		case ETextureUsage::Emissive:		return "emissive";
+		default:							return "unknown";
+		}
+	}
+
+	std::string TextureCooker::GetCookedPath( const std::string& sourcePath, ETextureUsage usage ) {
+		std::filesystem::path path = sourcePath;
+		return path.replace_extension( std::string( "." ) + GetUsageName( usage ) + ".ktx2" ).string();
+	}
+
+	bool TextureCooker::IsUpToDate( const std::string& cookedPath, const std::string& sourcePath ) {
+		std::error_code error{};
+
+		auto cookedTime = std::filesystem::last_write_time( cookedPath, error );
+		if ( error )
+			return false;
+
+		auto sourceTime = std::filesystem::last_write_time( sourcePath, error );
+		if ( error )
+			return true; // Source image is gone, the cooked file is all there is.
+
+		return cookedTime >= sourceTime;
+	}
+
+	vk::ComponentMapping TextureCooker::ParseSwizzle( const std::string& swizzle ) {
+		if ( swizzle.size() < 4 )
+			return {};
+
+		auto toComponent = []( char c ) {
+			switch ( c ) {
+			case 'r': return vk::ComponentSwizzle::eR;
+			case 'g': return vk::ComponentSwizzle::eG;
+			case 'b': return vk::ComponentSwizzle::eB;
+			case 'a': return vk::ComponentSwizzle::eA;
+			case '0': return vk::ComponentSwizzle::eZero;
+			case '1': return vk::ComponentSwizzle::eOne;
+			default:  return vk::ComponentSwizzle::eIdentity;
+			}
+		};
+
+		return vk::ComponentMapping{ toComponent( swizzle[ 0 ] ), toComponent( swizzle[ 1 ] ), toComponent( swizzle[ 2 ] ), toComponent( swizzle[ 3 ] ) };
+	}
+
+	bool TextureCooker::CookTexture( const std::string& sourcePath, const std::string& cookedPath, ETextureUsage usage ) {
+		int width{}, height{}, texChannels{};
+		stbi_uc* pixels = stbi_load( sourcePath.c_str(), &width, &height, &texChannels, STBI_rgb_alpha );
+		if ( !pixels ) {
+			printf( "[TextureCooker] Failed to load %s\n", sourcePath.c_str() );
+			return false;
+		}
+
+		MipChain chain = GenerateMips( pixels, uint32_t( width ), uint32_t( height ), MipDesc{ .m_Filter = EMipFilter::Kaiser, .m_SRGB = usage == ETextureUsage::Albedo, .m_NormalMap = usage == ETextureUsage::Normal } );
+		stbi_image_free( pixels );
+
+		EBlockFormat blockFormat = EBlockFormat::BC7;
+		VkFormat format = VK_FORMAT_BC7_UNORM_BLOCK;
+		std::array<uint32_t, 2> channels = { 0, 1 };
+		std::string swizzle = "rgba";
+
+		switch ( usage ) {
+		case ETextureUsage::Albedo:
+			format = VK_FORMAT_BC7_SRGB_BLOCK;
+			break;
+		case ETextureUsage::Normal:
+			blockFormat = EBlockFormat::BC5;
+			format = VK_FORMAT_BC5_UNORM_BLOCK;
+			swizzle = "rg01";
+			break;
+		case ETextureUsage::MetalRoughness: {
+			// glTF keeps roughness in G and metal in B. Plenty of assets are all dielectric or all metal, roughness alone fits BC4.
+			const MipLevel& top = chain.m_Levels[ 0 ];
+			const uint8_t* texels = chain.GetLevelData( 0 );
+			const uint8_t metal = texels[ 2 ];
+
+			bool constantMetal = metal == 0 || metal == 255;
+			for ( size_t i = 0; i < size_t( top.m_Width ) * top.m_Height && constantMetal; i++ )
+				constantMetal = texels[ i * 4 + 2 ] == metal;
+
+			if ( constantMetal ) {
+				blockFormat = EBlockFormat::BC4;
+				format = VK_FORMAT_BC4_UNORM_BLOCK;
+				channels = { 1, 1 };
+				swizzle = metal == 0 ? "0r01" : "0r11";
+			} else {
+				blockFormat = EBlockFormat::BC5;
+				format = VK_FORMAT_BC5_UNORM_BLOCK;
+				channels = { 2, 1 };
+				swizzle = "0gr1";
+			}
+			break;
+		}
+		default:
+			break;
+		}
+
+		ktxTextureCreateInfo createInfo = {};
+		createInfo.vkFormat = format;
+		createInfo.baseWidth = uint32_t( width );
+		createInfo.baseHeight = uint32_t( height );
+		createInfo.baseDepth = 1;
+		createInfo.numDimensions = 2;
+		createInfo.numLevels = uint32_t( chain.m_Levels.size() );
+		createInfo.numLayers = 1;
+		createInfo.numFaces = 1;
+		createInfo.isArray = KTX_FALSE;
+		createInfo.generateMipmaps = KTX_FALSE;
+
+		ktxTexture2* texture = nullptr;
+		if ( ktxTexture2_Create( &createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture ) != KTX_SUCCESS ) {
+			printf( "[TextureCooker] Failed to create %s\n", cookedPath.c_str() );
+			return false;
+		}
+
+		for ( uint32_t level = 0; level < uint32_t( chain.m_Levels.size() ); level++ ) {
+			const MipLevel& mip = chain.m_Levels[ level ];
+			std::vector<uint8_t> blocks = CompressImage( chain.GetLevelData( level ), mip.m_Width, mip.m_Height, blockFormat, channels );
+
+			ktxTexture_SetImageFromMemory( ktxTexture( texture ), level, 0, 0, blocks.data(), blocks.size() );
+		}
+
+		ktxHashList_AddKVPair( &texture->kvDataHead, KTX_SWIZZLE_KEY, uint32_t( swizzle.size() + 1 ), swizzle.c_str() );
+
+		const bool written = ktxTexture_WriteToNamedFile( ktxTexture( texture ), cookedPath.c_str() ) == KTX_SUCCESS;
+		ktxTexture_Destroy( ktxTexture( texture ) );
+
+		if ( !written )
+			printf( "[TextureCooker] Failed to write %s\n", cookedPath.c_str() );
+
+		return written;
+	}
+
+	uint32_t TextureCooker::CookScene( Scene& scene ) {
+		std::set<std::pair<std::string, ETextureUsage>> textures;
+
+		entt::registry& registry = scene.GetRegistry();
+		for ( auto ent : registry.view<Material>() ) {
+			const Material& mat = registry.get<Material>( ent );
+
+			if ( !mat.m_AlbedoTexturePath.empty() )
+				textures.insert( { mat.m_AlbedoTexturePath, ETextureUsage::Albedo } );
+
+			if ( !mat.m_NormalsTexturePath.empty() )
+				textures.insert( { mat.m_NormalsTexturePath, ETextureUsage::Normal } );
+
+			if ( !mat.m_MetalRoughnessTexturePath.empty() )
+				textures.insert( { mat.m_MetalRoughnessTexturePath, ETextureUsage::MetalRoughness } );
+
+			if ( !mat.m_EmissiveTexturePath.empty() )
+				textures.insert( { mat.m_EmissiveTexturePath, ETextureUsage::Emissive } );
+		}
+
+		const std::vector<std::pair<std::string, ETextureUsage>> jobs( textures.begin(), textures.end() );
+		std::atomic<uint32_t> cookedCount = 0;
+		std::atomic<uint32_t> failedCount = 0;
+
+		// One texture per task, encoding a single large texture is already plenty of work.
+		m_ThreadPool.ParallelFor( uint32_t( jobs.size() ), [ & ]( uint32_t begin, uint32_t end ) {
+			for ( uint32_t i = begin; i < end; i++ ) {
+				const auto& [ sourcePath, usage ] = jobs[ i ];
+				const std::string cookedPath = GetCookedPath( sourcePath, usage );
+
+				if ( IsUpToDate( cookedPath, sourcePath ) )
+					continue;
+
+				if ( CookTexture( sourcePath, cookedPath, usage ) )
+					cookedCount++;
+				else
+					failedCount++;
+			}
+		} );
+
+		printf( "[TextureCooker] %zu textures, %u cooked, %u up to date, %u failed\n", jobs.size(), cookedCount.load(), uint32_t( jobs.size() ) - cookedCount - failedCount, failedCount.load() );
+		return failedCount;
+	}
+}
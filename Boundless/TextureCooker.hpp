@@ -0,0 +1,37 @@
+#pragma once
+#include "Pch.hpp"
+#include "ThreadPool.hpp"
+
+namespace Boundless {
+	class Scene;
+
+	// What a material slot uses the texture for, picks the block format, the mip filter and the placeholder.
+	enum class ETextureUsage {
+		Albedo,			// BC7 sRGB.
+		Normal,			// BC5, XY only, shaders rebuild Z.
+		MetalRoughness, // BC5 with metal in R and roughness in G, BC4 when metal is constant. Swizzled back to .b/.g.
+		Emissive,		// BC7.
+		Count
+	};
+
+	// Offline conversion of source images (png, jpg, ...) to block compressed KTX2 files with a full, filtered mip chain.
+	// Runs on the CPU only, cooked files are written next to the source as <name>.<usage>.ktx2.
+	class TextureCooker {
+	public:
+		explicit TextureCooker( ThreadPool& threadPool ) : m_ThreadPool( threadPool ) { }
+
+		// Cooks every texture referenced by the scene's materials, skips outputs which are up to date.
+		// Returns the number of textures that failed.
+		uint32_t CookScene( Scene& scene );
+
+		static bool CookTexture( const std::string& sourcePath, const std::string& cookedPath, ETextureUsage usage );
+
+		static std::string GetCookedPath( const std::string& sourcePath, ETextureUsage usage );
+		static bool IsUpToDate( const std::string& cookedPath, const std::string& sourcePath );
+
+		// Parses a KTXswizzle value ("rgba", "0gr1", ...) into a view component mapping.
+		static vk::ComponentMapping ParseSwizzle( const std::string& swizzle );
+	private:
+		ThreadPool& m_ThreadPool;
+	};
+}
@@ -0,0 +1,722 @@
+#include "Pch.hpp"
+#include "TextureLoader.hpp"
+#include "UploadBatch.hpp"
+
+#include <ktx.h>
+
+namespace Boundless {
+	// FNV-1a. The dimensions are part of the seed, MergeDuplicate compares the bytes of images whose hashes collide.
+	static uint64_t HashBytes( const uint8_t* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull ) {
+		for ( size_t i = 0; i < size; i++ ) {
+			hash ^= data[ i ];
+			hash *= 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+
+	// Different spellings of the same file share one cache entry, paths are case insensitive on Windows.
+	static std::string CanonicalizePath( const std::string& path ) {
+		std::error_code error;
+		std::filesystem::path canonical = std::filesystem::weakly_canonical( path, error );
+		if ( error )
+			canonical = std::filesystem::path( path ).lexically_normal();
+
+		std::string result = canonical.generic_string();
+		std::transform( result.begin(), result.end(), result.begin(), []( unsigned char c ) { return char( std::tolower( c ) ); } );
+
+		return result;
+	}
+
+	TextureLoader::TextureLoader( Device& device, ThreadPool& threadPool, bool hashContents ) : m_Device( device ), m_ThreadPool( threadPool ), m_HashContents( hashContents ) {
+		CreatePlaceholders();
+		CreateTextureTable();
+	}
+
+	TextureLoader::~TextureLoader() {
+		// Decode tasks write into textures owned by the loader.
+		m_ThreadPool.WaitIdle();
+	}
+
+	void TextureLoader::CreatePlaceholders() {
+		// Neutral for the material slot they stand in for, ABGR.
+		const std::array<uint32_t, size_t( ETextureUsage::Count )> colors = {
+			0xFFFFFFFFu, // Albedo, white.
+			0xFFFF8080u, // Normal, (0.5, 0.5, 1.0).
+			0xFFFFFFFFu, // MetalRoughness, the material factors apply as is.
+			0xFF000000u	 // Emissive, black.
+		};
+
+		UploadBatch batch = UploadBatch( m_Device );
+
+		for ( size_t i = 0; i < colors.size(); i++ ) {
+			m_Placeholders[ i ] = m_Device.CreateImage( Image::Desc{
+					.m_Type = vk::ImageType::e2D,
+					.m_Width = 1,
+					.m_Height = 1,
+					.m_Levels = 1,
+					.m_Format = vk::Format::eR8G8B8A8Unorm,
+					.m_Usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled
+				} );
+
+			// Loads of this usage fail from now on.
+			if ( m_Placeholders[ i ] == ImageHandle::Invalid ) {
+				printf( "[TextureLoader] Failed to create placeholder %zu\n", i );
+				continue;
+			}
+
+			batch.UploadImage( m_Device.GetImage( m_Placeholders[ i ] ), 0, 1, 1, &colors[ i ], sizeof( uint32_t ) );
+		}
+
+		batch.Submit();
+	}
+
+	void TextureLoader::CreateTextureTable() {
+		// One entry per slot of the bindless image array, Device never hands out a slot past it.
+		// Slots nobody streams into resolve to themselves, anything else sampled through the table still works.
+		m_TableData.resize( Device::MaxBindlessImages );
+		for ( uint32_t i = 0; i < Device::MaxBindlessImages; i++ )
+			m_TableData[ i ] = i;
+
+		const vk::DeviceSize size = m_TableData.size() * sizeof( uint32_t );
+		m_TextureTable = m_Device.CreateBuffer( Buffer::Desc{
+				.m_Size = size,
+				.m_Usage = vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eShaderDeviceAddress,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+				.m_Pool = EMemoryPool::Constants,
+				.m_Category = EMemoryCategory::Textures
+			} );
+
+		// Scene draws nothing without the table, see Scene::UploadInstances.
+		if ( m_TextureTable == BufferHandle::Invalid ) {
+			printf( "[TextureLoader] Failed to allocate the texture table\n" );
+			return;
+		}
+
+		UploadBatch batch = UploadBatch( m_Device );
+		batch.UploadBuffer( m_Device.GetBuffer( m_TextureTable ), m_TableData.data(), size );
+		batch.Submit();
+	}
+
+	ImageHandle TextureLoader::Load( const std::string& path, ETextureUsage usage ) {
+		m_Stats.m_Loads++;
+		m_StatsPending = true;
+
+		PathKey key = { CanonicalizePath( path ), usage };
+
+		auto cached = m_PathCache.find( key );
+		if ( cached != m_PathCache.end() ) {
+			cached->second->m_RefCount++;
+			m_Stats.m_PathHits++;
+
+			return cached->second->m_Slots[ 0 ];
+		}
+
+		if ( m_Placeholders[ size_t( usage ) ] == ImageHandle::Invalid )
+			return ImageHandle::Invalid;
+
+		std::unique_ptr<StreamingTexture> texture = std::make_unique<StreamingTexture>();
+		texture->m_Path = path;
+		texture->m_Usage = usage;
+		texture->m_Key = key;
+
+		// The texture's own view of the placeholder, its bindless slot is what materials keep.
+		const ImageHandle slot = m_Device.CreateImageView( m_Placeholders[ size_t( usage ) ] );
+		if ( slot == ImageHandle::Invalid ) {
+			printf( "[TextureLoader] No bindless slot left for %s\n", path.c_str() );
+			return ImageHandle::Invalid;
+		}
+
+		texture->m_Slots.push_back( slot );
+		texture->m_View = slot;
+
+		StreamingTexture* request = texture.get();
+		m_Textures.push_back( std::move( texture ) );
+		m_PathCache[ key ] = request;
+		m_TexturesBySlot[ slot ] = request;
+		m_InFlightCount++;
+		m_Stats.m_Textures++;
+
+		// A previous owner of the slot may have left it pointing elsewhere.
+		m_TableData[ m_Device.GetImageBindlessIndex( slot ) ] = m_Device.GetImageBindlessIndex( slot );
+		m_TableDirty = true;
+
+		m_ThreadPool.Submit( [ this, request ]() { Decode( *request ); } );
+
+		return slot;
+	}
+
+	void TextureLoader::Decode( StreamingTexture& texture ) {
+		DecodedImage& decoded = texture.m_Decoded;
+		const std::string cookedPath = TextureCooker::GetCookedPath( texture.m_Path, texture.m_Usage );
+
+		if ( !TextureCooker::IsUpToDate( cookedPath, texture.m_Path ) || !DecodeCooked( decoded, cookedPath ) ) {
+			int width{}, height{}, texChannels{};
+			stbi_uc* pixels = stbi_load( texture.m_Path.c_str(), &width, &height, &texChannels, STBI_rgb_alpha );
+
+			if ( pixels ) {
+				const bool isSRGB = texture.m_Usage == ETextureUsage::Albedo;
+
+				MipChain chain = GenerateMips( pixels, uint32_t( width ), uint32_t( height ), MipDesc{ .m_SRGB = isSRGB, .m_NormalMap = texture.m_Usage == ETextureUsage::Normal } );
+				stbi_image_free( pixels );
+
+				decoded.m_Pixels = std::move( chain.m_Pixels );
+				decoded.m_Mips = std::move( chain.m_Levels );
+				decoded.m_Format = isSRGB ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+			}
+		}
+
+		if ( m_HashContents && !decoded.m_Mips.empty() ) {
+			const MipLevel& top = decoded.m_Mips[ 0 ];
+			decoded.m_ContentHash = HashBytes( decoded.m_Pixels.data(), top.m_Size, ( uint64_t( top.m_Width ) << 32 ) | top.m_Height );
+		}
+
+		std::scoped_lock lock( m_DecodedMutex );
+		m_Decoded.push_back( &texture );
+	}
+
+	bool TextureLoader::DecodeCooked( DecodedImage& decoded, const std::string& cookedPath ) {
+		ktxTexture2* ktx = nullptr;
+		if ( ktxTexture2_CreateFromNamedFile( cookedPath.c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &ktx ) != KTX_SUCCESS )
+			return false;
+
+		// Only plain block compressed files come out of the cooker, anything needing a transcode goes through the source.
+		if ( ktxTexture2_NeedsTranscoding( ktx ) || ktx->numDimensions != 2 || ktx->numLayers != 1 || ktx->numFaces != 1 ) {
+			ktxTexture_Destroy( ktxTexture( ktx ) );
+			return false;
+		}
+
+		decoded.m_Format = vk::Format( ktx->vkFormat );
+		decoded.m_Pixels.assign( ktxTexture_GetData( ktxTexture( ktx ) ), ktxTexture_GetData( ktxTexture( ktx ) ) + ktxTexture_GetDataSize( ktxTexture( ktx ) ) );
+
+		for ( uint32_t level = 0; level < ktx->numLevels; level++ ) {
+			ktx_size_t offset = 0;
+			ktxTexture_GetImageOffset( ktxTexture( ktx ), level, 0, 0, &offset );
+
+			decoded.m_Mips.push_back( MipLevel{
+					std::max( ktx->baseWidth >> level, 1u ),
+					std::max( ktx->baseHeight >> level, 1u ),
+					size_t( offset ),
+					size_t( ktxTexture_GetImageSize( ktxTexture( ktx ), level ) )
+				} );
+		}
+
+		char* swizzle = nullptr;
+		unsigned int swizzleLength = 0;
+		if ( ktxHashList_FindValue( &ktx->kvDataHead, KTX_SWIZZLE_KEY, &swizzleLength, reinterpret_cast<void**>( &swizzle ) ) == KTX_SUCCESS && swizzleLength >= 4 )
+			decoded.m_Swizzle = TextureCooker::ParseSwizzle( std::string( swizzle, 4 ) );
+
+		ktxTexture_Destroy( ktxTexture( ktx ) );
+		return true;
+	}
+
+	void TextureLoader::Release( ImageHandle slot ) {
+		auto it = m_TexturesBySlot.find( slot );
+		if ( it == m_TexturesBySlot.end() )
+			return;
+
+		StreamingTexture& texture = *it->second;
+		if ( --texture.m_RefCount > 0 )
+			return;
+
+		for ( ImageHandle other : texture.m_Slots ) {
+			m_TexturesBySlot.erase( other );
+			m_Device.ReleaseImageView( other );
+		}
+
+		if ( texture.m_View != texture.m_Slots[ 0 ] )
+			m_Device.ReleaseImageView( texture.m_View );
+
+		if ( texture.m_Image != ImageHandle::Invalid )
+			m_Device.ReleaseImage( texture.m_Image );
+
+		// Paths of merged duplicates point here as well.
+		std::erase_if( m_PathCache, [ & ]( const auto& entry ) { return entry.second == &texture; } );
+		if ( m_HashContents && texture.m_State != EState::Decoding ) {
+			// Textures that matched another's hash but not its bytes were never cached.
+			auto it = m_ContentCache.find( ContentKey{ texture.m_ContentHash, texture.m_Usage } );
+			if ( it != m_ContentCache.end() && it->second == &texture )
+				m_ContentCache.erase( it );
+		}
+
+		m_Stats.m_Textures--;
+
+		// A decode task still writes into the texture, BeginStreaming/BeginReload drop it once it comes back.
+		if ( texture.m_State != EState::Decoding && texture.m_State != EState::Reloading )
+			Destroy( texture );
+	}
+
+	void TextureLoader::Destroy( StreamingTexture& texture ) {
+		if ( !texture.m_Loaded && texture.m_State != EState::Failed )
+			m_InFlightCount--;
+
+		std::erase( m_Streaming, &texture );
+		std::erase_if( m_Textures, [ & ]( const std::unique_ptr<StreamingTexture>& other ) { return other.get() == &texture; } );
+	}
+
+	void TextureLoader::SetView( StreamingTexture& texture, uint32_t baseMip ) {
+		// The first view is the placeholder slot, which lives as long as the texture. Every step replaces the view, the
+		// old one goes first so a streaming texture holds at most one slot besides its own.
+		if ( texture.m_View != texture.m_Slots[ 0 ] )
+			m_Device.ReleaseImageView( texture.m_View );
+
+		Image& image = m_Device.GetImage( texture.m_Image );
+		ImageHandle view = m_Device.CreateImageView( texture.m_Image, image.GetDesc(), baseMip );
+
+		if ( view == ImageHandle::Invalid ) {
+			printf( "[TextureLoader] No bindless slot left for a view of %s, showing the placeholder\n", texture.m_Path.c_str() );
+			view = texture.m_Slots[ 0 ];
+		}
+
+		texture.m_View = view;
+
+		for ( ImageHandle slot : texture.m_Slots )
+			m_TableData[ m_Device.GetImageBindlessIndex( slot ) ] = m_Device.GetImageBindlessIndex( view );
+
+		m_TableDirty = true;
+	}
+
+	bool TextureLoader::MergeDuplicate( StreamingTexture& texture ) {
+		auto [ it, inserted ] = m_ContentCache.try_emplace( ContentKey{ texture.m_ContentHash, texture.m_Usage }, &texture );
+		if ( inserted )
+			return false;
+
+		StreamingTexture& original = *it->second;
+
+		// Same hash isn't the same image. The original only keeps its pixels while streaming, once they are gone the
+		// bytes can't be compared and both textures stay separate.
+		const bool sameLayout = original.m_Format == texture.m_Format && original.m_Swizzle == texture.m_Swizzle && original.m_Mips.size() == texture.m_Mips.size() &&
+			original.m_Mips[ 0 ].m_Width == texture.m_Mips[ 0 ].m_Width && original.m_Mips[ 0 ].m_Height == texture.m_Mips[ 0 ].m_Height;
+		if ( !sameLayout || original.m_Pixels.size() != texture.m_Pixels.size() || memcmp( original.m_Pixels.data(), texture.m_Pixels.data(), texture.m_Pixels.size() ) != 0 )
+			return false;
+
+		// The duplicate's slots resolve to the original from now on and are released along with it.
+		for ( ImageHandle slot : texture.m_Slots ) {
+			original.m_Slots.push_back( slot );
+			m_TexturesBySlot[ slot ] = &original;
+			m_TableData[ m_Device.GetImageBindlessIndex( slot ) ] = m_Device.GetImageBindlessIndex( original.m_View );
+		}
+
+		original.m_RefCount += texture.m_RefCount;
+		m_PathCache[ texture.m_Key ] = &original;
+		m_TableDirty = true;
+
+		m_Stats.m_ContentHits++;
+		m_Stats.m_Textures--;
+
+		Destroy( texture );
+		return true;
+	}
+
+	ImageHandle TextureLoader::CreateTextureImage( const StreamingTexture& texture, uint32_t firstMip ) {
+		return m_Device.CreateImage( Image::Desc{
+				.m_Type = vk::ImageType::e2D,
+				.m_Width = texture.m_Mips[ firstMip ].m_Width,
+				.m_Height = texture.m_Mips[ firstMip ].m_Height,
+				.m_Levels = uint32_t( texture.m_Mips.size() ) - firstMip,
+				.m_Format = texture.m_Format,
+				.m_Usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+				.m_Swizzle = texture.m_Swizzle
+			} );
+	}
+
+	void TextureLoader::BeginStreaming( StreamingTexture& texture ) {
+		// Released while it was being decoded.
+		if ( texture.m_RefCount == 0 ) {
+			Destroy( texture );
+			return;
+		}
+
+		DecodedImage decoded = std::move( texture.m_Decoded );
+		if ( decoded.m_Mips.empty() ) {
+			printf( "[TextureLoader] Failed to load %s, keeping the placeholder\n", texture.m_Path.c_str() );
+			m_InFlightCount--;
+			texture.m_State = EState::Failed;
+			return;
+		}
+
+		texture.m_Pixels = std::move( decoded.m_Pixels );
+		texture.m_Mips = std::move( decoded.m_Mips );
+		texture.m_Format = decoded.m_Format;
+		texture.m_Swizzle = decoded.m_Swizzle;
+		texture.m_ContentHash = decoded.m_ContentHash;
+		texture.m_ResidentMip = uint32_t( texture.m_Mips.size() );
+
+		if ( m_HashContents && MergeDuplicate( texture ) )
+			return;
+
+		// Only what has been requested so far, everything when nobody asked yet.
+		texture.m_WantedMip = texture.m_RequestedPixels > 0.f ? GetWantedMip( texture, texture.m_RequestedPixels ) : 0;
+		texture.m_ImageFirstMip = texture.m_WantedMip;
+		texture.m_Image = CreateTextureImage( texture, texture.m_ImageFirstMip );
+
+		if ( texture.m_Image == ImageHandle::Invalid ) {
+			printf( "[TextureLoader] No memory for %s, keeping the placeholder\n", texture.m_Path.c_str() );
+			texture.m_Pixels = {};
+			m_InFlightCount--;
+			texture.m_State = EState::Failed;
+			return;
+		}
+
+		texture.m_State = EState::Streaming;
+		m_Streaming.push_back( &texture );
+	}
+
+	void TextureLoader::BeginReload( StreamingTexture& texture ) {
+		m_ReloadsInFlight--;
+
+		if ( texture.m_RefCount == 0 ) {
+			Destroy( texture );
+			return;
+		}
+
+		DecodedImage decoded = std::move( texture.m_Decoded );
+		texture.m_State = EState::Resident;
+
+		// The file changed under us, the new version only shows up on the next load.
+		const bool sameLayout = decoded.m_Format == texture.m_Format && decoded.m_Mips.size() == texture.m_Mips.size() &&
+			decoded.m_Mips[ 0 ].m_Width == texture.m_Mips[ 0 ].m_Width && decoded.m_Mips[ 0 ].m_Height == texture.m_Mips[ 0 ].m_Height;
+
+		if ( !sameLayout ) {
+			printf( "[TextureLoader] %s changed on disk, keeping the resident levels\n", texture.m_Path.c_str() );
+			return;
+		}
+
+		// Moved away again while it was being decoded.
+		if ( texture.m_WantedMip >= texture.m_ImageFirstMip )
+			return;
+
+		if ( !ResizeImage( texture, texture.m_WantedMip ) )
+			return;
+
+		texture.m_Pixels = std::move( decoded.m_Pixels );
+
+		texture.m_State = EState::Streaming;
+		m_Streaming.push_back( &texture );
+		m_Stats.m_Reloads++;
+	}
+
+	bool TextureLoader::ResizeImage( StreamingTexture& texture, uint32_t firstMip ) {
+		const ImageHandle newImage = CreateTextureImage( texture, firstMip );
+		if ( newImage == ImageHandle::Invalid ) {
+			printf( "[TextureLoader] No memory to resize %s, keeping its current levels\n", texture.m_Path.c_str() );
+			return false;
+		}
+		const uint32_t firstCopiedMip = std::max( texture.m_ResidentMip, firstMip );
+
+		m_Resizes.push_back( ImageResize{
+				.m_OldImage = texture.m_Image,
+				.m_OldFirstMip = texture.m_ImageFirstMip,
+				.m_NewImage = newImage,
+				.m_NewFirstMip = firstMip,
+				.m_FirstCopiedMip = firstCopiedMip,
+				.m_LevelCount = uint32_t( texture.m_Mips.size() )
+			} );
+
+		// Released with this frame, after RecordFrame's copy out of it and the last in-flight frame sampling it.
+		m_Device.ReleaseImage( texture.m_Image );
+
+		texture.m_Image = newImage;
+		texture.m_ImageFirstMip = firstMip;
+		texture.m_ResidentMip = firstCopiedMip;
+
+		SetView( texture, firstCopiedMip - firstMip );
+		return true;
+	}
+
+	uint32_t TextureLoader::GetTailLevel( const StreamingTexture& texture ) const {
+		for ( uint32_t level = 0; level < uint32_t( texture.m_Mips.size() ); level++ ) {
+			if ( std::max( texture.m_Mips[ level ].m_Width, texture.m_Mips[ level ].m_Height ) <= MipTailSize )
+				return level;
+		}
+
+		return uint32_t( texture.m_Mips.size() ) - 1;
+	}
+
+	uint32_t TextureLoader::GetNextLevel( const StreamingTexture& texture ) const {
+		if ( texture.m_ResidentMip < texture.m_Mips.size() )
+			return texture.m_ResidentMip - 1;
+
+		// The first step brings in the whole tail, a handful of tiny copies isn't worth a frame each.
+		return std::max( GetTailLevel( texture ), texture.m_ImageFirstMip );
+	}
+
+	vk::DeviceSize TextureLoader::GetLevelsSize( const StreamingTexture& texture, uint32_t firstMip, uint32_t endMip ) const {
+		vk::DeviceSize size = 0;
+		for ( uint32_t level = firstMip; level < endMip; level++ )
+			size += texture.m_Mips[ level ].m_Size;
+
+		return size;
+	}
+
+	vk::DeviceSize TextureLoader::GetNextStepSize( const StreamingTexture& texture ) const {
+		return GetLevelsSize( texture, GetNextLevel( texture ), texture.m_ResidentMip );
+	}
+
+	void TextureLoader::RequestResolution( ImageHandle slot, float pixels ) {
+		auto it = m_TexturesBySlot.find( slot );
+		if ( it == m_TexturesBySlot.end() )
+			return;
+
+		it->second->m_RequestedPixels = std::max( it->second->m_RequestedPixels, pixels );
+	}
+
+	uint32_t TextureLoader::GetWantedMip( const StreamingTexture& texture, float pixels ) const {
+		const uint32_t size = std::max( texture.m_Mips[ 0 ].m_Width, texture.m_Mips[ 0 ].m_Height );
+		const int32_t level = int32_t( std::floor( std::log2( float( size ) / std::max( pixels, 1.f ) ) ) ) - int32_t( ResolutionBias );
+
+		return uint32_t( std::clamp( level, 0, int32_t( GetTailLevel( texture ) ) ) );
+	}
+
+	void TextureLoader::UpdateWantedMips() {
+		for ( const std::unique_ptr<StreamingTexture>& texture : m_Textures ) {
+			// Requests made before the decode is back are kept for BeginStreaming.
+			if ( texture->m_RequestedPixels <= 0.f || texture->m_Mips.empty() )
+				continue;
+
+			texture->m_WantedMip = GetWantedMip( *texture, std::exchange( texture->m_RequestedPixels, 0.f ) );
+			texture->m_LastNeededFrame = m_FrameIndex;
+		}
+	}
+
+	void TextureLoader::EvictToBudget() {
+		vk::DeviceSize residentBytes = 0;
+		std::vector<StreamingTexture*> candidates;
+
+		for ( const std::unique_ptr<StreamingTexture>& texture : m_Textures ) {
+			if ( texture->m_Image == ImageHandle::Invalid )
+				continue;
+
+			residentBytes += GetLevelsSize( *texture, texture->m_ImageFirstMip, uint32_t( texture->m_Mips.size() ) );
+
+			// Reloading textures keep their image until the decode is back, streaming ones are still being filled.
+			if ( texture->m_State == EState::Resident && texture->m_ImageFirstMip < GetTailLevel( *texture ) )
+				candidates.push_back( texture.get() );
+		}
+
+		m_Stats.m_ResidentBytes = residentBytes;
+
+		auto overBudget = [ & ]() { return residentBytes > m_ResidencyBudget || m_Device.GetMemoryTracker().IsNearBudget(); };
+		if ( !overBudget() )
+			return;
+
+		std::sort( candidates.begin(), candidates.end(), []( const StreamingTexture* a, const StreamingTexture* b ) {
+			return a->m_LastNeededFrame < b->m_LastNeededFrame;
+		} );
+
+		auto evict = [ & ]( StreamingTexture& texture, uint32_t firstMip ) {
+			const vk::DeviceSize evictedBytes = GetLevelsSize( texture, texture.m_ImageFirstMip, firstMip );
+			if ( !ResizeImage( texture, firstMip ) )
+				return;
+
+			residentBytes -= evictedBytes;
+			m_Stats.m_Evictions++;
+		};
+
+		// Levels nothing on screen needs go first, then textures that weren't seen for a while drop to their tail.
+		for ( StreamingTexture* texture : candidates ) {
+			if ( !overBudget() )
+				break;
+
+			if ( texture->m_WantedMip > texture->m_ImageFirstMip )
+				evict( *texture, texture->m_WantedMip );
+		}
+
+		for ( StreamingTexture* texture : candidates ) {
+			if ( !overBudget() )
+				break;
+
+			const uint32_t tailLevel = GetTailLevel( *texture );
+			if ( m_FrameIndex - texture->m_LastNeededFrame > StaleFrames && texture->m_ImageFirstMip < tailLevel ) {
+				texture->m_WantedMip = tailLevel;
+				evict( *texture, tailLevel );
+			}
+		}
+
+		m_Stats.m_ResidentBytes = residentBytes;
+	}
+
+	void TextureLoader::StartReloads() {
+		std::vector<StreamingTexture*> candidates;
+		for ( const std::unique_ptr<StreamingTexture>& texture : m_Textures ) {
+			if ( texture->m_State == EState::Resident && texture->m_WantedMip < texture->m_ImageFirstMip )
+				candidates.push_back( texture.get() );
+		}
+
+		// Most recently needed first, growing only when it fits so eviction and reloads don't chase each other.
+		std::sort( candidates.begin(), candidates.end(), []( const StreamingTexture* a, const StreamingTexture* b ) {
+			return a->m_LastNeededFrame > b->m_LastNeededFrame;
+		} );
+
+		for ( StreamingTexture* texture : candidates ) {
+			if ( m_ReloadsInFlight >= MaxReloadsInFlight )
+				break;
+
+			const vk::DeviceSize growth = GetLevelsSize( *texture, texture->m_WantedMip, texture->m_ImageFirstMip );
+			if ( m_Stats.m_ResidentBytes + growth > m_ResidencyBudget || m_Device.GetMemoryTracker().IsNearBudget() )
+				continue;
+
+			m_Stats.m_ResidentBytes += growth;
+			m_ReloadsInFlight++;
+			texture->m_State = EState::Reloading;
+
+			m_ThreadPool.Submit( [ this, texture ]() { Decode( *texture ); } );
+		}
+	}
+
+	void TextureLoader::Update() {
+		m_FrameIndex++;
+
+		{
+			std::vector<StreamingTexture*> decoded;
+			{
+				std::scoped_lock lock( m_DecodedMutex );
+				decoded.swap( m_Decoded );
+			}
+
+			for ( StreamingTexture* texture : decoded ) {
+				if ( texture->m_State == EState::Reloading )
+					BeginReload( *texture );
+				else
+					BeginStreaming( *texture );
+			}
+		}
+
+		UpdateWantedMips();
+		EvictToBudget();
+		StartReloads();
+
+		if ( !m_Streaming.empty() )
+			UploadNextSteps();
+
+		if ( m_StatsPending && m_InFlightCount == 0 ) {
+			PrintStats();
+			m_StatsPending = false;
+		}
+	}
+
+	void TextureLoader::UploadNextSteps() {
+		// Smallest steps first, every texture gets a low resolution version before any of them gets its top level.
+		std::sort( m_Streaming.begin(), m_Streaming.end(), [ this ]( const StreamingTexture* a, const StreamingTexture* b ) {
+			return GetNextStepSize( *a ) < GetNextStepSize( *b );
+		} );
+
+		UploadBatch batch = UploadBatch( m_Device, EUploadMode::Async );
+		vk::DeviceSize uploadedSize = 0;
+
+		for ( StreamingTexture* texture : m_Streaming ) {
+			const vk::DeviceSize stepSize = GetNextStepSize( *texture );
+			if ( uploadedSize > 0 && uploadedSize + stepSize > UploadBudgetPerFrame )
+				break;
+
+			Image& image = m_Device.GetImage( texture->m_Image );
+			const uint32_t firstLevel = GetNextLevel( *texture );
+
+			batch.UploadImageLevels( image, firstLevel - texture->m_ImageFirstMip, texture->m_Mips.data() + firstLevel, texture->m_ResidentMip - firstLevel, texture->m_Pixels.data() );
+
+			texture->m_ResidentMip = firstLevel;
+			uploadedSize += stepSize;
+
+			// The frame picking up the table change waits on this batch, the new view never sees a level that isn't there yet.
+			SetView( *texture, firstLevel - texture->m_ImageFirstMip );
+
+			if ( firstLevel == texture->m_ImageFirstMip ) {
+				texture->m_Pixels = {};
+				texture->m_State = EState::Resident;
+
+				if ( !texture->m_Loaded ) {
+					texture->m_Loaded = true;
+					m_InFlightCount--;
+				}
+			}
+		}
+
+		batch.Submit();
+
+		std::erase_if( m_Streaming, []( const StreamingTexture* texture ) { return texture->m_State == EState::Resident; } );
+	}
+
+	void TextureLoader::RecordFrame( CommandBuffer& commandBuffer ) {
+		if ( !m_Resizes.empty() ) {
+			std::vector<vk::ImageMemoryBarrier2> before, after;
+
+			auto barrier = [ & ]( std::vector<vk::ImageMemoryBarrier2>& barriers, ImageHandle image, uint32_t baseMip, uint32_t levelCount,
+				vk::PipelineStageFlags2 srcStage, vk::AccessFlags2 srcAccess, vk::ImageLayout oldLayout,
+				vk::PipelineStageFlags2 dstStage, vk::AccessFlags2 dstAccess, vk::ImageLayout newLayout ) {
+				barriers.push_back( vk::ImageMemoryBarrier2{ srcStage, srcAccess, dstStage, dstAccess, oldLayout, newLayout,
+					VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, m_Device.GetImage( image ), { vk::ImageAspectFlagBits::eColor, baseMip, levelCount, 0, 1 } } );
+			};
+
+			for ( const ImageResize& resize : m_Resizes ) {
+				const uint32_t copiedLevels = resize.m_LevelCount - resize.m_FirstCopiedMip;
+				const uint32_t srcMip = resize.m_FirstCopiedMip - resize.m_OldFirstMip;
+				const uint32_t dstMip = resize.m_FirstCopiedMip - resize.m_NewFirstMip;
+
+				barrier( before, resize.m_OldImage, srcMip, copiedLevels,
+					vk::PipelineStageFlagBits2::eAllCommands, {}, vk::ImageLayout::eShaderReadOnlyOptimal,
+					vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferRead, vk::ImageLayout::eTransferSrcOptimal );
+				barrier( before, resize.m_NewImage, dstMip, copiedLevels,
+					vk::PipelineStageFlagBits2::eNone, {}, vk::ImageLayout::eUndefined,
+					vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal );
+				barrier( after, resize.m_NewImage, dstMip, copiedLevels,
+					vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::ImageLayout::eTransferDstOptimal,
+					vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead, vk::ImageLayout::eShaderReadOnlyOptimal );
+			}
+
+			vk::DependencyInfo dependencyInfo = {};
+			dependencyInfo.setImageMemoryBarriers( before );
+			commandBuffer->pipelineBarrier2( dependencyInfo );
+
+			for ( const ImageResize& resize : m_Resizes ) {
+				std::vector<vk::ImageCopy> regions;
+				for ( uint32_t level = resize.m_FirstCopiedMip; level < resize.m_LevelCount; level++ ) {
+					const Image& image = m_Device.GetImage( resize.m_NewImage );
+					const vk::Extent3D extent = { std::max( image.GetWidth() >> ( level - resize.m_NewFirstMip ), 1u ), std::max( image.GetHeight() >> ( level - resize.m_NewFirstMip ), 1u ), 1 };
+
+					regions.push_back( vk::ImageCopy{
+							{ vk::ImageAspectFlagBits::eColor, level - resize.m_OldFirstMip, 0, 1 }, {},
+							{ vk::ImageAspectFlagBits::eColor, level - resize.m_NewFirstMip, 0, 1 }, {},
+							extent
+						} );
+				}
+
+				commandBuffer->copyImage( m_Device.GetImage( resize.m_OldImage ), vk::ImageLayout::eTransferSrcOptimal, m_Device.GetImage( resize.m_NewImage ), vk::ImageLayout::eTransferDstOptimal, regions );
+			}
+
+			// The old images are released with this frame and never sampled again, they stay in TransferSrc.
+			dependencyInfo.setImageMemoryBarriers( after );
+			commandBuffer->pipelineBarrier2( dependencyInfo );
+			m_Resizes.clear();
+		}
+
+		if ( m_TableDirty && m_TextureTable != BufferHandle::Invalid ) {
+			// Frames still in flight read the previous table, the copy waits for them.
+			commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead, vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite );
+			m_Device.UploadBuffer( commandBuffer, m_Device.GetBuffer( m_TextureTable ), m_TableData.data(), m_TableData.size() * sizeof( uint32_t ) );
+			commandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eTransfer, vk::AccessFlagBits2::eTransferWrite, vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eShaderRead );
+			m_TableDirty = false;
+		}
+	}
+
+	void TextureLoader::PrintStats() const {
+		const uint32_t avoided = m_Stats.m_PathHits + m_Stats.m_ContentHits;
+		printf( "[TextureLoader] %u loads, %u unique textures, %u duplicate loads avoided (%u by path, %u by content)\n",
+			m_Stats.m_Loads, m_Stats.m_Textures, avoided, m_Stats.m_PathHits, m_Stats.m_ContentHits );
+		printf( "[TextureLoader] %.1f of %.1f MB resident, %u evictions, %u reloads\n",
+			m_Stats.m_ResidentBytes / ( 1024.0 * 1024.0 ), m_ResidencyBudget / ( 1024.0 * 1024.0 ), m_Stats.m_Evictions, m_Stats.m_Reloads );
+	}
+
+	uint32_t TextureLoader::PrintReferenced() const {
+		uint32_t referenced = 0;
+
+		for ( const std::unique_ptr<StreamingTexture>& texture : m_Textures ) {
+			if ( texture->m_RefCount == 0 )
+				continue;
+
+			printf( "[TextureLoader] %s still has %u references\n", texture->m_Path.c_str(), texture->m_RefCount );
+			referenced++;
+		}
+
+		return referenced;
+	}
+}
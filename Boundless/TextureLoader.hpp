@@ -0,0 +1,187 @@
+#pragma once
+#include "Device.hpp"
+#include "ThreadPool.hpp"
+#include "TextureCooker.hpp"
+#include "MipGenerator.hpp"
+
+namespace Boundless {
+	// Loads textures without stalling the caller and keeps them within a VRAM budget.
+	//
+	// Load returns a stable handle right away, a view of the usage's placeholder whose bindless slot is kept for the
+	// texture's lifetime. Shaders resolve it through the texture table (one uint per bindless slot, RESOLVE_TEXTURE in
+	// Bindless.hlsli) to the view currently covering the resident levels, materials never see a handle change.
+	//
+	// Files are decoded and mipped on the thread pool, the levels are then uploaded through async batches on the transfer
+	// queue, smallest first and within a per frame budget. Every upload step points the table at a view over the levels
+	// resident so far. Up to date cooked KTX2 files (see TextureCooker) are used instead of the source image when present.
+	//
+	// Residency: RequestResolution reports the screen size something sampling the texture covers, which gives the top
+	// level it needs. Past the budget, textures lose their top levels least recently needed first (copied down to a
+	// smaller image on the GPU, the mip tail always stays). Levels needed again are decoded from the file again and
+	// streamed back into a larger image.
+	//
+	// Textures are shared: loads are cached by canonical path and usage, with hashContents identical images found
+	// under different paths are merged once decoded, as long as the first one is still streaming and its bytes can be
+	// compared. Every Load takes a reference which is given back through Release.
+	class TextureLoader {
+	public:
+		struct Stats {
+			uint32_t	   m_Loads = 0;
+			uint32_t	   m_Textures = 0;	  // Unique textures currently alive.
+			uint32_t	   m_PathHits = 0;	  // Loads served by an already requested path.
+			uint32_t	   m_ContentHits = 0; // Decoded images merged into an identical one.
+			uint32_t	   m_Evictions = 0;	  // Textures shrunk to fit the budget.
+			uint32_t	   m_Reloads = 0;	  // Evicted levels streamed back in.
+			vk::DeviceSize m_ResidentBytes = 0;
+		};
+
+		TextureLoader( Device& device, ThreadPool& threadPool, bool hashContents = false );
+		~TextureLoader();
+
+		TextureLoader( const TextureLoader& ) = delete;
+		TextureLoader& operator=( const TextureLoader& ) = delete;
+
+		constexpr static const vk::DeviceSize UploadBudgetPerFrame = 16ull * 1024ull * 1024ull;
+		constexpr static const vk::DeviceSize DefaultResidencyBudget = 1024ull * 1024ull * 1024ull;
+		constexpr static const uint32_t MipTailSize = 128u;			// Levels this small and below go up in the first step and are never evicted.
+		constexpr static const uint32_t ResolutionBias = 1u;		// Extra levels kept above the one matching the screen size, UVs often tile.
+		constexpr static const uint32_t StaleFrames = 300u;			// Textures not needed for this long can be evicted down to their mip tail.
+		constexpr static const uint32_t MaxReloadsInFlight = 4u;
+
+		// Returns the texture's stable handle (the same one for every load of a cached texture), it shows the usage's
+		// placeholder until the file has streamed in. Invalid once the bindless image array is full.
+		ImageHandle Load( const std::string& path, ETextureUsage usage );
+		// Gives back a reference taken by Load, the texture is released with the current frame after the last one.
+		void Release( ImageHandle texture );
+
+		// Screen size in pixels of something sampling the texture, the largest request of a frame decides the top level
+		// the texture needs. Textures nobody requested yet are loaded in full.
+		void RequestResolution( ImageHandle texture, float pixels );
+		void SetResidencyBudget( vk::DeviceSize budget ) { m_ResidencyBudget = budget; }
+
+		// Call once per frame before Device::AcquireTransfers, so the frame waits on the levels submitted here.
+		void Update();
+		// Records the frame's GPU side evictions and texture table changes. Call after Device::AcquireTransfers and before
+		// anything samples material textures.
+		void RecordFrame( CommandBuffer& commandBuffer );
+
+		BufferHandle GetTextureTable() const { return m_TextureTable; }
+
+		bool IsIdle() const { return m_InFlightCount == 0; }
+		const Stats& GetStats() const { return m_Stats; }
+		void PrintStats() const;
+		// Logs every texture that still has references, returns how many. Finds Loads without a matching Release.
+		uint32_t PrintReferenced() const;
+	private:
+		using PathKey = std::pair<std::string, ETextureUsage>;
+		using ContentKey = std::pair<uint64_t, ETextureUsage>;
+
+		enum class EState {
+			Decoding,  // First decode in flight.
+			Streaming, // Uploading levels down to m_ImageFirstMip.
+			Resident,
+			Reloading, // Decoding again to bring evicted levels back, the current image stays bound meanwhile.
+			Failed
+		};
+
+		// Output of a decode task, only touched by the main thread once the texture shows up in m_Decoded.
+		struct DecodedImage {
+			std::vector<uint8_t>  m_Pixels; // Whole mip chain, tightly packed.
+			std::vector<MipLevel> m_Mips;
+			vk::Format			  m_Format = vk::Format::eUndefined;
+			vk::ComponentMapping  m_Swizzle = {};
+			uint64_t			  m_ContentHash = 0; // Only computed with hashContents.
+		};
+
+		struct StreamingTexture {
+			std::string				 m_Path;
+			ETextureUsage			 m_Usage = ETextureUsage::Albedo;
+			PathKey					 m_Key;
+			uint32_t				 m_RefCount = 1;
+			EState					 m_State = EState::Decoding;
+			bool					 m_Loaded = false;				   // Was fully resident once, counted out of m_InFlightCount.
+
+			std::vector<ImageHandle> m_Slots;						   // Stable handles resolving to this texture, more than one after content merges.
+			ImageHandle				 m_View = ImageHandle::Invalid;	   // What the slots resolve to, the placeholder slot until the first step.
+			ImageHandle				 m_Image = ImageHandle::Invalid;   // Holds levels m_ImageFirstMip and below.
+			uint32_t				 m_ImageFirstMip = 0;
+			uint32_t				 m_ResidentMip = 0;				   // First level visible through m_View, m_Mips.size() while nothing is.
+
+			// Layout of the full chain, kept for budgeting. Pixels are only kept while streaming.
+			std::vector<MipLevel>	 m_Mips;
+			std::vector<uint8_t>	 m_Pixels;
+			vk::Format				 m_Format = vk::Format::eUndefined;
+			vk::ComponentMapping	 m_Swizzle = {};
+			uint64_t				 m_ContentHash = 0;
+
+			float					 m_RequestedPixels = 0.f;		   // Largest request since the last Update.
+			uint32_t				 m_WantedMip = 0;
+			uint64_t				 m_LastNeededFrame = 0;
+
+			DecodedImage			 m_Decoded;
+		};
+
+		// Copy of the resident levels into a differently sized image, recorded by RecordFrame.
+		struct ImageResize {
+			ImageHandle m_OldImage;
+			uint32_t	m_OldFirstMip;
+			ImageHandle m_NewImage;
+			uint32_t	m_NewFirstMip;
+			uint32_t	m_FirstCopiedMip;
+			uint32_t	m_LevelCount; // Of the whole chain.
+		};
+
+		void CreatePlaceholders();
+		void CreateTextureTable();
+		void Decode( StreamingTexture& texture );
+		bool DecodeCooked( DecodedImage& decoded, const std::string& cookedPath );
+		void BeginStreaming( StreamingTexture& texture );
+		void BeginReload( StreamingTexture& texture );
+		bool MergeDuplicate( StreamingTexture& texture );
+		void Destroy( StreamingTexture& texture );
+		// Points the texture's slots at a new view of m_Image starting at baseMip.
+		void SetView( StreamingTexture& texture, uint32_t baseMip );
+		// False and nothing changes when the new image can't be allocated.
+		bool ResizeImage( StreamingTexture& texture, uint32_t firstMip );
+
+		void UpdateWantedMips();
+		void EvictToBudget();
+		void StartReloads();
+		void UploadNextSteps();
+
+		ImageHandle CreateTextureImage( const StreamingTexture& texture, uint32_t firstMip );
+		uint32_t GetTailLevel( const StreamingTexture& texture ) const;
+		uint32_t GetWantedMip( const StreamingTexture& texture, float pixels ) const;
+		uint32_t GetNextLevel( const StreamingTexture& texture ) const;
+		vk::DeviceSize GetNextStepSize( const StreamingTexture& texture ) const;
+		vk::DeviceSize GetLevelsSize( const StreamingTexture& texture, uint32_t firstMip, uint32_t endMip ) const;
+
+		Device&										   m_Device;
+		ThreadPool&									   m_ThreadPool;
+		bool										   m_HashContents;
+		std::array<ImageHandle, size_t( ETextureUsage::Count )> m_Placeholders = {};
+
+		std::vector<std::unique_ptr<StreamingTexture>> m_Textures;
+		std::vector<StreamingTexture*>				   m_Streaming;
+		std::vector<ImageResize>					   m_Resizes;
+		uint32_t									   m_InFlightCount = 0; // Requested and not fully resident yet.
+		uint32_t									   m_ReloadsInFlight = 0;
+		bool										   m_StatsPending = false;
+
+		vk::DeviceSize								   m_ResidencyBudget = DefaultResidencyBudget;
+		uint64_t									   m_FrameIndex = 0;
+
+		// Bindless slot -> bindless index of the view it resolves to, mirrored on the GPU by m_TextureTable.
+		std::vector<uint32_t>						   m_TableData;
+		BufferHandle								   m_TextureTable = BufferHandle::Invalid;
+		bool										   m_TableDirty = false;
+
+		std::map<PathKey, StreamingTexture*>		   m_PathCache;
+		std::map<ContentKey, StreamingTexture*>		   m_ContentCache;
+		std::map<ImageHandle, StreamingTexture*>	   m_TexturesBySlot;
+		Stats										   m_Stats;
+
+		std::mutex									   m_DecodedMutex;
+		std::vector<StreamingTexture*>				   m_Decoded;
+	};
+}
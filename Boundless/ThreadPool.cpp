@@ -0,0 +1,115 @@
+#include "Pch.hpp"
+#include "ThreadPool.hpp"
+
+namespace Boundless {
+	ThreadPool::ThreadPool( uint32_t threadCount ) {
+		if ( threadCount == 0 )
+			threadCount = std::max( std::thread::hardware_concurrency(), 2u ) - 1;
+
+		m_Workers.reserve( threadCount );
+		for ( uint32_t i = 0; i < threadCount; i++ )
+			m_Workers.emplace_back( [ this ]( std::stop_token stopToken ) { WorkerLoop( stopToken ); } );
+	}
+
+	ThreadPool::~ThreadPool() {
+		for ( std::jthread& worker : m_Workers )
+			worker.request_stop();
+
+		m_TaskAvailable.notify_all();
+		m_Workers.clear();
+	}
+
+	void ThreadPool::Submit( std::function<void()> task ) {
+		{
+			std::scoped_lock lock( m_Mutex );
+			m_Tasks.push_back( std::move( task ) );
+			m_ActiveTasks++;
+		}
+
+		m_TaskAvailable.notify_one();
+	}
+
+	void ThreadPool::WaitIdle() {
+		std::unique_lock lock( m_Mutex );
+		m_TasksDone.wait( lock, [ this ] { return m_ActiveTasks == 0; } );
+	}
+
+	void ThreadPool::ParallelFor( uint32_t count, const std::function<void( uint32_t begin, uint32_t end )>& func, uint32_t minBatchSize ) {
+		if ( count == 0 )
+			return;
+
+		uint32_t batchCount = std::min( GetThreadCount() + 1, ( count + minBatchSize - 1 ) / std::max( minBatchSize, 1u ) );
+		if ( batchCount <= 1 ) {
+			func( 0, count );
+			return;
+		}
+
+		uint32_t batchSize = ( count + batchCount - 1 ) / batchCount;
+
+		// Batches are claimed from a counter of this call only. Workers pick them up when they're free, the calling thread
+		// claims whatever is left instead of running unrelated queued tasks (texture decodes) or waiting behind them.
+		struct Batches {
+			std::atomic<uint32_t> m_Next = 0;
+			std::atomic<uint32_t> m_Remaining = 0;
+		};
+
+		std::shared_ptr<Batches> batches = std::make_shared<Batches>();
+		batches->m_Remaining = batchCount;
+
+		// Helpers dequeued after the call returned find nothing left to claim, func is only touched while it waits.
+		auto runBatches = [ batches, &func, batchCount, batchSize, count ] {
+			for ( uint32_t batch = batches->m_Next.fetch_add( 1 ); batch < batchCount; batch = batches->m_Next.fetch_add( 1 ) ) {
+				uint32_t begin = batch * batchSize;
+				uint32_t end = std::min( begin + batchSize, count );
+
+				if ( begin < end )
+					func( begin, end );
+
+				batches->m_Remaining.fetch_sub( 1, std::memory_order_release );
+			}
+		};
+
+		for ( uint32_t helper = 1; helper < batchCount; helper++ )
+			Submit( runBatches );
+
+		runBatches();
+
+		// Only batches already running on workers are left.
+		while ( batches->m_Remaining.load( std::memory_order_acquire ) != 0 )
+			std::this_thread::yield();
+	}
+
+	bool ThreadPool::TryRunTask() {
+		std::function<void()> task;
+		{
+			std::scoped_lock lock( m_Mutex );
+			if ( m_Tasks.empty() )
+				return false;
+
+			task = std::move( m_Tasks.front() );
+			m_Tasks.pop_front();
+		}
+
+		task();
+
+		{
+			std::scoped_lock lock( m_Mutex );
+			m_ActiveTasks--;
+		}
+
+		m_TasksDone.notify_all();
+		return true;
+	}
+
+	void ThreadPool::WorkerLoop( std::stop_token stopToken ) {
+		while ( !stopToken.stop_requested() ) {
+			{
+				std::unique_lock lock( m_Mutex );
+				if ( !m_TaskAvailable.wait( lock, stopToken, [ this ] { return !m_Tasks.empty(); } ) )
+					return;
+			}
+
+			TryRunTask();
+		}
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "Pch.hpp"
+
+namespace Boundless {
+	// Fixed size pool of worker threads. Tasks are plain functions pulled from a shared queue.
+	class ThreadPool {
+	public:
+		// threadCount = 0 uses one worker per hardware thread, minus the calling thread.
+		explicit ThreadPool( uint32_t threadCount = 0 );
+		~ThreadPool();
+
+		ThreadPool( const ThreadPool& ) = delete;
+		ThreadPool& operator=( const ThreadPool& ) = delete;
+
+		void Submit( std::function<void()> task );
+		void WaitIdle();
+
+		// Splits [0, count) into batches of at least minBatchSize and blocks until all of them ran.
+		// The calling thread runs every batch no worker picked up yet, never other queued tasks, so it is safe to call
+		// from the main thread with any pool size and while long running tasks occupy the workers.
+		void ParallelFor( uint32_t count, const std::function<void( uint32_t begin, uint32_t end )>& func, uint32_t minBatchSize = 1 );
+
+		uint32_t GetThreadCount() const { return uint32_t( m_Workers.size() ); }
+	private:
+		void WorkerLoop( std::stop_token stopToken );
+		bool TryRunTask();
+
+		std::vector<std::jthread>		  m_Workers;
+		std::deque<std::function<void()>> m_Tasks;
+		std::mutex						  m_Mutex;
+		std::condition_variable_any		  m_TaskAvailable;
+		std::condition_variable			  m_TasksDone;
+		uint32_t						  m_ActiveTasks = 0;
+	};
+}
@@ -4,6 +4,7 @@
 namespace Boundless {
 	// TODO: finish...
 	class Transform {
+		friend class SceneSerializer;
 	public:
 		glm::mat4  m_LocalTransform = glm::mat4(1.f);
 		glm::mat4  m_WorldTransform = glm::mat4(1.f);
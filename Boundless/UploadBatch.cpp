@@ -0,0 +1,208 @@
+#include "Pch.hpp"
+#include "UploadBatch.hpp"
+#include "Device.hpp"
+
+namespace Boundless {
+	UploadBatch::UploadBatch( Device& device, EUploadMode mode ) : m_Device( device ), m_Mode( mode ) {
+		Begin();
+	}
+
+	UploadBatch::~UploadBatch() {
+		// Command buffers belong to the device (async) or go back to the command buffer manager once submitted.
+		if ( m_Recording )
+			Submit();
+	}
+
+	void UploadBatch::Begin() {
+		if ( m_Mode == EUploadMode::Async ) {
+			m_CommandBuffer = CommandBuffer( m_Device, m_Device.GetTransferCommandPool() );
+			m_CommandBuffer.Begin( vk::CommandBufferUsageFlagBits::eOneTimeSubmit );
+		} else {
+			m_CommandBuffer = m_Device.GetCommandBuffers().BeginOneShot();
+			m_RingBatch = m_Device.GetUploadRing().BeginBatch();
+		}
+
+		m_Recording = true;
+	}
+
+	void UploadBatch::UploadBuffer( const vk::Buffer& destination, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset ) {
+		if ( size == 0 )
+			return;
+
+		UploadAllocation allocation = Stage( data, size );
+		m_CommandBuffer.CopyBuffer( allocation.m_Buffer, destination, size, allocation.m_Offset, dstOffset );
+
+		if ( m_Mode == EUploadMode::Async && m_Device.HasDedicatedTransferQueue() ) {
+			vk::BufferMemoryBarrier2 barrier = {};
+			barrier.srcQueueFamilyIndex = m_Device.GetTransferQueueIndex();
+			barrier.dstQueueFamilyIndex = m_Device.GetQueueIndex();
+			barrier.buffer = destination;
+			barrier.offset = dstOffset;
+			barrier.size = size;
+
+			// Release on the transfer queue, the destination half of it is ignored.
+			barrier.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+			barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+			m_ReleaseBarriers.m_Buffers.push_back( barrier );
+
+			// Acquire on the graphics queue, the source half of it is ignored.
+			barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+			barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+			barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+			barrier.dstAccessMask = vk::AccessFlagBits2::eMemoryRead;
+			m_AcquireBarriers.m_Buffers.push_back( barrier );
+		}
+	}
+
+	void UploadBatch::UploadBuffer( Buffer& destination, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset ) {
+		if ( size == 0 )
+			return;
+
+		// Host writes are visible to everything submitted afterwards, the batch's submit included.
+		if ( destination.GetMappedData() ) {
+			destination.Write( data, size, dstOffset );
+			return;
+		}
+
+		UploadBuffer( destination.GetHandle(), data, size, dstOffset );
+	}
+
+	void UploadBatch::UploadImage( const vk::Image& image, uint32_t mipLevel, uint32_t width, uint32_t height, const void* data, vk::DeviceSize size ) {
+		const MipLevel level = { width, height, 0, size_t( size ) };
+		UploadImageLevels( image, mipLevel, &level, 1, static_cast<const uint8_t*>( data ) );
+	}
+
+	void UploadBatch::UploadImageLevels( const vk::Image& image, uint32_t baseMipLevel, const MipLevel* levels, uint32_t levelCount, const uint8_t* pixels ) {
+		size_t begin = std::numeric_limits<size_t>::max(), end = 0;
+		for ( uint32_t i = 0; i < levelCount; i++ ) {
+			begin = std::min( begin, levels[ i ].m_Offset );
+			end = std::max( end, levels[ i ].m_Offset + levels[ i ].m_Size );
+		}
+
+		if ( levelCount == 0 || end == begin )
+			return;
+
+		// One span covering every level, padding between them (KTX2 aligns levels) is copied along.
+		UploadAllocation allocation = Stage( pixels + begin, vk::DeviceSize( end - begin ) );
+
+		std::vector<vk::BufferImageCopy> regions( levelCount );
+		for ( uint32_t i = 0; i < levelCount; i++ ) {
+			regions[ i ].bufferOffset = allocation.m_Offset + ( levels[ i ].m_Offset - begin );
+			regions[ i ].imageSubresource = vk::ImageSubresourceLayers{ vk::ImageAspectFlagBits::eColor, baseMipLevel + i, 0, 1 };
+			regions[ i ].imageExtent = vk::Extent3D{ levels[ i ].m_Width, levels[ i ].m_Height, 1 };
+		}
+
+		vk::ImageMemoryBarrier2 barrier = {};
+		barrier.image = image;
+		barrier.subresourceRange = vk::ImageSubresourceRange{ vk::ImageAspectFlagBits::eColor, baseMipLevel, levelCount, 0, 1 };
+
+		// The level is overwritten as a whole, no need to keep what was in it.
+		barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+		barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+		barrier.dstStageMask = vk::PipelineStageFlagBits2::eTransfer;
+		barrier.dstAccessMask = vk::AccessFlagBits2::eTransferWrite;
+		barrier.oldLayout = vk::ImageLayout::eUndefined;
+		barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+
+		vk::DependencyInfo dependencyInfo = {};
+		dependencyInfo.setImageMemoryBarriers( barrier );
+		m_CommandBuffer->pipelineBarrier2( dependencyInfo );
+
+		m_CommandBuffer->copyBufferToImage( allocation.m_Buffer, image, vk::ImageLayout::eTransferDstOptimal, regions );
+
+		barrier.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+		barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+		barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+		barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+		if ( m_Mode == EUploadMode::Async && m_Device.HasDedicatedTransferQueue() ) {
+			barrier.srcQueueFamilyIndex = m_Device.GetTransferQueueIndex();
+			barrier.dstQueueFamilyIndex = m_Device.GetQueueIndex();
+
+			// Release and acquire have to agree on the layout transition, it happens once between the two.
+			barrier.dstStageMask = vk::PipelineStageFlagBits2::eNone;
+			barrier.dstAccessMask = vk::AccessFlagBits2::eNone;
+			m_ReleaseBarriers.m_Images.push_back( barrier );
+
+			barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+			barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+			barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+			barrier.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead;
+			m_AcquireBarriers.m_Images.push_back( barrier );
+			return;
+		}
+
+		barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+		barrier.dstAccessMask = vk::AccessFlagBits2::eShaderSampledRead;
+		m_CommandBuffer->pipelineBarrier2( dependencyInfo );
+	}
+
+	UploadAllocation UploadBatch::Stage( const void* data, vk::DeviceSize size ) {
+		// Ring slices are retired with graphics frames, which say nothing about the transfer queue.
+		if ( m_Mode == EUploadMode::Blocking ) {
+			UploadAllocation allocation = m_Device.GetUploadRing().Allocate( size, UploadRing::DefaultAlignment, m_RingBatch );
+			if ( allocation.IsValid() ) {
+				memcpy( allocation.m_Data, data, size_t( size ) );
+				return allocation;
+			}
+		}
+
+		// Keep the host memory held by pending staging buffers bounded on big scenes.
+		if ( m_PendingStagingSize + size > MaxPendingStagingSize && !m_StagingBuffers.empty() )
+			Flush();
+
+		std::unique_ptr<StagingBuffer> stagingBuffer = m_Device.CreateStagingBuffer( size );
+		stagingBuffer->Patch( data, size_t( size ) );
+
+		UploadAllocation allocation = { stagingBuffer->GetHandle(), 0, size, stagingBuffer->GetMappedData() };
+
+		m_PendingStagingSize += size;
+		m_StagingBuffers.push_back( std::move( stagingBuffer ) );
+
+		return allocation;
+	}
+
+	void UploadBatch::Flush() {
+		Submit();
+		Begin();
+	}
+
+	uint64_t UploadBatch::Submit() {
+		if ( !m_Recording )
+			return 0;
+
+		m_Recording = false;
+		m_PendingStagingSize = 0;
+
+		if ( m_Mode == EUploadMode::Async ) {
+			if ( !m_ReleaseBarriers.IsEmpty() ) {
+				vk::DependencyInfo dependencyInfo = {};
+				dependencyInfo.setBufferMemoryBarriers( m_ReleaseBarriers.m_Buffers )
+					.setImageMemoryBarriers( m_ReleaseBarriers.m_Images );
+				m_CommandBuffer->pipelineBarrier2( dependencyInfo );
+			}
+
+			m_CommandBuffer.End();
+
+			uint64_t timelineValue = m_Device.SubmitTransfer( m_CommandBuffer, std::move( m_AcquireBarriers ), std::move( m_StagingBuffers ) );
+
+			m_ReleaseBarriers = {};
+			m_AcquireBarriers = {};
+			m_StagingBuffers.clear();
+
+			return timelineValue;
+		}
+
+		// Make the uploads visible to whatever is submitted after the batch.
+		m_CommandBuffer.StageBarrier( vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eMemoryWrite, vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eMemoryRead );
+		m_Device.GetCommandBuffers().SubmitOneShot( m_CommandBuffer );
+
+		// The GPU is done with these, no need to go through the deferred release queue.
+		m_Device.GetUploadRing().RetireBatch( m_RingBatch );
+		for ( std::unique_ptr<StagingBuffer>& stagingBuffer : m_StagingBuffers )
+			stagingBuffer->Release();
+
+		m_StagingBuffers.clear();
+		return 0;
+	}
+}
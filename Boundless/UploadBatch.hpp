@@ -0,0 +1,71 @@
+#pragma once
+#include "CommandBuffer.hpp"
+#include "UploadRing.hpp"
+#include "MipGenerator.hpp"
+
+namespace Boundless {
+	class Device;
+
+	enum class EUploadMode {
+		Blocking, // Graphics queue, one-shot command buffer from the CommandBufferManager which Submit waits on.
+		Async	  // Transfer queue, Submit returns right away and the next frame waits on the transfer timeline.
+	};
+
+	// Queue family ownership acquires of an async batch, recorded on the graphics queue by Device::AcquireTransfers.
+	struct OwnershipBarriers {
+		std::vector<vk::BufferMemoryBarrier2> m_Buffers;
+		std::vector<vk::ImageMemoryBarrier2>  m_Images;
+
+		bool IsEmpty() const { return m_Buffers.empty() && m_Images.empty(); }
+	};
+
+	// Collects copies (and anything else recorded into GetCommandBuffer, e.g. BLAS builds) into one command buffer,
+	// submitted once instead of a queue drain per upload.
+	// Blocking batches go through the upload ring, their ring slices and the staging buffers used when it is full are
+	// freed right after the submit finished. Async batches always use their own staging buffers, they are freed once the transfer
+	// timeline passes the submission. Async batches can only record transfer commands.
+	class UploadBatch {
+	public:
+		explicit UploadBatch( Device& device, EUploadMode mode = EUploadMode::Blocking );
+		~UploadBatch();
+
+		UploadBatch( const UploadBatch& ) = delete;
+		UploadBatch& operator=( const UploadBatch& ) = delete;
+
+		void UploadBuffer( const vk::Buffer& destination, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0 );
+		// Mapped destinations (host visible VRAM, see Buffer::Desc::m_HostWrite) are written right away without a copy.
+		// No frame in flight may be reading the written range.
+		void UploadBuffer( Buffer& destination, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0 );
+		// Writes one level of a 2D color image and leaves it in ShaderReadOnlyOptimal, the contents of the level are discarded
+		// first. Other levels aren't touched, so an image can be filled a few levels at a time.
+		void UploadImage( const vk::Image& image, uint32_t mipLevel, uint32_t width, uint32_t height, const void* data, vk::DeviceSize size );
+		// Same for levels baseMipLevel up to baseMipLevel + levelCount, with a single staging allocation, copy and barrier pair.
+		// Level i is read from pixels + levels[ i ].m_Offset, the levels may be stored in any order.
+		void UploadImageLevels( const vk::Image& image, uint32_t baseMipLevel, const MipLevel* levels, uint32_t levelCount, const uint8_t* pixels );
+
+		CommandBuffer& GetCommandBuffer() { return m_CommandBuffer; }
+
+		// Submits everything recorded so far, the batch can keep recording afterwards.
+		void Flush();
+		// Returns the transfer timeline value of async batches, 0 for blocking ones.
+		uint64_t Submit();
+	private:
+		constexpr static const vk::DeviceSize MaxPendingStagingSize = 256ull * 1024ull * 1024ull;
+
+		void Begin();
+		// Copies data into memory the batch's copies can read from, the upload ring or a batch owned staging buffer.
+		UploadAllocation Stage( const void* data, vk::DeviceSize size );
+
+		Device&										m_Device;
+		EUploadMode									m_Mode;
+		CommandBuffer								m_CommandBuffer;
+		bool										m_Recording = false;
+		uint64_t									m_RingBatch = 0; // Upload ring id of blocking batches, see UploadRing::BeginBatch.
+		vk::DeviceSize								m_PendingStagingSize = 0;
+		std::vector<std::unique_ptr<StagingBuffer>> m_StagingBuffers;
+
+		// Queue family ownership transfer, only used when async uploads run on a dedicated transfer family.
+		OwnershipBarriers							m_ReleaseBarriers;
+		OwnershipBarriers							m_AcquireBarriers;
+	};
+}
@@ -0,0 +1,86 @@
+#include "Pch.hpp"
+#include "UploadRing.hpp"
+#include "Device.hpp"
+
+namespace Boundless {
+	void UploadRing::Create( Device& device, vk::DeviceSize capacity ) {
+		m_Buffer = device.CreateBuffer( Buffer::Desc{
+				.m_Size = capacity,
+				.m_Usage = vk::BufferUsageFlagBits::eTransferSrc,
+				.m_MemoryUsage = VMA_MEMORY_USAGE_AUTO,
+				.m_Mappable = true,
+				.m_Category = EMemoryCategory::Staging
+			} );
+
+		if ( m_Buffer == BufferHandle::Invalid ) {
+			printf( "[UploadRing] Failed to allocate %llu byte upload ring, all uploads will use staging buffers\n", capacity );
+			return;
+		}
+
+		Buffer& buffer = device.GetBuffer( m_Buffer );
+		m_BufferHandle = buffer.GetHandle();
+		m_MappedData = static_cast<uint8_t*>( buffer.GetMappedData() );
+		m_Capacity = m_MappedData ? capacity : 0;
+
+		if ( !m_MappedData )
+			printf( "[UploadRing] Failed to map %llu byte upload ring, all uploads will use staging buffers\n", capacity );
+	}
+
+	void UploadRing::Release( Device& device ) {
+		if ( m_Buffer != BufferHandle::Invalid )
+			device.ReleaseBuffer( m_Buffer );
+
+		*this = UploadRing{};
+	}
+
+	UploadAllocation UploadRing::Allocate( vk::DeviceSize size, vk::DeviceSize alignment, uint64_t batch ) {
+		if ( size == 0 || size > m_Capacity )
+			return {};
+
+		uint64_t start = ( m_Head + alignment - 1 ) / alignment * alignment;
+
+		// Slices never straddle the end of the buffer, skip the remainder and start over at offset 0.
+		if ( start % m_Capacity + size > m_Capacity )
+			start = ( start / m_Capacity + 1 ) * m_Capacity;
+
+		if ( start + size - m_Tail > m_Capacity )
+			return {};
+
+		m_Head = start + size;
+
+		if ( m_Markers.empty() || m_Markers.back().m_FrameIndex != m_FrameIndex || m_Markers.back().m_Batch != batch )
+			m_Markers.push_back( Marker{ m_FrameIndex, batch, m_Head } );
+		else
+			m_Markers.back().m_Head = m_Head;
+
+		const vk::DeviceSize offset = start % m_Capacity;
+		return UploadAllocation{ m_BufferHandle, offset, size, m_MappedData + offset };
+	}
+
+	void UploadRing::RetireBatch( uint64_t batch ) {
+		for ( Marker& marker : m_Markers ) {
+			if ( marker.m_Batch == batch )
+				marker.m_Retired = true;
+		}
+
+		Reclaim();
+	}
+
+	void UploadRing::BeginFrame( uint64_t frameIndex, uint64_t completedFrames ) {
+		m_FrameIndex = frameIndex;
+
+		for ( Marker& marker : m_Markers ) {
+			if ( marker.m_Batch == 0 && marker.m_FrameIndex < completedFrames )
+				marker.m_Retired = true;
+		}
+
+		Reclaim();
+	}
+
+	void UploadRing::Reclaim() {
+		while ( !m_Markers.empty() && m_Markers.front().m_Retired ) {
+			m_Tail = m_Markers.front().m_Head;
+			m_Markers.pop_front();
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "Buffer.hpp"
+
+namespace Boundless {
+	class Device;
+
+	// Slice of the upload ring. m_Data is CPU visible for the lifetime of the recording frame.
+	struct UploadAllocation {
+		vk::Buffer	   m_Buffer = VK_NULL_HANDLE;
+		vk::DeviceSize m_Offset = 0;
+		vk::DeviceSize m_Size = 0;
+		void*		   m_Data = nullptr;
+
+		bool IsValid() const { return m_Data != nullptr; }
+	};
+
+	// One persistently mapped buffer handed out as a ring. Allocations are tagged with the frame that made
+	// them and the space is reclaimed once that frame's fence has signaled (see Device::BeginFrame). Blocking
+	// UploadBatches allocate under their own batch id and give their slices back as soon as their submit was waited on,
+	// so loads that never advance the frame don't run the ring dry. Space is still reclaimed in order, up to the
+	// oldest slice in use.
+	// Positions are monotonic byte counters, the physical offset is position % capacity.
+	class UploadRing {
+	public:
+		constexpr static const vk::DeviceSize DefaultAlignment = 16;
+
+		void Create( Device& device, vk::DeviceSize capacity );
+		void Release( Device& device );
+
+		// Returns an invalid allocation when the ring is full or the payload is too big, the caller then uses a staging buffer.
+		// batch is an id from BeginBatch, 0 ties the allocation to the current frame.
+		UploadAllocation Allocate( vk::DeviceSize size, vk::DeviceSize alignment = DefaultAlignment, uint64_t batch = 0 );
+
+		uint64_t BeginBatch() { return m_NextBatch++; }
+		// The GPU is done with everything the batch allocated.
+		void RetireBatch( uint64_t batch );
+
+		void BeginFrame( uint64_t frameIndex, uint64_t completedFrames );
+
+		vk::DeviceSize GetCapacity() const { return m_Capacity; }
+		vk::DeviceSize GetUsedSize() const { return m_Head - m_Tail; }
+	private:
+		// End of a run of allocations made by one frame or batch.
+		struct Marker {
+			uint64_t m_FrameIndex;
+			uint64_t m_Batch;
+			uint64_t m_Head;
+			bool	 m_Retired = false;
+		};
+
+		// Moves the tail past the retired markers at the front.
+		void Reclaim();
+
+		BufferHandle			m_Buffer = BufferHandle::Invalid;
+		vk::Buffer				m_BufferHandle = VK_NULL_HANDLE;
+		uint8_t*				m_MappedData = nullptr;
+		vk::DeviceSize			m_Capacity = 0;
+		uint64_t				m_Head = 0;
+		uint64_t				m_Tail = 0;
+		uint64_t				m_FrameIndex = 0;
+		uint64_t				m_NextBatch = 1;
+		std::deque<Marker>		m_Markers;
+	};
+}
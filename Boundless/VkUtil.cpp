@@ -55,17 +55,23 @@ namespace vk_util {
 			return VK_NULL_HANDLE;
 		}
 
-		for ( const vk::PhysicalDevice& device : devices ) {
-			vk::PhysicalDeviceProperties deviceProps = device.getProperties();
+		// Discrete GPUs first, integrated ones (unified memory) and CPU implementations only when there is nothing better.
+		const std::array<vk::PhysicalDeviceType, 3> preferredTypes = { vk::PhysicalDeviceType::eDiscreteGpu, vk::PhysicalDeviceType::eIntegratedGpu, vk::PhysicalDeviceType::eCpu };
 
-			if ( deviceProps.deviceType != vk::PhysicalDeviceType::eDiscreteGpu || !PhysicalDeviceHasExtensions( device, wantedExtensions ) )
-				continue;
+		for ( vk::PhysicalDeviceType type : preferredTypes ) {
+			for ( const vk::PhysicalDevice& device : devices ) {
+				vk::PhysicalDeviceProperties deviceProps = device.getProperties();
 
-			printf( "Using %s\n", deviceProps.deviceName.data() );
+				if ( deviceProps.deviceType != type || !PhysicalDeviceHasExtensions( device, wantedExtensions ) )
+					continue;
 
-			return device;
+				printf( "Using %s (%s)\n", deviceProps.deviceName.data(), vk::to_string( type ).c_str() );
+
+				return device;
+			}
 		}
 
+		printf( "Failed to find a GPU supporting the required extensions\n" );
 		return VK_NULL_HANDLE;
 	}
 
@@ -105,12 +111,21 @@ namespace vk_util {
 
 		float queuePriority = 1.0f;
 
-		vk::DeviceQueueCreateInfo queueCreateInfo = {};
-		queueCreateInfo.setQueueFamilyIndex( queueFamilyIndex )
+		std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos = {};
+		queueCreateInfos.push_back( vk::DeviceQueueCreateInfo{}
+			.setQueueFamilyIndex( queueFamilyIndex )
 			.setQueueCount( 1 )
-			.setPQueuePriorities( &queuePriority );
+			.setPQueuePriorities( &queuePriority ) );
+
+		uint32_t transferQueueFamilyIndex = FindTransferQueueFamilyIndex( physicalDevice );
+		if ( transferQueueFamilyIndex != vk::QueueFamilyIgnored ) {
+			queueCreateInfos.push_back( vk::DeviceQueueCreateInfo{}
+				.setQueueFamilyIndex( transferQueueFamilyIndex )
+				.setQueueCount( 1 )
+				.setPQueuePriorities( &queuePriority ) );
+		}
 
-		deviceCreateInfo.setQueueCreateInfos( queueCreateInfo );
+		deviceCreateInfo.setQueueCreateInfos( queueCreateInfos );
 		deviceCreateInfo.setEnabledLayerCount( 0 );
 
 		vk::PhysicalDeviceVulkan14Features& features14 = featuresChain.get<vk::PhysicalDeviceVulkan14Features>();
@@ -122,6 +137,7 @@ namespace vk_util {
 
 		// Implement 1.4 features.
 		features14.maintenance5 = testFeatures14.maintenance5;
+		features14.hostImageCopy = testFeatures14.hostImageCopy;
 
 		// Implement 1.3 features.
 		features13.dynamicRendering = testFeatures13.dynamicRendering;
@@ -136,7 +152,10 @@ namespace vk_util {
 		features12.runtimeDescriptorArray					  = testFeatures12.runtimeDescriptorArray;
 		features12.descriptorBindingVariableDescriptorCount	  = testFeatures12.descriptorBindingVariableDescriptorCount;
 		features12.descriptorBindingPartiallyBound			  = testFeatures12.descriptorBindingPartiallyBound;
+		features12.descriptorBindingUpdateUnusedWhilePending  = testFeatures12.descriptorBindingUpdateUnusedWhilePending;
 		features12.bufferDeviceAddress						  = testFeatures12.bufferDeviceAddress;
+		features12.drawIndirectCount						  = testFeatures12.drawIndirectCount;
+		features12.timelineSemaphore						  = testFeatures12.timelineSemaphore;
 
 		// Implement 1.1 features.
 		features11.shaderDrawParameters = vk::True;
@@ -186,6 +205,18 @@ namespace vk_util {
 		return vk::QueueFamilyIgnored;
 	}
 
+	uint32_t FindTransferQueueFamilyIndex( const vk::PhysicalDevice& physicalDevice ) {
+		std::vector<vk::QueueFamilyProperties> queueFamilies = physicalDevice.getQueueFamilyProperties();
+		for ( size_t i = 0; i < queueFamilies.size(); i++ ) {
+			vk::QueueFlags flags = queueFamilies[ i ].queueFlags;
+
+			if ( ( flags & vk::QueueFlagBits::eTransfer ) && !( flags & ( vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute ) ) )
+				return uint32_t( i );
+		}
+
+		return vk::QueueFamilyIgnored;
+	}
+
 	vk::SwapchainKHR CreateSwapchain( const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const vk::SurfaceKHR& surface, const HWND& windowHandle, vk::Extent2D& outExtents, vk::Format& outImageFormat ) {
 		vk::SurfaceCapabilitiesKHR surfaceCapabilities = physicalDevice.getSurfaceCapabilitiesKHR( surface );
 		std::vector<vk::SurfaceFormatKHR> surfaceFormats = physicalDevice.getSurfaceFormatsKHR( surface );
@@ -277,11 +308,11 @@ namespace vk_util {
 		return colorAttachment;
 	}
 
-	vk::RenderingAttachmentInfo RenderPassGetDepthAttachmentInfo( const vk::ImageView& view, vk::ImageLayout layout ) {
+	vk::RenderingAttachmentInfo RenderPassGetDepthAttachmentInfo( const vk::ImageView& view, vk::ImageLayout layout, bool clear ) {
 		vk::RenderingAttachmentInfo depthAttachment = {};
 		depthAttachment.setImageView(view)
 			.setImageLayout(layout)
-			.setLoadOp(vk::AttachmentLoadOp::eClear)
+			.setLoadOp(clear ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad)
 			.setStoreOp(vk::AttachmentStoreOp::eStore)
 			.setClearValue( { vk::ClearDepthStencilValue{ 1.f, 0u } } );
 
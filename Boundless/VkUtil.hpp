@@ -24,6 +24,8 @@ namespace vk_util {
 
 	// Surface & Physical Device Helpers...
 	uint32_t FindQueueFamilyIndex( const vk::SurfaceKHR& surface, const vk::PhysicalDevice& physicalDevice );
+	// Transfer only family (DMA engine), QueueFamilyIgnored when the device doesn't have one.
+	uint32_t FindTransferQueueFamilyIndex( const vk::PhysicalDevice& physicalDevice );
 
 	// Swapchain Helpers...
 	vk::SwapchainKHR CreateSwapchain( const vk::Device& device, const vk::PhysicalDevice& physicalDevice, const vk::SurfaceKHR& surface, const HWND& windowHandle, vk::Extent2D& outExtents, vk::Format& outImageFormat );
@@ -33,7 +35,7 @@ namespace vk_util {
 
 	// Render Pass Helpers...
 	vk::RenderingAttachmentInfo RenderPassGetColorAttachmentInfo( const vk::ImageView& view, vk::ClearValue* clear, vk::ImageLayout layout, vk::ResolveModeFlagBits resolveMode = vk::ResolveModeFlagBits::eNone, const vk::ImageView& resolveImage = VK_NULL_HANDLE, vk::ImageLayout resolveLayout = vk::ImageLayout::eUndefined );
-	vk::RenderingAttachmentInfo RenderPassGetDepthAttachmentInfo( const vk::ImageView& view, vk::ImageLayout layout );
+	vk::RenderingAttachmentInfo RenderPassGetDepthAttachmentInfo( const vk::ImageView& view, vk::ImageLayout layout, bool clear = true );
 	vk::RenderingInfo RenderPassCreateRenderingInfo( vk::Extent2D renderExtent, vk::RenderingAttachmentInfo* colorAttachments, vk::RenderingAttachmentInfo* depthAttachment, uint32_t colorAttachmentCount = 1 );
 
 	// Pipeline Defaults...
@@ -1,5 +1,8 @@
 #include "Pch.hpp"
 #include "Engine.hpp"
+#include "GLTFImporter.hpp"
+#include "TextureCooker.hpp"
+#include "SoftwareOcclusionTests.hpp"
 
 #include "Input.hpp"
 
@@ -15,7 +18,27 @@ static void KeyCallback( GLFWwindow* window, int key, int scancode, int action,
 	Boundless::g_Input->SetKeyState( key, action );
 }
 
-int main() {
+// Boundless --cook <scene.gltf>: converts the scene's textures to BCn KTX2 files and exits, no window or device.
+static int CookTextures( const std::string& scenePath ) {
+	Boundless::Scene scene;
+	Boundless::GLTFImporter gltf( scene );
+	if ( !gltf.LoadFromFile( scenePath ) ) {
+		printf( "Failed to load gltf file %s\n", scenePath.c_str() );
+		return -1;
+	}
+
+	Boundless::ThreadPool threadPool;
+	return Boundless::TextureCooker( threadPool ).CookScene( scene ) == 0 ? 0 : -1;
+}
+
+int main( int argc, char** argv ) {
+	if ( argc >= 3 && std::string( argv[ 1 ] ) == "--cook" )
+		return CookTextures( argv[ 2 ] );
+
+	// Boundless --test-occlusion: CPU occlusion culling checks on synthetic scenes, no window or device.
+	if ( argc >= 2 && std::string( argv[ 1 ] ) == "--test-occlusion" )
+		return Boundless::RunSoftwareOcclusionTests() == 0 ? 0 : -1;
+
 	VULKAN_HPP_DEFAULT_DISPATCHER.init( );
 
 	// TODO: Move all this to application class.